@@ -181,6 +181,36 @@ struct CommandCoulombTruncationIonMargin : public Command
 commandCoulombTruncationIonMargin;
 
 
+struct CommandCoulombKernelCache : public Command
+{
+	CommandCoulombKernelCache() : Command("coulomb-kernel-cache", "jdftx/Coulomb interactions")
+	{
+		format = "<directory>";
+		comments =
+			"Directory for an on-disk cache of numerically computed Coulomb kernels:\n"
+			"the Wigner-Seitz truncated kernels for Isolated and Wire geometries\n"
+			"(including the corresponding exact-exchange kernels) and the 1D Ewald sum\n"
+			"look-up tables for Wire and Cylindrical geometries.\n"
+			"Each kernel is stored in a file named by a hash of all parameters that it\n"
+			"depends on (lattice vectors, grid, truncation directions and screening\n"
+			"parameter), and is reused by any later run with exactly matching parameters,\n"
+			"eg. across many similar calculations or after lattice changes are undone.\n"
+			"The directory must exist and should be shared by all processes.\n"
+			"Caching is disabled if this command is not specified.";
+		hasDefault = false;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.coulombParams.kernelCacheDir, string(), "directory", true);
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", e.coulombParams.kernelCacheDir.c_str());
+	}
+}
+commandCoulombKernelCache;
+
+
 struct CommandExchangeRegularization : public Command
 {
 	CommandExchangeRegularization() : Command("exchange-regularization", "jdftx/Coulomb interactions")
@@ -366,6 +366,7 @@ enum ElectronScatteringMember
 	ESM_slabResponse,
 	ESM_EcutTransverse,
 	ESM_computeRange,
+	ESM_nStatesCache,
 	ESM_delim
 };
 EnumStringMap<ElectronScatteringMember> esmMap
@@ -376,7 +377,8 @@ EnumStringMap<ElectronScatteringMember> esmMap
 	ESM_RPA, "RPA",
 	ESM_slabResponse, "slabResponse",
 	ESM_EcutTransverse, "EcutTransverse",
-	ESM_computeRange, "computeRange"
+	ESM_computeRange, "computeRange",
+	ESM_nStatesCache, "nStatesCache"
 );
 
 struct CommandElectronScattering : public Command
@@ -415,7 +417,13 @@ struct CommandElectronScattering : public Command
 			"   If specified, only calculate momentum transfers in range [iqStart , iqStop] in\n"
 			"   the current run, in order to split the overall calculation into smaller jobs.\n"
 			"   Note that the indices are 1-based, and the range includes both end-points.\n"
-			"   To combine the final results, perform a final run without computeRange specified.";
+			"   To combine the final results, perform a final run without computeRange specified.\n"
+			"\n+ nStatesCache <n>\n\n"
+			"   Maximum number of remote reduced states (wavefunctions and projections) held\n"
+			"   on each process at a time. Each process handles a subset of the k-mesh and\n"
+			"   fetches the states it needs from their owners in blocks of k-points, so that\n"
+			"   memory per process does not grow with the total number of states.\n"
+			"   (If zero, use the number of states local to each process; default.)";
 			
 		require("coulomb-interaction");
 		forbid("polarizability"); //both are major operations that are given permission to destroy Everything if necessary
@@ -444,6 +452,7 @@ struct CommandElectronScattering : public Command
 					es.iqStart -= 1; //convert to 0-based index. Note that iqStop becomes a non-included 0-based index without change
 					break;
 				}
+				case ESM_nStatesCache: pl.get(es.nStatesCache, size_t(0), "nStatesCache", true); break;
 				case ESM_delim: break; //never encountered; to suppress compiler warning
 			}
 		}
@@ -467,6 +476,7 @@ struct CommandElectronScattering : public Command
 		logPrintf(" \\\n\tslabResponse %s", boolMap.getString(es.slabResponse));
 		if(es.slabResponse) logPrintf(" \\\n\tEcutTransverse %lg", es.EcutTransverse);
 		if(es.computeRange)  logPrintf(" \\\n\tcomputeRange %lu %lu", es.iqStart+1, es.iqStop);
+		if(es.nStatesCache) logPrintf(" \\\n\tnStatesCache %lu", es.nStatesCache);
 	}
 }
 commandElectronScattering;
@@ -586,6 +596,7 @@ enum VibrationsMember
 	VM_omegaMin,
 	VM_T,
 	VM_omegaResolution,
+	VM_processGroups,
 	VM_Delim
 };
 
@@ -597,7 +608,8 @@ EnumStringMap<VibrationsMember> vibMap
 	VM_rotationSym, "rotationSym",
 	VM_omegaMin, "omegaMin",
 	VM_T, "T",
-	VM_omegaResolution, "omegaResolution"
+	VM_omegaResolution, "omegaResolution",
+	VM_processGroups, "processGroups"
 );
 
 struct CommandVibrations : public Command
@@ -624,6 +636,11 @@ struct CommandVibrations : public Command
 			"+ T <T>: temperature (in Kelvin) for free energy calculation (default: 298)\n"
 			"+ omegaResolution <omegaResolution>: resolution for detecting and reporting degeneracies\n"
 			"   in modes (default: 1e-4). Does not affect free energies and all modes are still printed.\n"
+			"+ processGroups <nGroups>: divide the MPI processes into <nGroups> groups that each\n"
+			"   compute the undisplaced configuration and then take displaced configurations\n"
+			"   from a shared queue, each starting from the undisplaced wavefunctions (default: 1,\n"
+			"   i.e. one configuration at a time on all processes; 0 => one group per process).\n"
+			"   Output from group 0 alone appears in the log and output files.\n"
 			"\n"
 			"Note that for a periodic system with k-points, wave functions may be incompatible\n"
 			"with and without the vibrations command due to symmetry-breaking by the perturbations.\n"
@@ -648,6 +665,10 @@ struct CommandVibrations : public Command
 				case VM_omegaMin: pl.get(e.vibrations->omegaMin, 2e-4, "omegaMin", true); break;
 				case VM_T: pl.get(e.vibrations->T, 298., "T", true); e.vibrations->T *= Kelvin; break;
 				case VM_omegaResolution: pl.get(e.vibrations->omegaResolution, 1e-4, "omegaResolution", true); break;
+				case VM_processGroups:
+					pl.get(e.vibrations->nGroups, 1, "nGroups", true);
+					if(e.vibrations->nGroups < 0) throw string("<nGroups> must be non-negative");
+					break;
 				case VM_Delim: return; //end of input
 			}
 		}
@@ -663,6 +684,7 @@ struct CommandVibrations : public Command
 		logPrintf("\\\n\tomegaMin %g", e.vibrations->omegaMin);
 		logPrintf("\\\n\tT %g", e.vibrations->T/Kelvin);
 		logPrintf("\\\n\tomegaResolution %g", e.vibrations->omegaResolution);
+		logPrintf("\\\n\tprocessGroups %d", e.vibrations->nGroups);
 	}
 }
 commandVibrations;
@@ -755,7 +777,7 @@ struct CommandChargedDefectCorrection : public Command
 {
 	CommandChargedDefectCorrection() : Command("charged-defect-correction", "jdftx/Output")
 	{
-		format = "[Slab <dir>=100|010|001] <DtotFile> <bulkEps>|<slabEpsFile> <rMin> <rSigma>";
+		format = "[Slab <dir>=100|010|001] <DtotFile> <bulkEps>|<slabEpsFile> <rMin> <rSigma> [<libraryPrefix>]";
 		comments = 
 			"Calculate energy correction for bulk or surface charged defects \\cite ElectrostaticPotential\n"
 			"The correction is calculated assuming the defects to be model\n"
@@ -786,7 +808,15 @@ struct CommandChargedDefectCorrection : public Command
 			"the determination of the alignment potential, with rSigma specifying an\n"
 			"error function turn-on distance. The code wil generate a text file with\n"
 			"the spherically averaged model and DFT electrostatic potentials, which\n"
-			"can be used to check the calculated alignment and refine rMin and rSigma.";
+			"can be used to check the calculated alignment and refine rMin and rSigma.\n"
+			"\n"
+			"Model potentials of each unit charge in slab mode are cached (keyed by\n"
+			"lattice, grid, dielectric profile and model-charge position / width), so\n"
+			"that repeated corrections in the same run avoid the dielectric solves.\n"
+			"If <libraryPrefix> is specified, these are also saved to and reused from\n"
+			"files named <libraryPrefix>.<key> across runs, which is useful when\n"
+			"screening many defects in the same supercell and dielectric environment.\n"
+			"The bulk-mode model energy is computed analytically and needs no cache.";
 		
 		require("latt-scale");
 		require("coords-type");
@@ -829,6 +859,7 @@ struct CommandChargedDefectCorrection : public Command
 		//Alignment potential ranges:
 		pl.get(cd.rMin, 0., "rMin", true);
 		pl.get(cd.rSigma, 0., "rSigma", true);
+		pl.get(cd.libraryPrefix, string(), "libraryPrefix");
 		e.dump.insert(std::make_pair(DumpFreq_End, DumpChargedDefect)); //dump at end by default
 	}
 
@@ -843,6 +874,7 @@ struct CommandChargedDefectCorrection : public Command
 			default:; //should never be encountered
 		}
 		logPrintf(" %lg %lg", cd.rMin, cd.rSigma);
+		if(cd.libraryPrefix.length()) logPrintf(" %s", cd.libraryPrefix.c_str());
 	}
 }
 CommandChargedDefectCorrection;
@@ -906,6 +938,83 @@ struct CommandPotentialSubtraction : public Command
 commandPotentialSubtraction;
 
 
+static EnumStringMap<bool> checkpointFormatMap(false, "raw", true, "container");
+static EnumStringMap<bool> checkpointPrecisionMap(false, "double", true, "single");
+
+struct CommandCheckpointFormat : public Command
+{
+	CommandCheckpointFormat() : Command("checkpoint-format", "jdftx/Output")
+	{	format = "<format>=" + checkpointFormatMap.optionList() + " [<precision>=" + checkpointPrecisionMap.optionList() + "] [<compress>=yes|no]";
+		comments =
+			"File format of restart data (wfns, fillings, eigenvals and fluidState) in dump State.\n"
+			"+ raw: headerless little-endian binary arrays (default).\n"
+			"+ container: self-describing checkpoint container that records the lattice,\n"
+			"   grid, cutoff, k-points and band counts, and stores data in chunks\n"
+			"   (one per k-point or per scalar field) with CRC-32 checksums verified on read.\n"
+			"   Wavefunctions in a container are automatically converted to the current\n"
+			"   cutoff and number of bands (without nBandsOld / EcutOld), and fluid state\n"
+			"   is resampled to the current grid, while truncated or corrupted files are\n"
+			"   reported explicitly. Containers are detected automatically on read.\n"
+			"\n"
+			"For the container format, <precision>=single halves storage for wavefunctions\n"
+			"(default double; fillings, eigenvalues and fluid state always stay in double),\n"
+			"and <compress>=yes additionally compresses each chunk losslessly\n"
+			"(default no; requires zlib support with CMake option EnableZlib).";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	CheckpointOptions& cp = e.dump.checkpoint;
+		pl.get(cp.enabled, false, checkpointFormatMap, "format");
+		pl.get(cp.singlePrecision, false, checkpointPrecisionMap, "precision");
+		pl.get(cp.compress, false, boolMap, "compress");
+		if(!cp.enabled && (cp.singlePrecision || cp.compress))
+			throw string("<precision> and <compress> are only supported for <format>=container");
+		#ifndef ZLIB_ENABLED
+		if(cp.compress) throw string("Checkpoint compression requires zlib support (CMake option EnableZlib)");
+		#endif
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	const CheckpointOptions& cp = e.dump.checkpoint;
+		logPrintf("%s", checkpointFormatMap.getString(cp.enabled));
+		if(cp.enabled)
+			logPrintf(" %s %s", checkpointPrecisionMap.getString(cp.singlePrecision), boolMap.getString(cp.compress));
+	}
+}
+commandCheckpointFormat;
+
+
+struct CommandDumpAsync : public Command
+{
+	CommandDumpAsync() : Command("dump-async", "jdftx/Output")
+	{	format = "<maxInFlight>";
+		comments =
+			"Write dumps at intermediate frequencies (Electronic, Fluid, Ionic and Gummel)\n"
+			"in the background from a dedicated I/O thread on each process, so that the\n"
+			"calculation proceeds while wavefunctions and other large outputs are written.\n"
+			"Wavefunctions, fillings, eigenvalues and raw scalar fields are copied into a\n"
+			"snapshot and written to temporary files, which are renamed to the final\n"
+			"filenames once every process has finished writing them, so that restart files\n"
+			"are never left partially written. At most <maxInFlight> dumps are pending at\n"
+			"any time (bounding the memory held in snapshots), and Init / End dumps are\n"
+			"written synchronously after completing any pending background writes.\n"
+			"The default <maxInFlight>=0 writes all dumps synchronously.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.dump.asyncMaxInFlight, 0, "maxInFlight");
+		if(e.dump.asyncMaxInFlight < 0) throw string("<maxInFlight> must be non-negative");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.dump.asyncMaxInFlight);
+	}
+}
+commandDumpAsync;
+
+
 struct CommandBandUnfold : public Command
 {
 	CommandBandUnfold() : Command("band-unfold", "jdftx/Output")
@@ -948,6 +1057,8 @@ enum BGWparamsMember
 	BGWpm_freqBroaden_eV,
 	BGWpm_freqNimag,
 	BGWpm_freqPlasma,
+	BGWpm_chunked,
+	BGWpm_compressLevel,
 	BGWpm_Delim
 };
 EnumStringMap<BGWparamsMember> bgwpmMap
@@ -961,7 +1072,9 @@ EnumStringMap<BGWparamsMember> bgwpmMap
 	BGWpm_freqReStep_eV, "freqReStep_eV",
 	BGWpm_freqBroaden_eV, "freqBroaden_eV",
 	BGWpm_freqNimag, "freqNimag",
-	BGWpm_freqPlasma, "freqPlasma"
+	BGWpm_freqPlasma, "freqPlasma",
+	BGWpm_chunked, "chunked",
+	BGWpm_compressLevel, "compressLevel"
 );
 EnumStringMap<BGWparamsMember> bgwpmDescMap
 (	BGWpm_nBandsDense, "If non-zero, use a dense ScaLAPACK solver to calculate more bands",
@@ -974,7 +1087,9 @@ EnumStringMap<BGWparamsMember> bgwpmDescMap
 	BGWpm_freqReStep_eV, "Real frequency grid spacing in eV (default: 1.)",
 	BGWpm_freqBroaden_eV, "Broadening (imaginary part) of real frequency grid in eV (default: 0.1)",
 	BGWpm_freqNimag, "Number of imaginary frequencies (default: 25)",
-	BGWpm_freqPlasma, "Plasma frequency in Hartrees used in GW imaginary frequency grid (default: 1.), set to zero for RPA frequency grid"
+	BGWpm_freqPlasma, "Plasma frequency in Hartrees used in GW imaginary frequency grid (default: 1.), set to zero for RPA frequency grid",
+	BGWpm_chunked, "Whether to store wavefunction and polarizability datasets in chunks of about 1 MB (default: no)",
+	BGWpm_compressLevel, "Deflate compression level 0-9 for wavefunction and polarizability datasets (default: 0 => no compression; non-zero implies chunked)"
 );
 
 struct CommandBGWparams : public Command
@@ -1015,6 +1130,13 @@ struct CommandBGWparams : public Command
 				READ_AND_CHECK(freqBroaden_eV, >, 0.)
 				READ_AND_CHECK(freqNimag, >, 0)
 				READ_AND_CHECK(freqPlasma, >=, 0.)
+				case BGWpm_chunked:
+					pl.get(bgwp.chunked, false, boolMap, "chunked", true);
+					break;
+				case BGWpm_compressLevel:
+					pl.get(bgwp.compressLevel, 0, "compressLevel", true);
+					if(bgwp.compressLevel<0 || bgwp.compressLevel>9) throw string("compressLevel must be in [0,9]");
+					break;
 				case BGWpm_Delim: return; //end of input
 			}
 			#undef READ_AND_CHECK
@@ -1036,6 +1158,8 @@ struct CommandBGWparams : public Command
 		PRINT(freqBroaden_eV, "%lg")
 		PRINT(freqNimag, "%d")
 		PRINT(freqPlasma, "%lg")
+		logPrintf(" \\\n\tchunked %s", boolMap.getString(bgwp.chunked));
+		PRINT(compressLevel, "%d")
 		#undef PRINT
 	}
 }
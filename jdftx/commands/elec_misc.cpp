@@ -122,6 +122,67 @@ commandDavidsonBandRatio;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandDavidsonBlockSize : public Command
+{
+	CommandDavidsonBlockSize() : Command("davidson-block-size", "jdftx/Electronic/Optimization")
+	{
+		format = "[<nBlock>=0]";
+		comments =
+			"Maximum number of bands whose residuals expand the Davidson subspace in\n"
+			"each iteration. The expansion is restricted to the lowest unlocked bands,\n"
+			"and the block moves up as those converge and are locked. This reduces the\n"
+			"peak memory of the expanded subspace from about 4x to about (2 + 2 nBlock/nBands)x\n"
+			"the wavefunctions, which is useful for calculations with 1000s of bands.\n"
+			"The default 0 expands all unlocked bands in each iteration.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.davidsonBlockSize, 0, "nBlock");
+		if(e.cntrl.davidsonBlockSize < 0)
+			throw string("<nBlock> must be non-negative");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.cntrl.davidsonBlockSize);
+	}
+}
+commandDavidsonBlockSize;
+
+//-------------------------------------------------------------------------------------------------
+
+struct CommandElecMixedPrecision : public Command
+{
+	CommandElecMixedPrecision() : Command("elec-mixed-precision", "jdftx/Electronic/Optimization")
+	{
+		format = "[<threshold>=1e-8]";
+		comments =
+			"Apply the local potential to Davidson expansion vectors using single-precision\n"
+			"FFTs whenever the eigensolver energy threshold exceeds <threshold> (Eh).\n"
+			"In SCF, the eigensolver threshold is set from the energy change of the previous\n"
+			"cycle, so that early cycles use single precision and the calculation switches\n"
+			"to double precision automatically as it approaches convergence.\n"
+			"Wavefunctions remain stored in double precision throughout.\n"
+			"Requires compilation with EnableSinglePrecisionFFT (and is ignored on GPUs).";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.mixedPrecisionThreshold, 1e-8, "threshold");
+		if(e.cntrl.mixedPrecisionThreshold <= 0.)
+			throw string("<threshold> must be positive");
+		#ifndef SINGLE_PRECISION_FFT_ENABLED
+		logPrintf("WARNING: elec-mixed-precision has no effect since single-precision FFTs were not enabled at compile time.\n");
+		#endif
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%lg", e.cntrl.mixedPrecisionThreshold);
+	}
+}
+commandElecMixedPrecision;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandLcaoParams : public Command
 {
 	CommandLcaoParams() : Command("lcao-params", "jdftx/Initialization")
@@ -301,6 +362,38 @@ commandCacheProjectors;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandKpointThreadGroups : public Command
+{
+	CommandKpointThreadGroups() : Command("kpoint-thread-groups", "jdftx/Miscellaneous")
+	{
+		format = "[<nGroups>=1]";
+		comments =
+			"Process several k-points of each process at once on <nGroups> disjoint groups of threads,\n"
+			"instead of one k-point at a time using all threads within each operator.\n"
+			"This improves thread utilization for small unit cells with many k-points,\n"
+			"where individual operators are too small to scale over all cores.\n"
+			"Affects the density calculation, electronic gradient and band-structure / SCF\n"
+			"eigensolver loops; the inner eigensolver output is suppressed in this mode.\n"
+			"If <nGroups> = 0, use as many groups as k-points or threads, whichever is smaller.\n"
+			"Default 1 processes k-points one at a time. Ignored when running on GPUs\n"
+			"and with exact exchange.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.kpointThreadGroups, 1, "nGroups");
+		if(e.cntrl.kpointThreadGroups < 0)
+			throw string("<nGroups> must be non-negative");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.cntrl.kpointThreadGroups);
+	}
+}
+commandKpointThreadGroups;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandBasis : public Command
 {
 	CommandBasis() : Command("basis", "jdftx/Electronic/Parameters")
@@ -323,14 +416,16 @@ commandBasis;
 
 //-------------------------------------------------------------------------------------------------
 
-static EnumStringMap<ElecEigenAlgo> elecEigenMap(ElecEigenCG, "CG", ElecEigenDavidson, "Davidson");
+static EnumStringMap<ElecEigenAlgo> elecEigenMap(ElecEigenCG, "CG", ElecEigenDavidson, "Davidson", ElecEigenChFSI, "ChFSI");
 
 struct CommandElecEigenAlgo : public Command
 {
     CommandElecEigenAlgo() : Command("elec-eigen-algo", "jdftx/Electronic/Optimization")
 	{
 		format = "<algo>=" + elecEigenMap.optionList();
-		comments = "Selects eigenvalue algorithm for band-structure calculations or inner loop of SCF.";
+		comments = "Selects eigenvalue algorithm for band-structure calculations or inner loop of SCF.\n"
+			"ChFSI (Chebyshev-filtered subspace iteration) performs a single Rayleigh-Ritz step per\n"
+			"iteration and is mostly Hamiltonian applications; see chfsi-params (norm-conserving only).";
 		hasDefault = true;
 	}
 
@@ -346,6 +441,35 @@ commandElecEigenAlgo;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandChfsiParams : public Command
+{
+	CommandChfsiParams() : Command("chfsi-params", "jdftx/Electronic/Optimization")
+	{
+		format = "[<degree>=10] [<nLanczos>=8]";
+		comments =
+			"Parameters of the Chebyshev-filtered subspace iteration eigensolver (elec-eigen-algo ChFSI):\n"
+			"+ <degree>: degree of the Chebyshev filter polynomial, i.e. the number of Hamiltonian\n"
+			"   applications per iteration (each iteration ends with one Rayleigh-Ritz step).\n"
+			"+ <nLanczos>: number of Lanczos steps used to estimate the upper bound of the spectrum.";
+		hasDefault = true;
+		require("elec-eigen-algo");
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.chfsiDegree, 10, "degree");
+		pl.get(e.cntrl.chfsiLanczosSteps, 8, "nLanczos");
+		if(e.cntrl.chfsiDegree < 1) throw string("<degree> must be at least 1");
+		if(e.cntrl.chfsiLanczosSteps < 2) throw string("<nLanczos> must be at least 2");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d %d", e.cntrl.chfsiDegree, e.cntrl.chfsiLanczosSteps);
+	}
+}
+commandChfsiParams;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandRhoExternal : public Command
 {
 	CommandRhoExternal() : Command("rhoExternal", "jdftx/Coulomb interactions")
@@ -43,6 +43,9 @@ enum IonicDynamicsParamsMember
 	IDPM_chainLengthT,
 	IDPM_chainLengthP,
 	IDPM_B0,
+	IDPM_xlbomdOrder,
+	IDPM_xlbomdElecSteps,
+	IDPM_respaSteps,
 	IDPM_Delim //!< delimiter to detect end of input
 };
 
@@ -57,7 +60,10 @@ EnumStringMap<IonicDynamicsParamsMember> idpmMap
 	IDPM_tDampP, "tDampP",
 	IDPM_chainLengthT, "chainLengthT",
 	IDPM_chainLengthP, "chainLengthP",
-	IDPM_B0, "B0"
+	IDPM_B0, "B0",
+	IDPM_xlbomdOrder, "xlbomdOrder",
+	IDPM_xlbomdElecSteps, "xlbomdElecSteps",
+	IDPM_respaSteps, "respaSteps"
 );
 
 EnumStringMap<IonicDynamicsParamsMember> idpmDescMap
@@ -71,7 +77,13 @@ EnumStringMap<IonicDynamicsParamsMember> idpmDescMap
 	IDPM_tDampP, "barostat damping time [fs]",
 	IDPM_chainLengthT, "Nose-Hoover chain length for thermostat",
 	IDPM_chainLengthP, "Nose-Hoover chain length for barostat",
-	IDPM_B0, "Characteristic bulk modulus [bar] for Berendsen barostat (damping ~ B0 * tDampP)"
+	IDPM_B0, "Characteristic bulk modulus [bar] for Berendsen barostat (damping ~ B0 * tDampP)",
+	IDPM_xlbomdOrder, "Dissipation order 3-9 for extended-Lagrangian propagation of auxiliary wavefunctions,\n"
+		"   which provide the initial guess for a few electronic iterations per step (default 0 => disabled).\n"
+		"   Stores xlbomdOrder+1 copies of the wavefunctions; not supported with barostats",
+	IDPM_xlbomdElecSteps, "Maximum electronic iterations per step (after the first) with xlbomdOrder > 0 (default 4)",
+	IDPM_respaSteps, "Number of inner steps per time step on which pair-potential (Ewald and vdW) forces are integrated,\n"
+		"   with the remaining forces only on the outer time step (default 1 => disabled; not supported with barostats)"
 );
 
 struct CommandIonicDynamics : public Command
@@ -122,6 +134,19 @@ struct CommandIonicDynamics : public Command
 				case IDPM_chainLengthT: pl.get(idp.chainLengthT, 3, "chainLengthT", true); break;
 				case IDPM_chainLengthP: pl.get(idp.chainLengthP, 3, "chainLengthP", true); break;
 				case IDPM_B0: pl.get(idp.B0, nanVal, "B0", true); idp.B0 *= Bar; break;
+				case IDPM_xlbomdOrder:
+					pl.get(idp.xlbomdOrder, 0, "xlbomdOrder", true);
+					if(idp.xlbomdOrder and (idp.xlbomdOrder<3 or idp.xlbomdOrder>9))
+						throw(string("xlbomdOrder must be 0 (disabled) or between 3 and 9"));
+					break;
+				case IDPM_xlbomdElecSteps:
+					pl.get(idp.xlbomdElecSteps, 4, "xlbomdElecSteps", true);
+					if(idp.xlbomdElecSteps < 1) throw(string("xlbomdElecSteps must be positive"));
+					break;
+				case IDPM_respaSteps:
+					pl.get(idp.respaSteps, 1, "respaSteps", true);
+					if(idp.respaSteps < 1) throw(string("respaSteps must be positive"));
+					break;
 				case IDPM_Delim: 
 					if((not std::isnan(idp.P0)) and (not std::isnan(trace(idp.stress0))))
 						throw(string("Cannot specify both P0 (hydrostatic) and stress0 (anisotropic) barostats"));
@@ -145,6 +170,9 @@ struct CommandIonicDynamics : public Command
 		logPrintf(" \\\n\tchainLengthT %d", idp.chainLengthT);
 		logPrintf(" \\\n\tchainLengthP %d", idp.chainLengthP);
 		logPrintf(" \\\n\tB0           %lg", idp.B0/Bar);
+		logPrintf(" \\\n\txlbomdOrder     %d", idp.xlbomdOrder);
+		logPrintf(" \\\n\txlbomdElecSteps %d", idp.xlbomdElecSteps);
+		logPrintf(" \\\n\trespaSteps      %d", idp.respaSteps);
 	}
 }
 commandIonicDynamics;
@@ -152,7 +152,7 @@ struct CommandElectronicScf: public CommandPulay
 	void process(ParamList& pl, Everything& e)
 	{	e.cntrl.scf = true;
 		SCFparams& sp = e.scfParams;
-		sp.nEigSteps = (e.cntrl.elecEigenAlgo==ElecEigenCG) ? 40 : 2; //default eigenvalue steps based on algo
+		sp.nEigSteps = (e.cntrl.elecEigenAlgo==ElecEigenCG) ? 40 : ((e.cntrl.elecEigenAlgo==ElecEigenChFSI) ? 1 : 2); //default eigenvalue steps based on algo
 		processCommon(pl, e, sp);
 	}
 	
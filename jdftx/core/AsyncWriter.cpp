@@ -0,0 +1,133 @@
+/*-------------------------------------------------------------------
+Copyright 2026 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/AsyncWriter.h>
+#include <core/MPIUtil.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+
+AsyncWriter::AsyncWriter(int maxInFlight)
+: maxInFlight(std::max(1, maxInFlight)), nBatches(0), nBatchesEnded(0), nBatchesDone(0), nBatchesCommitted(0), stop(false)
+{	ioThread = new std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter()
+{	{	std::lock_guard<std::mutex> lock(m);
+		stop = true;
+	}
+	cvQueued.notify_one();
+	ioThread->join();
+	delete ioThread;
+}
+
+void AsyncWriter::beginBatch()
+{	{	std::unique_lock<std::mutex> lock(m);
+		while(nBatchesEnded - nBatchesDone >= maxInFlight)
+			cvDone.wait(lock);
+	}
+	commit(); //rename any batches that have completed everywhere in the meanwhile
+	nBatches++;
+}
+
+void AsyncWriter::write(const string& fname, size_t offset, std::vector<char>& data, long fileSize)
+{	int iBatch = nBatches-1;
+	assert(iBatch >= nBatchesEnded); //must be called between beginBatch() and endBatch()
+	if(fileSize >= 0) batchFiles[iBatch].push_back(fname);
+	if(data.size()==0 && fileSize<0) return; //nothing to do
+	Job job;
+	job.fname = tmpFilename(fname, iBatch);
+	job.offset = offset;
+	job.fileSize = fileSize;
+	std::swap(job.data, data);
+	{	std::lock_guard<std::mutex> lock(m);
+		queue.push_back(Job());
+		std::swap(queue.back(), job);
+	}
+	cvQueued.notify_one();
+}
+
+void AsyncWriter::endBatch()
+{	{	std::lock_guard<std::mutex> lock(m);
+		queue.push_back(Job()); //end-of-batch marker
+		queue.back().offset = 0;
+		queue.back().fileSize = -1;
+		nBatchesEnded++;
+	}
+	cvQueued.notify_one();
+}
+
+void AsyncWriter::commit(bool waitAll)
+{	int nDone;
+	{	std::unique_lock<std::mutex> lock(m);
+		if(waitAll)
+			while(nBatchesDone < nBatchesEnded)
+				cvDone.wait(lock);
+		nDone = nBatchesDone;
+	}
+	mpiWorld->allReduce(nDone, MPIUtil::ReduceMin); //batches completed on all processes
+	for(; nBatchesCommitted<nDone; nBatchesCommitted++)
+	{	auto iter = batchFiles.find(nBatchesCommitted);
+		if(iter == batchFiles.end()) continue;
+		for(const string& fname: iter->second)
+			if(rename(tmpFilename(fname, nBatchesCommitted).c_str(), fname.c_str()) != 0)
+				die_alone("Error renaming background-written file to '%s'.\n", fname.c_str());
+		batchFiles.erase(iter);
+	}
+}
+
+string AsyncWriter::tmpFilename(const string& fname, int iBatch)
+{	ostringstream oss;
+	oss << fname << ".async" << iBatch;
+	return oss.str();
+}
+
+void AsyncWriter::run()
+{	while(true)
+	{	Job job;
+		{	std::unique_lock<std::mutex> lock(m);
+			while(queue.empty() && !stop)
+				cvQueued.wait(lock);
+			if(queue.empty()) return; //stop requested and all jobs complete
+			std::swap(job, queue.front());
+			queue.pop_front();
+		}
+		if(job.fname.length()) process(job);
+		else //end of batch:
+		{	{	std::lock_guard<std::mutex> lock(m);
+				nBatchesDone++;
+			}
+			cvDone.notify_all();
+		}
+	}
+}
+
+void AsyncWriter::process(Job& job)
+{	int fd = open(job.fname.c_str(), O_WRONLY|O_CREAT, 0666);
+	if(fd < 0) die_alone("Error opening '%s' for background writing.\n", job.fname.c_str());
+	if(job.fileSize >= 0 && ftruncate(fd, job.fileSize) != 0)
+		die_alone("Error setting length of '%s' in background writing.\n", job.fname.c_str());
+	size_t nWritten = 0;
+	while(nWritten < job.data.size())
+	{	ssize_t n = pwrite(fd, job.data.data()+nWritten, job.data.size()-nWritten, job.offset+nWritten);
+		if(n <= 0) die_alone("Error writing '%s' in background after %zu of %zu bytes.\n", job.fname.c_str(), nWritten, job.data.size());
+		nWritten += n;
+	}
+	close(fd);
+}
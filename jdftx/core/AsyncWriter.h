@@ -0,0 +1,94 @@
+/*-------------------------------------------------------------------
+Copyright 2026 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_ASYNCWRITER_H
+#define JDFTX_CORE_ASYNCWRITER_H
+
+//! @addtogroup Output
+//! @{
+
+//! @file AsyncWriter.h Background file output on a dedicated I/O thread
+
+#include <core/Util.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+
+/**
+Writes snapshots of output data from a dedicated I/O thread on each process, so that
+the calling (compute) thread can proceed while large files are being written.
+
+Writes are grouped into batches (eg. one per dump), which are numbered identically on all processes.
+Each process writes its part of a file at the specified byte offset into a temporary file
+specific to that batch, without any MPI calls from the I/O thread. Once a batch has been
+completely written on all processes, commit() renames the temporaries to their final names
+(on the head process), so that a file is never observed partially written, and a newer batch
+writing the same file can never interleave with an older one. At most maxInFlight batches
+may be pending on each process, which bounds the memory held in snapshots.
+*/
+class AsyncWriter
+{
+public:
+	AsyncWriter(int maxInFlight=1);
+	~AsyncWriter(); //!< complete all pending writes (without committing)
+
+	//! Start a new batch, first waiting until fewer than maxInFlight batches are pending on this process. Collective.
+	void beginBatch();
+
+	//! Queue a write of data (already in file byte-order) at byte offset into file fname.
+	//! The data is taken over by swapping with an empty vector, so no copy is made here.
+	//! The final length of the file is set by fileSize, which must be non-negative on the head process
+	//! (which must queue at least one write per file, if only with empty data) and negative on all others.
+	void write(const string& fname, size_t offset, std::vector<char>& data, long fileSize=-1);
+
+	void endBatch(); //!< Mark the end of the current batch
+
+	//! Rename files of batches completely written on all processes to their final names,
+	//! optionally waiting for all pending writes first. Collective.
+	void commit(bool waitAll=false);
+
+private:
+	//! Pending write (or end-of-batch marker if fname is empty)
+	struct Job
+	{	string fname; //!< temporary filename to write to
+		size_t offset; //!< byte offset in file
+		std::vector<char> data; //!< snapshot of data to write
+		long fileSize; //!< length to set for file (if non-negative)
+	};
+	int maxInFlight; //!< maximum number of batches pending on each process
+	int nBatches; //!< number of batches started (identical on all processes)
+	int nBatchesEnded; //!< number of batches completely queued
+	int nBatchesDone; //!< number of batches completely written by this process
+	int nBatchesCommitted; //!< number of batches renamed to final filenames
+	std::map<int, std::vector<string> > batchFiles; //!< final filenames of each uncommitted batch (head only)
+	std::deque<Job> queue; //!< pending jobs
+	bool stop; //!< set to terminate the I/O thread
+	std::mutex m;
+	std::condition_variable cvQueued, cvDone;
+	std::thread* ioThread;
+
+	static string tmpFilename(const string& fname, int iBatch); //!< temporary filename used for fname in batch iBatch
+	void run(); //!< I/O thread
+	void process(Job& job); //!< perform one write on the I/O thread
+};
+
+//! @}
+#endif //JDFTX_CORE_ASYNCWRITER_H
@@ -147,6 +147,15 @@ void eblas_symmetrize(int N, int n, const int* symmIndex, const int* symmMult, c
 		eblas_symmetrize_phase_sub, N, n, symmIndex, symmMult, phase, x);
 }
 
+void eblas_symmetrize_half_sub(size_t iStart, size_t iStop, int n, const int* symmIndex, const int* symmFlags, const int* symmExtra, const int* symmMult, const complex* phase, complex* x)
+{	for(size_t i=iStart; i<iStop; i++)
+		eblas_symmetrize_half_calc(i, n, symmIndex, symmFlags, symmExtra, symmMult, phase, x);
+}
+void eblas_symmetrize_half(int N, int n, const int* symmIndex, const int* symmFlags, const int* symmExtra, const int* symmMult, const complex* phase, complex* x)
+{	threadLaunch((N*n<10000) ? 1 : 0, //force single threaded for small problem sizes
+		eblas_symmetrize_half_sub, N, n, symmIndex, symmFlags, symmExtra, symmMult, phase, x);
+}
+
 void eblas_symmetrize_phase_rot_sub(size_t iStart, size_t iStop, int n, const int* symmIndex, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, complexPtr4 x)
 {	for(size_t i=iStart; i<iStop; i++)
 		eblas_symmetrize_phase_rot_calc(i, n, symmIndex, symmMult, phase, rotSpin, x);
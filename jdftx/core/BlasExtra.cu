@@ -152,6 +152,17 @@ void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, const int* symmMul
 	gpuErrorCheck();
 }
 
+__global__
+void eblas_symmetrize_half_kernel(int N, int n, const int* symmIndex, const int* symmFlags, const int* symmExtra, const int* symmMult, const complex* phase, complex* x)
+{	int i=kernelIndex1D();
+	if(i<N) eblas_symmetrize_half_calc(i, n, symmIndex, symmFlags, symmExtra, symmMult, phase, x);
+}
+void eblas_symmetrize_half_gpu(int N, int n, const int* symmIndex, const int* symmFlags, const int* symmExtra, const int* symmMult, const complex* phase, complex* x)
+{	GpuLaunchConfig1D glc(eblas_symmetrize_half_kernel, N);
+	eblas_symmetrize_half_kernel<<<glc.nBlocks,glc.nPerBlock>>>(N, n, symmIndex, symmFlags, symmExtra, symmMult, phase, x);
+	gpuErrorCheck();
+}
+
 __global__
 void eblas_symmetrize_phase_rot_kernel(int N, int n, const int* symmIndex, const int* symmMult, const complex* phase, const matrix3<>* rotSpin, complexPtr4 x)
 {	int i=kernelIndex1D();
@@ -238,6 +238,22 @@ void eblas_symmetrize(int N, int n, const int* symmIndex, const int* symmMult, c
 void eblas_symmetrize_gpu(int N, int n, const int* symmIndex, const int* symmMult, const complex* phase, complex* x);
 #endif
 
+//! @brief Symmetrize the half-reduced reciprocal-space representation of a real array with phase factors
+//! (space group symmetrization of real scalar fields directly in the r2c layout, using Hermitian symmetry)
+//! @param N Number of equivalence classes
+//! @param n Length of symmetry equivalence classes
+//! @param symmIndex Every consecutive set of n indices (into the half-reduced box) forms an equivalence class
+//! @param symmFlags Combination of SymmHalfFlags for each entry in symmIndex
+//! @param symmExtra Index of an independently stored conjugate partner to update for each entry in symmIndex (-1 if none)
+//! @param symmMult Multiplicity per equivalence class (number of repetitions of each element in orbit)
+//! @param phase Phase factors corresponding to each entry in symmIndex
+//! @param x Data array to be symmetrized in place
+void eblas_symmetrize_half(int N, int n, const int* symmIndex, const int* symmFlags, const int* symmExtra, const int* symmMult, const complex* phase, complex* x);
+#ifdef GPU_ENABLED
+//! @brief Equivalent of eblas_symmetrize_half() for GPU data pointers
+void eblas_symmetrize_half_gpu(int N, int n, const int* symmIndex, const int* symmFlags, const int* symmExtra, const int* symmMult, const complex* phase, complex* x);
+#endif
+
 //! @brief Symmetrize a quadruplet of complex arrays with phase factors, using N n-fold equivalence classes in symmIndex
 //! (useful for space group symmetrization of spin density matrices in reciprocal space)
 //! @param N Length of array x
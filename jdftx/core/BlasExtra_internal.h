@@ -84,6 +84,36 @@ __hostanddev__ void eblas_symmetrize_phase_calc(size_t i, int n, const int* symm
 		x[symmIndex[n*i+j]] += xSum * phase[n*i+j].conj();
 }
 
+//! Flags for entries of half-reduced G-space symmetrization indices (see eblas_symmetrize_half_calc)
+enum SymmHalfFlags
+{	SymmHalfConj = 1, //!< stored value is the complex conjugate of the orbit member (member lies outside the half-reduced box)
+	SymmHalfNoScatter = 2 //!< only gather from this entry (storage is already updated by its conjugate partner in the same orbit)
+};
+
+//Symmetrize real-space-real data stored on the half-reduced G-space box (r2c layout).
+//Entries are read / written with conjugation as per symmFlags, and symmExtra (if non-negative) specifies
+//the independently stored conjugate partner on the iG[2]=0 and Nyquist planes that must also be updated.
+__hostanddev__ void eblas_symmetrize_half_calc(size_t i, int n, const int* symmIndex, const int* symmFlags, const int* symmExtra, const int* symmMult, const complex* phase, complex* x)
+{	complex xSum = 0.;
+	for(int j=0; j<n; j++)
+	{	int k = n*i+j;
+		complex xCur = x[symmIndex[k]];
+		xSum += ((symmFlags[k] & SymmHalfConj) ? xCur.conj() : xCur) * phase[k];
+	}
+	xSum *= 1./(n*symmMult[i]); //average n in the equivalence class, with weight for accumulation below accounted)
+	for(int j=0; j<n; j++)
+	{	int k = n*i+j;
+		if(!(symmFlags[k] & SymmHalfNoScatter)) x[symmIndex[k]] = 0.;
+		if(symmExtra[k] >= 0) x[symmExtra[k]] = 0.;
+	}
+	for(int j=0; j<n; j++)
+	{	int k = n*i+j;
+		complex xCur = xSum * phase[k].conj();
+		if(!(symmFlags[k] & SymmHalfNoScatter)) x[symmIndex[k]] += ((symmFlags[k] & SymmHalfConj) ? xCur.conj() : xCur);
+		if(symmExtra[k] >= 0) x[symmExtra[k]] += xCur.conj();
+	}
+}
+
 //! Quadruplet of complex arrays corresponding to spin density matrix channels
 class complexPtr4
 {	complex *up, *dn, *re, *im; //!< UpUp, DnDn, Re(UpDn), Im(UpDn) components respectively
@@ -38,16 +38,21 @@ BlipConverter::BlipConverter(const vector3<int>& S) : S(S)
 	}
 }
 
+//Multiply G-space data (with nz entries along the innermost dimension) by the blip kernel, for a range of outermost slices
+void blipScale_sub(size_t i0start, size_t i0stop, vector3<int> S, int nz, const std::vector<double>* gamma, complex* data)
+{	size_t index = i0start * S[1] * nz;
+	for(size_t i0=i0start; i0<i0stop; i0++)
+		for(int i1=0; i1<S[1]; i1++)
+		{	double gamma01 = gamma[0][i0] * gamma[1][i1];
+			for(int i2=0; i2<nz; i2++)
+				data[index++] *= gamma01 * gamma[2][i2];
+		}
+}
+
 //Given a complex PW basis object, return corresponding real-space Blip coefficient set
 complexScalarField BlipConverter::operator()(const complexScalarFieldTilde& vTilde) const
 {	assert(vTilde->gInfo.S == S);
-	complex* vTildeData = vTilde->data();
-	int index=0;
-	vector3<int> iv;
-	for(iv[0]=0; iv[0]<S[0]; iv[0]++)
-	for(iv[1]=0; iv[1]<S[1]; iv[1]++)
-	for(iv[2]=0; iv[2]<S[2]; iv[2]++)
-		vTildeData[index++] *= (gamma[0][iv[0]]*gamma[1][iv[1]]*gamma[2][iv[2]]);
+	threadLaunch(blipScale_sub, S[0], S, S[2], gamma, vTilde->data());
 	return I(vTilde);
 }
 complexScalarField BlipConverter::operator()(const complexScalarField& v) const
@@ -57,13 +62,7 @@ complexScalarField BlipConverter::operator()(const complexScalarField& v) const
 //Given a real PW basis object v, return corresponding real-space Blip coefficient set
 ScalarField BlipConverter::operator()(const ScalarFieldTilde& vTilde) const
 {	assert(vTilde->gInfo.S == S);
-	complex* vTildeData = vTilde->data();
-	int index=0;
-	vector3<int> iv;
-	for(iv[0]=0; iv[0]<S[0]; iv[0]++)
-	for(iv[1]=0; iv[1]<S[1]; iv[1]++)
-	for(iv[2]=0; iv[2]<=S[2]/2; iv[2]++)
-		vTildeData[index++] *= (gamma[0][iv[0]]*gamma[1][iv[1]]*gamma[2][iv[2]]);
+	threadLaunch(blipScale_sub, S[0], S, S[2]/2+1, gamma, vTilde->data());
 	return I(vTilde);
 }
 ScalarField BlipConverter::operator()(const ScalarField& v) const
@@ -0,0 +1,359 @@
+/*-------------------------------------------------------------------
+Copyright 2026 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/Checkpoint.h>
+#include <core/AsyncWriter.h>
+#include <core/GridInfo.h>
+#include <core/Operators.h>
+#include <cstring>
+#ifdef ZLIB_ENABLED
+#include <zlib.h>
+#endif
+
+static const int64_t checkpointMagic = 0x54504B4358544644L; //"DFTXCKPT" in little-endian byte order
+static const int64_t checkpointVersion = 1;
+
+//---------- CRC-32 (IEEE polynomial, identical to zlib / gzip) -----------
+
+#ifdef ZLIB_ENABLED
+static uint32_t checksum(const char* data, size_t n)
+{	uLong c = crc32(0L, Z_NULL, 0);
+	const size_t blockMax = 1<<30; //zlib lengths are uInt
+	for(size_t offset=0; offset<n; offset+=blockMax)
+		c = crc32(c, (const Bytef*)(data+offset), uInt(std::min(blockMax, n-offset)));
+	return uint32_t(c);
+}
+#else
+static std::vector<uint32_t> checksumTableInit()
+{	std::vector<uint32_t> table(256);
+	for(uint32_t i=0; i<256; i++)
+	{	uint32_t c = i;
+		for(int j=0; j<8; j++)
+			c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+		table[i] = c;
+	}
+	return table;
+}
+
+static uint32_t checksum(const char* data, size_t n)
+{	static const std::vector<uint32_t> table = checksumTableInit();
+	uint32_t c = 0xFFFFFFFFU;
+	for(size_t i=0; i<n; i++)
+		c = table[(c ^ uint8_t(data[i])) & 0xFF] ^ (c >> 8);
+	return c ^ 0xFFFFFFFFU;
+}
+#endif
+
+//---------- Byte shuffling (groups corresponding bytes of all values together, which compresses much better) -----------
+
+#ifdef ZLIB_ENABLED
+static void byteShuffle(const char* in, char* out, size_t valueSize, size_t nValues)
+{	for(size_t i=0; i<nValues; i++)
+		for(size_t b=0; b<valueSize; b++)
+			out[b*nValues+i] = in[i*valueSize+b];
+}
+
+static void byteUnshuffle(const char* in, char* out, size_t valueSize, size_t nValues)
+{	for(size_t i=0; i<nValues; i++)
+		for(size_t b=0; b<valueSize; b++)
+			out[i*valueSize+b] = in[b*nValues+i];
+}
+#endif
+
+//---------- class CheckpointFile -----------
+
+CheckpointHeader::CheckpointHeader()
+: magic(checkpointMagic), version(checkpointVersion), kind(0), nChunks(0), tableChecksum(0),
+	Ecut(0.), nBands(0), nSpinor(0), basisKdep(0)
+{	for(int i=0; i<9; i++) R[i] = 0.;
+	for(int k=0; k<3; k++) S[k] = 0;
+}
+
+CheckpointChunk::CheckpointChunk()
+: nRows(0), nCols(0), isComplex(0), encoding(0), offset(0), nBytes(0), checksum(0), spin(0), weight(0.), nbasis(0)
+{	for(int k=0; k<3; k++) this->k[k] = basisK[k] = 0.;
+}
+
+CheckpointFile::CheckpointFile() : fp(0)
+{
+}
+
+CheckpointFile::~CheckpointFile()
+{	close();
+}
+
+bool CheckpointFile::isCheckpoint(const char* fname)
+{	FILE* fp = fopen(fname, "rb");
+	if(!fp) return false; //error will be reported by legacy reader
+	int64_t magic = 0;
+	bool result = (freadLE(&magic, sizeof(int64_t), 1, fp) == 1) && (magic == checkpointMagic);
+	fclose(fp);
+	return result;
+}
+
+uint32_t CheckpointFile::getTableChecksum() const
+{	std::vector<CheckpointChunk> table(chunks);
+	convertToLE(table.data(), sizeof(int64_t), table.size()*sizeof(CheckpointChunk)/sizeof(int64_t)); //checksum is of stored byte order
+	return checksum((const char*)table.data(), table.size()*sizeof(CheckpointChunk));
+}
+
+void CheckpointFile::encode(int iChunk, const double* data, const CheckpointOptions& options)
+{	CheckpointChunk& chunk = chunks[iChunk];
+	size_t nDoubles = chunk.nDoubles();
+	std::vector<char>& buf = encoded[iChunk];
+	//Convert precision and byte order:
+	chunk.encoding = 0;
+	size_t valueSize = sizeof(double);
+	if(options.singlePrecision && header.kind==CheckpointWavefunctions) //keep fillings, eigenvalues and fluid state exact
+	{	chunk.encoding |= CheckpointSingle;
+		valueSize = sizeof(float);
+		buf.resize(nDoubles*valueSize);
+		float* bufData = (float*)buf.data();
+		for(size_t i=0; i<nDoubles; i++)
+			bufData[i] = float(data[i]);
+	}
+	else buf.assign((const char*)data, (const char*)(data+nDoubles));
+	convertToLE(buf.data(), valueSize, nDoubles);
+	//Compress if required:
+	if(options.compress)
+	{
+		#ifdef ZLIB_ENABLED
+		std::vector<char> bufShuffled(buf.size());
+		byteShuffle(buf.data(), bufShuffled.data(), valueSize, nDoubles);
+		uLongf nBytesOut = compressBound(buf.size());
+		buf.resize(nBytesOut);
+		if(compress2((Bytef*)buf.data(), &nBytesOut, (const Bytef*)bufShuffled.data(), bufShuffled.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+			die_alone("Error compressing checkpoint chunk %d.\n", iChunk);
+		buf.resize(nBytesOut);
+		chunk.encoding |= CheckpointZlib;
+		#else
+		die_alone("Checkpoint compression requires JDFTx to be compiled with zlib support (EnableZlib).\n");
+		#endif
+	}
+	chunk.nBytes = buf.size();
+	chunk.checksum = checksum(buf.data(), buf.size());
+}
+
+void CheckpointFile::write(const char* fname, const TaskDivision* division, AsyncWriter* writer)
+{	this->fname = fname;
+	int nChunks = chunks.size();
+	header.nChunks = nChunks;
+	//Collect metadata of chunks encoded on other processes:
+	if(division && mpiWorld->nProcesses()>1)
+		for(int iSrc=0; iSrc<mpiWorld->nProcesses(); iSrc++)
+		{	int start = division->start(iSrc), stop = division->stop(iSrc);
+			if(stop > start)
+				mpiWorld->bcast((char*)&chunks[start], (stop-start)*sizeof(CheckpointChunk), iSrc);
+		}
+	//Lay out chunks contiguously after the header and table:
+	int nWordsHeader = sizeof(CheckpointHeader)/sizeof(int64_t);
+	int nWordsTable = nChunks*sizeof(CheckpointChunk)/sizeof(int64_t);
+	int64_t offset = sizeof(CheckpointHeader) + nChunks*sizeof(CheckpointChunk);
+	for(CheckpointChunk& chunk: chunks)
+	{	chunk.offset = offset;
+		offset += chunk.nBytes;
+	}
+	header.tableChecksum = getTableChecksum();
+
+	if(writer)
+	{	//Queue header and table from head, and each process's chunks for background write:
+		assert(division);
+		if(mpiWorld->isHead())
+		{	std::vector<char> buf(sizeof(CheckpointHeader) + nChunks*sizeof(CheckpointChunk));
+			memcpy(buf.data(), &header, sizeof(CheckpointHeader));
+			memcpy(buf.data()+sizeof(CheckpointHeader), chunks.data(), nChunks*sizeof(CheckpointChunk));
+			convertToLE(buf.data(), sizeof(int64_t), nWordsHeader+nWordsTable);
+			writer->write(fname, 0, buf, offset);
+		}
+		int chunkStart = division->start(), chunkStop = division->stop();
+		for(int iChunk=chunkStart; iChunk<chunkStop; iChunk++)
+			writer->write(fname, chunks[iChunk].offset, encoded[iChunk]);
+	}
+	else if(division)
+	{	int chunkStart = division->start(), chunkStop = division->stop();
+		#if MPI_SAFE_WRITE
+		//Safe mode / write from head:
+		if(mpiWorld->isHead())
+		{	FILE* fpOut = fopen(fname, "wb");
+			if(!fpOut) die_alone("Error opening file '%s' for writing.\n", fname);
+			fwriteLE(&header, sizeof(int64_t), nWordsHeader, fpOut);
+			fwriteLE(chunks.data(), sizeof(int64_t), nWordsTable, fpOut);
+			for(int iChunk=0; iChunk<nChunks; iChunk++)
+			{	if(division->isMine(iChunk))
+					fwrite(encoded[iChunk].data(), 1, chunks[iChunk].nBytes, fpOut);
+				else
+				{	std::vector<char> buf(chunks[iChunk].nBytes);
+					mpiWorld->recvData(buf, division->whose(iChunk), iChunk);
+					fwrite(buf.data(), 1, buf.size(), fpOut);
+				}
+			}
+			fclose(fpOut);
+		}
+		else
+			for(int iChunk=chunkStart; iChunk<chunkStop; iChunk++)
+				mpiWorld->sendData(encoded[iChunk], 0, iChunk);
+		#else
+		//Collective write using MPI I/O:
+		MPIUtil::File fpOut; mpiWorld->fopenWrite(fpOut, fname);
+		if(mpiWorld->isHead())
+		{	mpiWorld->fwrite(&header, sizeof(int64_t), nWordsHeader, fpOut);
+			mpiWorld->fwrite(chunks.data(), sizeof(int64_t), nWordsTable, fpOut);
+		}
+		for(int iChunk=chunkStart; iChunk<chunkStop; iChunk++)
+		{	mpiWorld->fseek(fpOut, chunks[iChunk].offset, SEEK_SET);
+			mpiWorld->fwrite(encoded[iChunk].data(), 1, chunks[iChunk].nBytes, fpOut);
+		}
+		mpiWorld->fclose(fpOut);
+		#endif
+	}
+	else
+	{	//Serial write from current process:
+		FILE* fpOut = fopen(fname, "wb");
+		if(!fpOut) die_alone("Error opening file '%s' for writing.\n", fname);
+		fwriteLE(&header, sizeof(int64_t), nWordsHeader, fpOut);
+		fwriteLE(chunks.data(), sizeof(int64_t), nWordsTable, fpOut);
+		for(int iChunk=0; iChunk<nChunks; iChunk++)
+		{	assert(encoded.count(iChunk));
+			fwrite(encoded[iChunk].data(), 1, chunks[iChunk].nBytes, fpOut);
+		}
+		fclose(fpOut);
+	}
+	encoded.clear();
+}
+
+void CheckpointFile::open(const char* fname)
+{	close();
+	this->fname = fname;
+	fp = fopen(fname, "rb");
+	if(!fp) die("Error opening checkpoint '%s' for reading.\n", fname);
+	//Header:
+	int nWordsHeader = sizeof(CheckpointHeader)/sizeof(int64_t);
+	if(freadLE(&header, sizeof(int64_t), nWordsHeader, fp) != size_t(nWordsHeader) || header.magic != checkpointMagic)
+		die("File '%s' is not a valid checkpoint container.\n", fname);
+	if(header.version > checkpointVersion)
+		die("Checkpoint '%s' has format version %ld, but this build only supports versions up to %ld.\n",
+			fname, long(header.version), long(checkpointVersion));
+	//Chunk table:
+	chunks.resize(header.nChunks);
+	int nWordsTable = header.nChunks*sizeof(CheckpointChunk)/sizeof(int64_t);
+	if(freadLE(chunks.data(), sizeof(int64_t), nWordsTable, fp) != size_t(nWordsTable))
+		die("Checkpoint '%s' is truncated (incomplete chunk table).\n", fname);
+	if(getTableChecksum() != uint32_t(header.tableChecksum))
+		die("Checkpoint '%s' is corrupted (chunk table checksum mismatch).\n", fname);
+	//File length:
+	int64_t fsizeExpected = sizeof(CheckpointHeader) + header.nChunks*sizeof(CheckpointChunk);
+	for(const CheckpointChunk& chunk: chunks)
+		fsizeExpected = std::max(fsizeExpected, chunk.offset + chunk.nBytes);
+	int64_t fsize = fileSize(fname);
+	if(fsize < fsizeExpected)
+		die("Checkpoint '%s' is truncated: length %ld bytes instead of the expected %ld bytes.\n",
+			fname, long(fsize), long(fsizeExpected));
+}
+
+void CheckpointFile::read(int iChunk, double* data) const
+{	assert(fp);
+	const CheckpointChunk& chunk = chunks[iChunk];
+	size_t nDoubles = chunk.nDoubles();
+	//Read and verify stored data:
+	std::vector<char> buf(chunk.nBytes);
+	fseek(fp, chunk.offset, SEEK_SET);
+	if(fread(buf.data(), 1, buf.size(), fp) != buf.size())
+		die_alone("Checkpoint '%s' is truncated in chunk %d.\n", fname.c_str(), iChunk);
+	if(checksum(buf.data(), buf.size()) != uint32_t(chunk.checksum))
+		die_alone("Checkpoint '%s' is corrupted (checksum mismatch in chunk %d).\n", fname.c_str(), iChunk);
+	//Decompress if necessary:
+	size_t valueSize = (chunk.encoding & CheckpointSingle) ? sizeof(float) : sizeof(double);
+	if(chunk.encoding & CheckpointZlib)
+	{
+		#ifdef ZLIB_ENABLED
+		std::vector<char> bufShuffled(nDoubles*valueSize);
+		uLongf nBytesOut = bufShuffled.size();
+		if(uncompress((Bytef*)bufShuffled.data(), &nBytesOut, (const Bytef*)buf.data(), buf.size()) != Z_OK
+			|| nBytesOut != bufShuffled.size())
+			die_alone("Error decompressing chunk %d of checkpoint '%s'.\n", iChunk, fname.c_str());
+		buf.resize(bufShuffled.size());
+		byteUnshuffle(bufShuffled.data(), buf.data(), valueSize, nDoubles);
+		#else
+		die_alone("Checkpoint '%s' is compressed, which requires JDFTx to be compiled with zlib support (EnableZlib).\n", fname.c_str());
+		#endif
+	}
+	if(buf.size() != nDoubles*valueSize)
+		die_alone("Checkpoint '%s' has inconsistent length of chunk %d.\n", fname.c_str(), iChunk);
+	//Convert byte order and precision:
+	convertFromLE(buf.data(), valueSize, nDoubles);
+	if(chunk.encoding & CheckpointSingle)
+	{	const float* bufData = (const float*)buf.data();
+		for(size_t i=0; i<nDoubles; i++)
+			data[i] = bufData[i];
+	}
+	else memcpy(data, buf.data(), buf.size());
+}
+
+void CheckpointFile::close()
+{	if(fp) { fclose(fp); fp = 0; }
+}
+
+//---------- Scalar field checkpoints -----------
+
+void saveCheckpoint(const ScalarFieldArray& x, const char* fname, const CheckpointOptions& options)
+{	assert(x.size() && x[0]);
+	const GridInfo& gInfo = x[0]->gInfo;
+	CheckpointFile cp;
+	cp.header.kind = CheckpointScalarFields;
+	for(int i=0; i<3; i++)
+	{	for(int j=0; j<3; j++) cp.header.R[3*i+j] = gInfo.R(i,j);
+		cp.header.S[i] = gInfo.S[i];
+	}
+	cp.chunks.resize(x.size());
+	for(unsigned i=0; i<x.size(); i++)
+	{	cp.chunks[i].nRows = gInfo.nr;
+		cp.chunks[i].nCols = 1;
+		cp.encode(i, x[i]->data(), options);
+	}
+	cp.write(fname);
+}
+
+void loadCheckpoint(ScalarFieldArray& x, const char* fname)
+{	assert(x.size() && x[0]);
+	const GridInfo& gInfo = x[0]->gInfo;
+	CheckpointFile cp; cp.open(fname);
+	if(cp.header.kind != CheckpointScalarFields)
+		die("Checkpoint '%s' does not contain scalar fields.\n", fname);
+	if(cp.chunks.size() != x.size())
+		die("Checkpoint '%s' contains %d scalar fields instead of the expected %d.\n", fname, int(cp.chunks.size()), int(x.size()));
+	//Check grid:
+	vector3<int> Sold(cp.header.S[0], cp.header.S[1], cp.header.S[2]);
+	GridInfo gInfoOld;
+	bool needResample = !(Sold == gInfo.S);
+	if(needResample)
+	{	logPrintf("Resampling '%s' from grid %d x %d x %d to %d x %d x %d.\n", fname,
+			Sold[0], Sold[1], Sold[2], gInfo.S[0], gInfo.S[1], gInfo.S[2]);
+		gInfoOld.R = gInfo.R;
+		gInfoOld.S = Sold;
+		logSuspend(); gInfoOld.initialize(); logResume();
+	}
+	const GridInfo& gInfoIn = needResample ? gInfoOld : gInfo;
+	for(unsigned i=0; i<x.size(); i++)
+	{	if(cp.chunks[i].nRows*cp.chunks[i].nCols != gInfoIn.nr || cp.chunks[i].isComplex)
+			die("Checkpoint '%s' has inconsistent dimensions for scalar field %d.\n", fname, i);
+		ScalarField xIn(ScalarFieldData::alloc(gInfoIn));
+		cp.read(i, xIn->data());
+		x[i] = needResample ? changeGrid(xIn, gInfo) : xIn;
+	}
+}
@@ -0,0 +1,130 @@
+/*-------------------------------------------------------------------
+Copyright 2026 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_CHECKPOINT_H
+#define JDFTX_CORE_CHECKPOINT_H
+
+//! @addtogroup Output
+//! @{
+
+//! @file Checkpoint.h Self-describing container format for restart data (wavefunctions, fillings, eigenvalues, fluid state)
+
+#include <core/ScalarFieldArray.h>
+#include <core/MPIUtil.h>
+#include <stdint.h>
+#include <map>
+
+//! Storage options for restart files written in the checkpoint container format
+struct CheckpointOptions
+{	bool enabled; //!< whether to write restart files as checkpoint containers (legacy raw binary otherwise)
+	bool singlePrecision; //!< whether to store wavefunctions in single precision (other restart data is always stored in double precision)
+	bool compress; //!< whether to compress each chunk losslessly (requires zlib support at compile time)
+	CheckpointOptions() : enabled(false), singlePrecision(false), compress(false) {}
+};
+
+//! Contents of a checkpoint container
+enum CheckpointKind
+{	CheckpointWavefunctions, //!< one chunk of band coefficients per k-point
+	CheckpointDiagMatrices, //!< one chunk of band quantities (fillings, eigenvalues) per k-point
+	CheckpointScalarFields //!< one chunk per real-space scalar field (eg. fluid state)
+};
+
+//! Encoding flags for the stored data of each chunk
+enum CheckpointEncoding
+{	CheckpointSingle = 1, //!< stored in single precision
+	CheckpointZlib = 2 //!< compressed with zlib
+};
+
+//! Global metadata at the start of a checkpoint container
+//! (all members are 8-byte quantities, so that the header can be byte-swapped as a whole)
+struct CheckpointHeader
+{	int64_t magic; //!< file signature
+	int64_t version; //!< format version
+	int64_t kind; //!< contents (CheckpointKind)
+	int64_t nChunks; //!< number of chunks in the table following the header
+	int64_t tableChecksum; //!< CRC-32 of the chunk table
+	double R[9]; //!< lattice vectors (row-major matrix3 with lattice vectors in columns)
+	int64_t S[3]; //!< FFT grid dimensions
+	double Ecut; //!< wavefunction cutoff (if applicable)
+	int64_t nBands; //!< number of bands (if applicable)
+	int64_t nSpinor; //!< number of spinor components per band (if applicable)
+	int64_t basisKdep; //!< whether the basis is k-point dependent (if applicable)
+	CheckpointHeader();
+};
+
+//! Metadata of one chunk (eg. one k-point) in a checkpoint container
+//! (all members are 8-byte quantities, so that the table can be byte-swapped as a whole)
+struct CheckpointChunk
+{	int64_t nRows, nCols; //!< dimensions of data (column-major)
+	int64_t isComplex; //!< whether the data is complex
+	int64_t encoding; //!< bitwise-or of CheckpointEncoding flags
+	int64_t offset; //!< byte offset of stored data from the start of file
+	int64_t nBytes; //!< length of stored data in bytes
+	int64_t checksum; //!< CRC-32 of stored data
+	int64_t spin; //!< spin of k-point (if applicable)
+	double k[3]; //!< k-point in reciprocal lattice coordinates (if applicable)
+	double basisK[3]; //!< k-point at which the basis was set up (wavefunctions only)
+	double weight; //!< k-point weight (if applicable)
+	int64_t nbasis; //!< number of plane waves (wavefunctions only)
+	CheckpointChunk();
+	size_t nDoubles() const { return nRows*nCols*(isComplex ? 2 : 1); } //!< number of real values in data
+};
+
+//! Reader / writer for checkpoint containers, which consist of a header, a chunk table and the chunk data.
+//! Chunks may be stored in single precision and/or compressed, and carry checksums verified on read.
+class CheckpointFile
+{
+public:
+	CheckpointHeader header; //!< global metadata
+	std::vector<CheckpointChunk> chunks; //!< chunk metadata (set nRows, nCols, isComplex etc. before encode)
+
+	static bool isCheckpoint(const char* fname); //!< whether fname is a checkpoint container (rather than legacy raw binary)
+
+	//! Encode data (of length chunks[iChunk].nDoubles()) for chunk iChunk, which must be local to this process.
+	//! Single precision (if selected in options) applies only to wavefunction containers (header.kind set before encode).
+	void encode(int iChunk, const double* data, const CheckpointOptions& options);
+
+	//! Write header, chunk table and encoded chunks to file.
+	//! If division is specified, chunks are divided over mpiWorld accordingly and this call is collective;
+	//! otherwise, all chunks must have been encoded on the current process which alone writes the file.
+	//! If writer is specified (which requires division), the data is instead queued for writing in the background.
+	void write(const char* fname, const TaskDivision* division=0, class AsyncWriter* writer=0);
+
+	void open(const char* fname); //!< read and check header and chunk table (independently on each process)
+	void read(int iChunk, double* data) const; //!< read, verify and decode chunk iChunk (after open)
+	void close(); //!< close file opened for reading
+
+	CheckpointFile();
+	~CheckpointFile();
+private:
+	string fname; //!< filename (for error messages)
+	FILE* fp; //!< file opened for reading
+	std::map<int, std::vector<char> > encoded; //!< encoded data of local chunks pending write
+	uint32_t getTableChecksum() const;
+};
+
+//! Save real-space scalar fields (eg. fluid state) as a checkpoint container (call from one process only)
+void saveCheckpoint(const ScalarFieldArray& x, const char* fname, const CheckpointOptions& options);
+
+//! Load real-space scalar fields from a checkpoint container into x, which must be allocated with the expected
+//! number of components on the current grid; data saved on a different grid is Fourier resampled
+void loadCheckpoint(ScalarFieldArray& x, const char* fname);
+
+//! @}
+#endif //JDFTX_CORE_CHECKPOINT_H
@@ -66,6 +66,7 @@ struct CoulombParams
 	std::set<double> omegaSet; //!< set of exchange erf-screening parameters
 	std::shared_ptr<struct Supercell> supercell; //!< Description of k-point supercell for exchange
 	bool computeStress; //!< Whether stress calculation will be required (Isolated and Wire need extra initialization)
+	string kernelCacheDir; //!< Directory for on-disk cache of numerically computed kernels (disabled if empty)
 	
 	CoulombParams();
 	
@@ -87,7 +87,7 @@ CoulombIsolated::CoulombIsolated(const GridInfo& gInfoOrig, const CoulombParams&
 	{	Vc_RRT.init(gInfo.nG);
 		Vc_RRTdata = Vc_RRT.data();
 	}
-	CoulombKernel(gInfo.R, gInfo.S, params.isTruncated()).compute(Vc.data(), ws, Vc_RRTdata);
+	CoulombKernel(gInfo.R, gInfo.S, params.isTruncated(), 0., params.kernelCacheDir).compute(Vc.data(), ws, Vc_RRTdata);
 	initExchangeEval();
 }
 
@@ -27,14 +27,95 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 const double CoulombKernel::nSigmasPerWidth = 1.+sqrt(-2.*log(DBL_EPSILON)); //gaussian negligible at double precision (+1 sigma for safety)
 
-CoulombKernel::CoulombKernel(const matrix3<> R, const vector3<int> S, const vector3<bool> isTruncated, double omega)
-: R(R), S(S), isTruncated(isTruncated), omega(omega)
+//--------- On-disk cache ---------
+
+CoulombKernelCache::CoulombKernelCache(const string& dir, const string& name, const std::vector<double>& key) : key(key)
+{	if(!dir.length()) return; //cache disabled
+	//FNV-1a hash of name and key:
+	uint64_t hash = 14695981039346656037ULL;
+	std::vector<char> buf(name.begin(), name.end());
+	buf.insert(buf.end(), (const char*)key.data(), (const char*)(key.data()+key.size()));
+	for(char c: buf)
+	{	hash ^= uint64_t((unsigned char)c);
+		hash *= 1099511628211ULL;
+	}
+	char hashStr[17]; sprintf(hashStr, "%016llx", (unsigned long long)hash);
+	filename = dir + "/" + name + "_" + hashStr + ".bin";
+}
+
+static const char coulombKernelCacheMagic[] = "JDFTxCoulombKernelCache1"; //identifies cache file format version
+
+bool CoulombKernelCache::load(double* data, size_t nData) const
+{	if(!filename.length()) return false;
+	FILE* fp = fopen(filename.c_str(), "rb");
+	if(!fp) return false; //not in cache
+	//Check header and key:
+	bool match = true;
+	char magic[sizeof(coulombKernelCacheMagic)];
+	uint64_t nKey=0, nDataFile=0;
+	match = match && (fread(magic, 1, sizeof(magic), fp) == sizeof(magic)) && (!strncmp(magic, coulombKernelCacheMagic, sizeof(magic)));
+	match = match && (fread(&nKey, sizeof(uint64_t), 1, fp) == 1) && (nKey == key.size());
+	if(match)
+	{	std::vector<double> keyFile(nKey);
+		match = (fread(keyFile.data(), sizeof(double), nKey, fp) == nKey)
+			&& (!memcmp(keyFile.data(), key.data(), nKey*sizeof(double))); //bitwise comparison
+	}
+	match = match && (fread(&nDataFile, sizeof(uint64_t), 1, fp) == 1) && (nDataFile == nData);
+	match = match && (fread(data, sizeof(double), nData, fp) == nData);
+	fclose(fp);
+	return match;
+}
+
+void CoulombKernelCache::save(const double* data, size_t nData) const
+{	if(!filename.length() || !mpiWorld->isHead()) return;
+	//Write to a temporary file first and then rename, so that concurrent runs never see partial files:
+	ostringstream ossTmp; ossTmp << filename << ".tmp" << getpid();
+	string filenameTmp = ossTmp.str();
+	FILE* fp = fopen(filenameTmp.c_str(), "wb");
+	if(!fp)
+	{	logPrintf("WARNING: could not write Coulomb kernel cache file '%s'.\n", filenameTmp.c_str());
+		return;
+	}
+	uint64_t nKey = key.size(), nData64 = nData;
+	bool success = (fwrite(coulombKernelCacheMagic, 1, sizeof(coulombKernelCacheMagic), fp) == sizeof(coulombKernelCacheMagic))
+		&& (fwrite(&nKey, sizeof(uint64_t), 1, fp) == 1)
+		&& (fwrite(key.data(), sizeof(double), nKey, fp) == nKey)
+		&& (fwrite(&nData64, sizeof(uint64_t), 1, fp) == 1)
+		&& (fwrite(data, sizeof(double), nData, fp) == nData);
+	success = (fclose(fp) == 0) && success;
+	if(success) success = (rename(filenameTmp.c_str(), filename.c_str()) == 0);
+	if(!success)
+	{	logPrintf("WARNING: could not write Coulomb kernel cache file '%s'.\n", filename.c_str());
+		remove(filenameTmp.c_str());
+	}
+}
+
+//--------- Kernel generator ---------
+
+CoulombKernel::CoulombKernel(const matrix3<> R, const vector3<int> S, const vector3<bool> isTruncated, double omega, string cacheDir)
+: R(R), S(S), isTruncated(isTruncated), omega(omega), cacheDir(cacheDir)
 {
 }
 
 
 void CoulombKernel::compute(double* data, const WignerSeitz& ws, symmetricMatrix3<>* data_RRT) const
-{	//Count number of truncated directions:
+{	//Check on-disk cache, keyed by all parameters that the kernel depends on:
+	size_t nG = S[0]*(S[1]*size_t(1+S[2]/2));
+	std::vector<double> key;
+	for(int i=0; i<3; i++)
+		for(int j=0; j<3; j++)
+			key.push_back(R(i,j));
+	for(int k=0; k<3; k++) key.push_back(S[k]);
+	for(int k=0; k<3; k++) key.push_back(isTruncated[k] ? 1. : 0.);
+	key.push_back(omega);
+	CoulombKernelCache cache(cacheDir, "kernel", key);
+	CoulombKernelCache cache_RRT(cacheDir, "kernel_RRT", key);
+	if(cache.load(data, nG) && ((!data_RRT) || cache_RRT.load((double*)data_RRT, 6*nG)))
+	{	logPrintf("Loaded truncated Coulomb kernel from cache file '%s'.\n", cache.getFilename().c_str());
+		return;
+	}
+	
+	//Count number of truncated directions:
 	int nTruncated = 0;
 	for(int k=0; k<3; k++) if(isTruncated[k]) nTruncated++;
 	//Call appropriate routine:
@@ -43,6 +124,13 @@ void CoulombKernel::compute(double* data, const WignerSeitz& ws, symmetricMatrix
 		case 3: computeIsolated(data, ws, data_RRT); break;
 		default: assert(!"Invalid truncated direction count");
 	}
+	
+	//Save to cache if enabled:
+	if(cacheDir.length())
+	{	cache.save(data, nG);
+		if(data_RRT) cache_RRT.save((const double*)data_RRT, 6*nG);
+		logPrintf("Saved truncated Coulomb kernel to cache file '%s'.\n", cache.getFilename().c_str());
+	}
 }
 
 //! Compute erfc(omega r)/r - erfc(a r)/r
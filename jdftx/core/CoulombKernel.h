@@ -23,19 +23,40 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/WignerSeitz.h>
 #include <core/matrix3.h>
 #include <core/string.h>
+#include <vector>
 
 //! @addtogroup LongRange
 //! @{
 //! @file CoulombKernel.h Cached Wigner-Seitz truncated Coulomb kernels
 
+//! Content-addressed on-disk cache for expensive Coulomb kernel data (eg. to reuse kernels across many similar runs).
+//! Entries are identified by a name and a key containing all parameters that the data depends on,
+//! and are stored in files named by a hash of the key; the full key is also stored and checked on load.
+class CoulombKernelCache
+{
+public:
+	//! Access cache entry for data of type name, identified by key, within directory dir (cache disabled if dir is empty)
+	CoulombKernelCache(const string& dir, const string& name, const std::vector<double>& key);
+	
+	bool load(double* data, size_t nData) const; //!< Load nData values into data if in cache (returns true on success)
+	void save(const double* data, size_t nData) const; //!< Save nData values to cache (no-op on all but head process)
+	
+	const string& getFilename() const { return filename; } //!< Get name of cache file (empty if cache disabled)
+	
+private:
+	string filename; //!< cache file name (empty if disabled)
+	std::vector<double> key; //!< parameters identifying the data
+};
+
 //! Wigner-Seitz truncated coulomb kernel generator
 struct CoulombKernel
 {	const matrix3<> R; //!< lattice vectors
 	const vector3<int> S; //!< sample count
 	const vector3<bool> isTruncated; //!< whether corresponding lattice direction is truncated
 	double omega; //!< erf-screening parameter (used for screened exchange kernels)
+	string cacheDir; //!< directory for on-disk cache of computed kernels (see CoulombKernelCache, disabled if empty)
 	
-	CoulombKernel(const matrix3<> R, const vector3<int> S, const vector3<bool> isTruncated, double omega=0.);
+	CoulombKernel(const matrix3<> R, const vector3<int> S, const vector3<bool> isTruncated, double omega=0., string cacheDir=string());
 	
 	//! Initialize the truncated kernel in data
 	//! data must be allocated for S[0]*S[1]*(1+S[2]/2) entries (fftw c2r order).
@@ -96,7 +96,7 @@ double Cbar::integrandLargeRho(double t, void* params)
 
 //--------------- class Cbar_k_sigma ----------
 
-Cbar_k_sigma::Cbar_k_sigma(double k, double sigma, double rhoMax, double rho0, bool prime)
+Cbar_k_sigma::Cbar_k_sigma(double k, double sigma, double rhoMax, double rho0, bool prime, const string& cacheDir)
 {	assert(rhoMax > 0.);
 	//Pick grid and initialize sample values:
 	double drho = 0.03*sigma; //With 5th order splines, this guarantees rel error ~ 1e-14 typical, 1e-12 max
@@ -104,17 +104,22 @@ Cbar_k_sigma::Cbar_k_sigma(double k, double sigma, double rhoMax, double rho0, b
 	isLog = (k != 0.); //When k!=0, samples are positive and interpolate on the logarithm
 	if(prime) assert(k != 0.);
 	std::vector<double> x(size_t(drhoInv*rhoMax)+10);
-	Cbar cbar;
-	for(size_t i=0; i<x.size(); i++)
-	{	double c = 0.;
-		if(prime) //compute -dcbar/dk by finite difference
-		{	double dk = k*1e-5;
-			c = (0.5/dk) * (cbar(k-dk, sigma, i*drho, rho0) - cbar(k+dk, sigma, i*drho, rho0));
+	double keyArr[] = { k, sigma, rhoMax, rho0, prime ? 1. : 0. };
+	CoulombKernelCache cache(cacheDir, "cbar", std::vector<double>(keyArr, keyArr+5));
+	if(!cache.load(x.data(), x.size()))
+	{	Cbar cbar;
+		for(size_t i=0; i<x.size(); i++)
+		{	double c = 0.;
+			if(prime) //compute -dcbar/dk by finite difference
+			{	double dk = k*1e-5;
+				c = (0.5/dk) * (cbar(k-dk, sigma, i*drho, rho0) - cbar(k+dk, sigma, i*drho, rho0));
+			}
+			else c = cbar(k, sigma, i*drho, rho0);
+				
+			if(isLog) x[i] = (c>0 ? log(c) : (i ? x[i-1] : log(DBL_MIN)));
+			else x[i] = c;
 		}
-		else c = cbar(k, sigma, i*drho, rho0);
-			
-		if(isLog) x[i] = (c>0 ? log(c) : (i ? x[i-1] : log(DBL_MIN)));
-		else x[i] = c;
+		cache.save(x.data(), x.size());
 	}
 	coeff = QuinticSpline::getCoeff(x);
 }
@@ -137,7 +142,7 @@ class EwaldWire : public Ewald
 	std::vector<std::shared_ptr<Cbar_k_sigma>> minus_cbar_k_sigma_k; //!< -d(cbar_k_sigma)/dk for stress calculation
 	
 public:
-	EwaldWire(const matrix3<>& R, int iDir, const WignerSeitz& ws, double ionMargin, double Rc=0., double rho0=1.)
+	EwaldWire(const matrix3<>& R, int iDir, const WignerSeitz& ws, double ionMargin, const string& cacheDir, double Rc=0., double rho0=1.)
 	: R(R), G((2*M_PI)*inv(R)), RTR((~R)*R), GGT(G*(~G)), iDir(iDir), ws(ws), ionMargin(ionMargin), Rc(Rc)
 	{	logPrintf("\n---------- Setting up 1D ewald sum ----------\n");
 		//Determine optimum gaussian width for 1D Ewald sums:
@@ -166,8 +171,8 @@ public:
 		double rhoMax = ws.circumRadius(iDir);
 		for(iG[iDir]=0; iG[iDir]<=Nrecip[iDir]; iG[iDir]++)
 		{	double k = sqrt(GGT.metric_length_squared(iG));
-			cbar_k_sigma[iG[iDir]] = std::make_shared<Cbar_k_sigma>(k, sigma, rhoMax, rho0);
-			if(k) minus_cbar_k_sigma_k[iG[iDir]] = std::make_shared<Cbar_k_sigma>(k, sigma, rhoMax, rho0, true);
+			cbar_k_sigma[iG[iDir]] = std::make_shared<Cbar_k_sigma>(k, sigma, rhoMax, rho0, false, cacheDir);
+			if(k) minus_cbar_k_sigma_k[iG[iDir]] = std::make_shared<Cbar_k_sigma>(k, sigma, rhoMax, rho0, true, cacheDir);
 		}
 	}
 	
@@ -287,7 +292,7 @@ CoulombWire::CoulombWire(const GridInfo& gInfoOrig, const CoulombParams& params)
 	{	Vc_RRT.init(gInfo.nG);
 		Vc_RRTdata = Vc_RRT.data();
 	}
-	CoulombKernel(gInfo.R, gInfo.S, params.isTruncated()).compute(Vc.data(), ws, Vc_RRTdata);
+	CoulombKernel(gInfo.R, gInfo.S, params.isTruncated(), 0., params.kernelCacheDir).compute(Vc.data(), ws, Vc_RRTdata);
 	initExchangeEval();
 }
 
@@ -296,7 +301,7 @@ ScalarFieldTilde CoulombWire::apply(ScalarFieldTilde&& in) const
 }
 
 std::shared_ptr<Ewald> CoulombWire::createEwald(matrix3<> R, size_t nAtoms) const
-{	return std::make_shared<EwaldWire>(R, params.iDir, ws, params.ionMargin);
+{	return std::make_shared<EwaldWire>(R, params.iDir, ws, params.ionMargin, params.kernelCacheDir);
 }
 
 matrix3<> CoulombWire::getLatticeGradient(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const
@@ -379,7 +384,7 @@ ScalarFieldTilde CoulombCylindrical::apply(ScalarFieldTilde&& in) const
 }
 
 std::shared_ptr<Ewald> CoulombCylindrical::createEwald(matrix3<> R, size_t nAtoms) const
-{	return std::make_shared<EwaldWire>(R, params.iDir, ws, params.ionMargin, Rc, Rc);
+{	return std::make_shared<EwaldWire>(R, params.iDir, ws, params.ionMargin, params.kernelCacheDir, Rc, Rc);
 }
 
 matrix3<> CoulombCylindrical::getLatticeGradient(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const
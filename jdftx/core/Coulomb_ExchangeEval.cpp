@@ -488,7 +488,7 @@ ExchangeEval::ExchangeEval(const GridInfo& gInfo, const CoulombParams& params, c
 					VcGamma_RRT->init(gInfo.nG);
 					VcGamma_RRTdata = VcGamma_RRT->data();
 				}
-				CoulombKernel(gInfo.R, gInfo.S, params.isTruncated(), omega).compute(VcGamma->data(), ((CoulombIsolated&)coulomb).ws, VcGamma_RRTdata);
+				CoulombKernel(gInfo.R, gInfo.S, params.isTruncated(), omega, params.kernelCacheDir).compute(VcGamma->data(), ((CoulombIsolated&)coulomb).ws, VcGamma_RRTdata);
 			}
 			else //use the same kernel as hartree/Vloc
 			{	VcGamma = &((CoulombIsolated&)coulomb).Vc; 
@@ -530,7 +530,7 @@ ExchangeEval::ExchangeEval(const GridInfo& gInfo, const CoulombParams& params, c
 				if(!dataSuper_RRT) die_alone("Out of memory. (need %.1lfGB for lattice derivatives of supercell exchange kernel)\n", 6*nGsuper*1e-9*sizeof(double));
 			}
 			WignerSeitz wsSuper(Rsuper);
-			CoulombKernel(Rsuper, Ssuper, isTruncated, omega).compute(dataSuper, wsSuper, dataSuper_RRT);
+			CoulombKernel(Rsuper, Ssuper, isTruncated, omega, params.kernelCacheDir).compute(dataSuper, wsSuper, dataSuper_RRT);
 			dataSuper[0] += VzeroCorrection; //For slab/wire geometry kernels in AuxiliaryFunction/ProbeChargeEwald methods
 			if(params.computeStress) dataSuper_RRT[0] += VzeroCorrection_RRT;
 			
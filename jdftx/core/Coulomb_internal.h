@@ -27,6 +27,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/matrix3.h>
 #include <core/Spline.h>
+#include <core/string.h>
 #include <gsl/gsl_integration.h>
 
 //Common citation for Coulomb truncation
@@ -159,8 +160,9 @@ private:
 
 //! Look-up table for Cbar_k^sigma(rho) for specific values of k and sigma
 //! If prime=true, construct lookup table for -d(Cbar_k^sigma(rho))/dk instead
+//! If cacheDir is non-empty, reuse samples from / save samples to an on-disk cache (see CoulombKernelCache)
 struct Cbar_k_sigma
-{	Cbar_k_sigma(double k, double sigma, double rhoMax, double rho0=1., bool prime=false);
+{	Cbar_k_sigma(double k, double sigma, double rhoMax, double rho0=1., bool prime=false, const string& cacheDir=string());
 	//! Get value:
 	inline double value(double rho) const
 	{	double f = QuinticSpline::value(coeff.data(), drhoInv * rho);
@@ -40,6 +40,10 @@ GridInfo::~GridInfo()
 	{	//Destroy cached FFTW plans, if any:
 		for(auto entry: planCache)
 			fftw_destroy_plan(entry.second);
+		#ifdef SINGLE_PRECISION_FFT_ENABLED
+		for(auto entry: planCacheSingle)
+			fftwf_destroy_plan(entry.second);
+		#endif
 		//Destroy GPU plans, if any:
 		#ifdef GPU_ENABLED
 		cufftDestroy(planZ2Z);
@@ -317,3 +321,44 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 	planLock.unlock();
 	return plan;
 }
+
+#ifdef SINGLE_PRECISION_FFT_ENABLED
+fftwf_plan GridInfo::getPlanSingle(GridInfo::PlanType planType, int nThreads) const
+{	//Return cached plan if available:
+	auto key = std::make_pair(planType, nThreads);
+	planLock.lock();
+	auto iter = planCacheSingle.find(key);
+	if(iter != planCacheSingle.end())
+	{	planLock.unlock();
+		return iter->second;
+	}
+	//Create plan:
+	fftwf_import_system_wisdom();
+	#ifdef MKL_PROVIDES_FFT
+	fftw3_mkl.number_of_user_threads = ceildiv(nProcsAvailable, nThreads);
+	#endif
+	fftwf_init_threads();
+	fftwf_plan_with_nthreads(nThreads);
+	bool inPlace = (planType==PlanForwardInPlace) || (planType==PlanInverseInPlace);
+	ManagedArray<fftwf_complex> testMem, testMem2;
+	testMem.init(nr);
+	fftwf_complex* testData = testMem.data();
+	fftwf_complex* testData2 = testData;
+	if(!inPlace)
+	{	testMem2.init(nr);
+		testData2 = testMem2.data();
+	}
+	fftwf_plan plan = 0;
+	switch(planType)
+	{	case PlanInverse:
+		case PlanInverseInPlace: plan = fftwf_plan_dft_3d(S[0], S[1], S[2], testData, testData2, FFTW_BACKWARD, PLANNER_FLAGS); break;
+		case PlanForward:
+		case PlanForwardInPlace: plan = fftwf_plan_dft_3d(S[0], S[1], S[2], testData, testData2, FFTW_FORWARD, PLANNER_FLAGS); break;
+		default: die("Single-precision FFT plans are only available for complex transforms.\n");
+	}
+	if(!plan) die("Failed to create single-precision FFT plan with %d threads",  nThreads);
+	((GridInfo*)this)->planCacheSingle.insert(std::make_pair(key, plan));
+	planLock.unlock();
+	return plan;
+}
+#endif
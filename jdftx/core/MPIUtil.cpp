@@ -370,3 +370,43 @@ int TaskDivision::whose(size_t q) const
 		return std::upper_bound(stopArr.begin(),stopArr.end(), q) - stopArr.begin();
 	else return 0;
 }
+
+
+TaskQueue::TaskQueue(const MPIUtil* mpiUtil)
+{
+	#ifdef MPI_ENABLED
+	MPI_Win_allocate(mpiUtil->isHead() ? sizeof(int) : 0, sizeof(int), MPI_INFO_NULL, mpiUtil->communicator(), &counter, &win);
+	if(mpiUtil->isHead())
+	{	MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, win);
+		*counter = 0;
+		MPI_Win_unlock(0, win);
+	}
+	MPI_Barrier(mpiUtil->communicator());
+	#else
+	counter = 0;
+	#endif
+}
+
+TaskQueue::~TaskQueue()
+{
+	#ifdef MPI_ENABLED
+	MPI_Win_free(&win);
+	#endif
+}
+
+int TaskQueue::next(const MPIUtil* mpiGroup)
+{	int iNext = 0;
+	if(mpiGroup->isHead())
+	{
+		#ifdef MPI_ENABLED
+		int one = 1;
+		MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, win);
+		MPI_Fetch_and_op(&one, &iNext, MPI_INT, 0, 0, MPI_SUM, win);
+		MPI_Win_unlock(0, win);
+		#else
+		iNext = counter++;
+		#endif
+	}
+	mpiGroup->bcast(iNext);
+	return iNext;
+}
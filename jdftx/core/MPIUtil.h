@@ -154,6 +154,23 @@ private:
 	std::vector<size_t> stopArr; //!< array of sttop values for other processes
 };
 
+//! Dynamic distribution of tasks amongst process groups, implemented as an MPI one-sided counter on the head process
+//! (so that a group fetches its next task without any other group having to respond)
+class TaskQueue
+{
+public:
+	TaskQueue(const MPIUtil* mpiUtil); //!< create queue shared by all processes of mpiUtil (collective over mpiUtil)
+	~TaskQueue(); //!< collective over mpiUtil of constructor
+	int next(const MPIUtil* mpiGroup); //!< index of next task to be processed by the current group (collective over mpiGroup)
+private:
+	#ifdef MPI_ENABLED
+	MPI_Win win;
+	int* counter;
+	#else
+	int counter;
+	#endif
+};
+
 //! @}
 
 //-------------------------- Template implementations ------------------------------------
@@ -131,7 +131,7 @@ ScalarField I(ScalarFieldTilde&& in, int nThreads)
 	#ifdef GPU_ENABLED
 	cufftExecZ2D(in->gInfo.planZ2D, (double2*)in->dataGpu(false), out->dataGpu(false));
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
 	fftw_execute_dft_c2r(in->gInfo.getPlan(GridInfo::PlanCtoR, nThreads),
 		(fftw_complex*)in->data(false), out->data(false));
 	#endif
@@ -147,7 +147,7 @@ complexScalarField I(const complexScalarFieldTilde& in, int nThreads)
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)out->dataGpu(false), CUFFT_INVERSE);
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanInverse, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)out->data(false));
 	#endif
@@ -159,7 +159,7 @@ complexScalarField I(complexScalarFieldTilde&& in, int nThreads)
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)in->dataGpu(false), CUFFT_INVERSE);
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanInverseInPlace, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)in->data(false));
 	#endif
@@ -173,7 +173,7 @@ ScalarFieldTilde Idag(const ScalarField& in, int nThreads)
 	#ifdef GPU_ENABLED
 	cufftExecD2Z(in->gInfo.planD2Z, in->dataGpu(false), (double2*)out->dataGpu(false));
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
 	fftw_execute_dft_r2c(in->gInfo.getPlan(GridInfo::PlanRtoC, nThreads),
 		in->data(false), (fftw_complex*)out->data(false));
 	#endif
@@ -185,7 +185,7 @@ complexScalarFieldTilde Idag(const complexScalarField& in, int nThreads)
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)out->dataGpu(false), CUFFT_FORWARD);
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanForward, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)out->data(false));
 	#endif
@@ -197,7 +197,7 @@ complexScalarFieldTilde Idag(complexScalarField&& in, int nThreads)
 	#ifdef GPU_ENABLED
 	cufftExecZ2Z(in->gInfo.planZ2Z, (double2*)in->dataGpu(false), (double2*)in->dataGpu(false), CUFFT_FORWARD);
 	#else
-	if(!nThreads) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
+	if(!nThreads) nThreads = nOperatorThreads();
 	fftw_execute_dft(in->gInfo.getPlan(GridInfo::PlanForwardInPlace, nThreads),
 		(fftw_complex*)in->data(false), (fftw_complex*)in->data(false));
 	#endif
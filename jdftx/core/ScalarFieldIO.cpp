@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/WignerSeitz.h>
 #include <string.h>
 #include <algorithm>
+#include <mutex>
 
 
 void saveDX(const ScalarField& X, const char* filenamePrefix)
@@ -67,6 +68,40 @@ void saveDX(const ScalarField& X, const char* filenamePrefix)
 }
 
 
+//Accumulate radial histogram of grid points iStart to iStop (offset by iOffset into the full grid)
+//into thread-local arrays, and merge them into the output under a lock
+inline void sphericalize_sub(size_t iStart, size_t iStop, size_t iOffset, const GridInfo* gInfo, const WignerSeitz* ws,
+	const vector3<>* xCenter, double drInv, const std::vector<double*>* data, std::vector< std::vector<double> >* out, std::mutex* outLock)
+{	int nColumns = data->size();
+	int nRadial = out->at(0).size();
+	std::vector< std::vector<double> > outThread(nColumns+1, std::vector<double>(nRadial,0.)); //columns followed by weight
+	std::vector<double>& weight = outThread[nColumns];
+	const vector3<int> &S = gInfo->S;
+	matrix3<> invS = inv(Diag(vector3<>(S)));
+	iStart += iOffset;
+	iStop += iOffset;
+	THREAD_rLoop
+	(	double rRel = (gInfo->R * ws->restrict(invS * iv - *xCenter)).length() * drInv;
+		int iRadial = int(floor(rRel));
+		double wRight = (pow(rRel,2) - pow(iRadial,2))/(2*iRadial+1);
+		double wLeft = 1.0 - wRight;
+		if(wLeft && iRadial<nRadial)
+		{	weight[iRadial] += wLeft;
+			for(int c=0; c<nColumns; c++)
+				outThread[c][iRadial] += wLeft * data->at(c)[i];
+		}
+		if(wRight && iRadial+1<nRadial)
+		{	weight[iRadial+1] += wRight;
+			for(int c=0; c<nColumns; c++)
+				outThread[c][iRadial+1] += wRight * data->at(c)[i];
+		}
+	)
+	std::lock_guard<std::mutex> lock(*outLock);
+	for(int c=0; c<nColumns; c++)
+		eblas_daxpy(nRadial, 1., outThread[c].data(),1, out->at(c+1).data(),1);
+	eblas_daxpy(nRadial, 1., weight.data(),1, out->at(nColumns+1).data(),1);
+}
+
 std::vector< std::vector<double> > sphericalize(const ScalarField* dataR, int nColumns, double drFac, vector3< double >* center)
 {	assert(nColumns > 0); assert(dataR[0]);
 	const GridInfo& gInfo = dataR[0]->gInfo;
@@ -104,26 +139,9 @@ std::vector< std::vector<double> > sphericalize(const ScalarField* dataR, int nC
 	for(int c=0; c<nColumns; c++)
 		data[c] = dataR[c]->data();
 	size_t iStart, iStop;
-	TaskDivision(gInfo.nr, mpiWorld).myRange(iStart, iStop);
-	const vector3<int> &S = gInfo.S;
-	matrix3<> invS = inv(Diag(vector3<>(S)));
-	THREAD_rLoop
-	(	 //not actually threaded, but works just as well for MPI division
-		double rRel = (gInfo.R * ws.restrict(invS * iv - xCenter)).length() * drInv;
-		int iRadial = int(floor(rRel));
-		double wRight = (pow(rRel,2) - pow(iRadial,2))/(2*iRadial+1);
-		double wLeft = 1.0 - wRight;
-		if(wLeft && iRadial<nRadial)
-		{	weight[iRadial] += wLeft;
-			for(int c=0; c<nColumns; c++)
-				out[c+1][iRadial] += wLeft * data[c][i];
-		}
-		if(wRight && iRadial+1<nRadial)
-		{	weight[iRadial+1] += wRight;
-			for(int c=0; c<nColumns; c++)
-				out[c+1][iRadial+1] += wRight * data[c][i];
-		}
-	)
+	TaskDivision(gInfo.nr, mpiWorld).myRange(iStart, iStop); //MPI division
+	std::mutex outLock;
+	threadLaunch(sphericalize_sub, iStop-iStart, iStart, &gInfo, &ws, &xCenter, drInv, &data, &out, &outLock); //thread division
 	mpiWorld->allReduceData(weight, MPIUtil::ReduceSum);
 	for(int c=0; c<nColumns; c++)
 	{	mpiWorld->allReduceData(out[c+1], MPIUtil::ReduceSum);
@@ -22,6 +22,15 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <float.h>
 #include <string.h>
 #include <stdio.h>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <deque>
+
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#endif
 
 #if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
 #include <mkl.h>
@@ -40,20 +49,43 @@ int getPhysicalCores()
 
 int nProcsAvailable = getPhysicalCores();
 bool threadOperators = true;
+bool pinThreads = false;
+thread_local int threadGroupSize = 0; //number of threads in the task group of the calling thread (0 if not within threadedTaskLoop)
+thread_local bool threadGroupOperators = true; //operator threading flag for the task group of the calling thread
 
 bool shouldThreadOperators()
-{	return threadOperators;
+{	return threadGroupSize ? (threadGroupOperators && threadGroupSize>1) : threadOperators;
+}
+
+int nOperatorThreads()
+{	if(!shouldThreadOperators()) return 1;
+	return threadGroupSize ? threadGroupSize : nProcsAvailable;
+}
+
+int threadGroupEnter(int nThreads)
+{	int nThreadsPrev = threadGroupSize;
+	threadGroupSize = std::max(1, nThreads);
+	threadGroupOperators = true;
+	return nThreadsPrev;
+}
+
+void threadGroupExit(int nThreadsPrev)
+{	threadGroupSize = nThreadsPrev;
+	//If returning to an enclosing group, it is within threadLaunch, which suspends operator threading:
+	threadGroupOperators = !nThreadsPrev;
 }
 
 void suspendOperatorThreading()
-{	threadOperators = false;
+{	if(threadGroupSize) { threadGroupOperators = false; return; } //only affects the calling task group
+	threadOperators = false;
 	#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
 	mkl_set_num_threads(1);
 	#endif
 }
 
 void resumeOperatorThreading()
-{	threadOperators = true;
+{	if(threadGroupSize) { threadGroupOperators = true; return; } //only affects the calling task group
+	threadOperators = true;
 	#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
 	mkl_set_num_threads(nProcsAvailable);
 	mkl_free_buffers();
@@ -62,3 +94,181 @@ void resumeOperatorThreading()
 	#endif
 	#endif
 }
+
+
+//---------------- Thread pool ----------------
+
+thread_local int threadPoolIndex = 0; //index of calling thread in pool (0 for the main thread, which is not a member of the pool)
+
+//Shared state of one parallel section dispatched by threadPoolRun
+struct ThreadPoolBatch
+{	//Range of jobs remaining in one thread's share:
+	struct Share
+	{	std::mutex lock;
+		size_t iStart, iStop;
+	};
+	
+	const int nSlots; //number of threads requested
+	const size_t nJobs; //number of jobs (0 => one call per thread with thread index)
+	const bool dynamic; //whether shares are processed in chunks that may be stolen
+	const size_t chunkSize; //chunk size in dynamic mode
+	const size_t nUnits; //total work units that must complete (jobs in dynamic mode, else threads)
+	const std::function<void(size_t,size_t)>& task;
+	std::vector<std::atomic<bool>> slotClaimed; //whether each share has been claimed (non-dynamic mode)
+	std::vector<Share> shares; //remaining range of each share (dynamic mode)
+	std::atomic<int> nJoined; //number of pool threads that have joined (excluding submitting thread)
+	std::atomic<size_t> nDone; //number of completed work units
+	std::mutex doneLock; std::condition_variable doneCond;
+	
+	ThreadPoolBatch(int nSlots, size_t nJobs, bool dynamic, const std::function<void(size_t,size_t)>& task)
+	: nSlots(nSlots), nJobs(nJobs), dynamic(dynamic && nJobs),
+		chunkSize(std::max(size_t(1), nJobs/(4*nSlots))), //~4 chunks per share for load balancing
+		nUnits(this->dynamic ? nJobs : nSlots), task(task), slotClaimed(nSlots), shares(this->dynamic ? nSlots : 0), nJoined(0), nDone(0)
+	{	for(std::atomic<bool>& claimed: slotClaimed) claimed = false;
+		for(int t=0; t<int(shares.size()); t++)
+		{	shares[t].iStart = (t*nJobs)/nSlots;
+			shares[t].iStop = ((t+1)*nJobs)/nSlots;
+		}
+	}
+	
+	//Take a chunk from the front (own share) or back (stolen) of share t, returning false if none left:
+	bool take(int t, bool fromFront, size_t& i1, size_t& i2)
+	{	Share& share = shares[t];
+		std::lock_guard<std::mutex> lock(share.lock);
+		if(share.iStart >= share.iStop) return false;
+		size_t nChunk = std::min(chunkSize, share.iStop-share.iStart);
+		if(fromFront) { i1 = share.iStart; i2 = (share.iStart += nChunk); }
+		else { i2 = share.iStop; i1 = (share.iStop -= nChunk); }
+		return true;
+	}
+	
+	void finish(size_t nUnitsDone)
+	{	if(nDone.fetch_add(nUnitsDone) + nUnitsDone == nUnits)
+		{	doneLock.lock(); doneLock.unlock(); //ensures submitter is either waiting or has not yet checked nDone
+			doneCond.notify_all();
+		}
+	}
+	
+	//Do work for this batch from the calling thread, starting with share iHome:
+	void participate(int iHome)
+	{	iHome = iHome % nSlots;
+		if(!dynamic)
+		{	//Claim whole shares, starting with own:
+			for(int k=0; k<nSlots; k++)
+			{	int t = (iHome+k) % nSlots;
+				if(slotClaimed[t].exchange(true)) continue;
+				size_t i1 = nJobs ? (  t   * nJobs)/nSlots : t;
+				size_t i2 = nJobs ? ((t+1) * nJobs)/nSlots : nSlots;
+				task(i1, i2);
+				finish(1);
+			}
+		}
+		else
+		{	size_t i1, i2;
+			//Work through own share from the front:
+			while(take(iHome, true, i1, i2))
+			{	task(i1, i2);
+				finish(i2-i1);
+			}
+			//Steal from the back of other shares:
+			bool found = true;
+			while(found)
+			{	found = false;
+				for(int k=1; k<nSlots; k++)
+				{	int t = (iHome+k) % nSlots;
+					while(take(t, false, i1, i2))
+					{	task(i1, i2);
+						finish(i2-i1);
+						found = true;
+					}
+				}
+			}
+		}
+	}
+};
+
+//Persistent pool of worker threads that join parallel sections submitted by threadPoolRun
+class ThreadPool
+{
+public:
+	ThreadPool() : nWorkers(0) {}
+	
+	void run(int nThreads, size_t nJobs, bool dynamic, const std::function<void(size_t,size_t)>& task)
+	{	std::shared_ptr<ThreadPoolBatch> batch = std::make_shared<ThreadPoolBatch>(nThreads, nJobs, dynamic, task);
+		//Submit batch to workers:
+		queueLock.lock();
+		addWorkers(std::max(nThreads, nProcsAvailable) - 1); //need nProcsAvailable in total for nested sections within threadedTaskLoop
+		queue.push_back(batch);
+		queueLock.unlock();
+		queueCond.notify_all();
+		//Participate from the current thread:
+		batch->participate(threadPoolIndex);
+		//Remove from queue if it was not fully joined:
+		queueLock.lock();
+		for(auto iter=queue.begin(); iter!=queue.end(); iter++)
+			if(*iter == batch) { queue.erase(iter); break; }
+		queueLock.unlock();
+		//Wait for work taken up by other threads to complete:
+		std::unique_lock<std::mutex> lock(batch->doneLock);
+		while(batch->nDone < batch->nUnits)
+			batch->doneCond.wait(lock);
+	}
+	
+private:
+	int nWorkers;
+	std::mutex queueLock;
+	std::condition_variable queueCond;
+	std::deque<std::shared_ptr<ThreadPoolBatch>> queue; //batches that could use more threads
+	std::vector<int> cpus; //processors to pin threads to (if pinThreads)
+	
+	//Grow pool to at least nWorkersMin threads (call with queueLock held):
+	void addWorkers(int nWorkersMin)
+	{	if(pinThreads && !cpus.size()) initPinning();
+		while(nWorkers < nWorkersMin)
+		{	std::thread(&ThreadPool::worker, this, ++nWorkers).detach(); //pool outlives all parallel sections
+		}
+	}
+	
+	void worker(int iWorker)
+	{	threadPoolIndex = iWorker;
+		pin(iWorker);
+		std::unique_lock<std::mutex> lock(queueLock);
+		while(true)
+		{	while(queue.empty()) queueCond.wait(lock);
+			std::shared_ptr<ThreadPoolBatch> batch = queue.front();
+			if(++(batch->nJoined) >= batch->nSlots-1) queue.pop_front(); //batch has all requested threads
+			lock.unlock();
+			batch->participate(iWorker);
+			batch.reset();
+			lock.lock();
+		}
+	}
+	
+	//Pin calling thread to the iThread'th processor available to this process (if pinThreads):
+	void pin(int iThread)
+	{
+		#ifdef __linux__
+		if(!cpus.size()) return;
+		cpu_set_t cpuSet; CPU_ZERO(&cpuSet);
+		CPU_SET(cpus[iThread % cpus.size()], &cpuSet);
+		pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+		#endif
+	}
+	
+	//Determine processors available to this process (respecting binding by mpirun etc.) for pinning workers.
+	//The main thread is deliberately left unpinned: FFTW, BLAS and OpenMP threads it creates inherit its affinity.
+	void initPinning()
+	{
+		#ifdef __linux__
+		cpu_set_t cpuSet; CPU_ZERO(&cpuSet);
+		if(sched_getaffinity(0, sizeof(cpu_set_t), &cpuSet)) return;
+		for(int iCpu=0; iCpu<CPU_SETSIZE; iCpu++)
+			if(CPU_ISSET(iCpu, &cpuSet)) cpus.push_back(iCpu);
+		#endif
+	}
+};
+
+void threadPoolRun(int nThreads, size_t nJobs, bool dynamic, const std::function<void(size_t,size_t)>& task)
+{	static ThreadPool* pool = new ThreadPool(); //never deleted: workers remain blocked until exit
+	pool->run(nThreads, nJobs, dynamic, task);
+}
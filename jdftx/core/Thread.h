@@ -23,14 +23,17 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 //! @addtogroup Utilities
 //! @{
 
-//! @file Thread.h Utilities for threading (wrappers around std::thread)
+//! @file Thread.h Utilities for threading (wrappers around a pool of std::thread)
 
 #include <core/Util.h>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <functional>
 #include <unistd.h>
 
 extern int nProcsAvailable; //!< number of available processors (initialized to number of online processors, can be overriden)
+extern bool pinThreads; //!< whether to pin pool worker threads to processors, leaving the main thread unpinned (set by environment variable JDFTX_PIN_THREADS)
 
 /**
 Operators should run multithreaded if this returns true,
@@ -47,20 +50,35 @@ bool shouldThreadOperators();
 void suspendOperatorThreading(); //!< call from multi-threaded top-level code to disable threading within operators called from a parallel section
 void resumeOperatorThreading(); //!< call after a parallel section in top-level code to resume threading within subsequent operator calls
 
+/**
+Number of threads that operators called from the current thread should use:
+nProcsAvailable from top-level code, the size of the current thread group
+within threadedTaskLoop(), and 1 if operator threading is suspended.
+*/
+int nOperatorThreads();
+
 
 /**
 @brief A simple utility for running muliple threads
 
-Given a callable object func and an argument list args, this routine calls nThreads threads
-of func invoked as func(iMin, iMax, args). The nJobs jobs are evenly split between all the threads;
-each instance of func should handle job index i satisfying iMin <= i < iMax.
+Given a callable object func and an argument list args, this routine runs func on nThreads threads
+invoked as func(iMin, iMax, args), where each instance of func should handle job index i
+satisfying iMin <= i < iMax. The threads are taken from a persistent pool (created on first use)
+rather than created for each call, and the calling thread participates in the work.
+
+If nThreads > 0, the nJobs jobs are evenly split between the threads, with exactly one call per thread.
+If nThreads <= 0, each thread's share is instead processed in smaller chunks that idle threads may
+steal from the end of other shares, so func may be called several times per thread with smaller ranges.
+Each thread begins with the same share on each call, so that threads repeatedly touch the same
+memory for grid operators (improving cache and NUMA locality, especially with #pinThreads).
 
 If nJobs <= 0, the behaviour changes: the function is invoked as func(iThread, nThreads, args)
 instead, where 0 <= iThread < nThreads. This mode allows for more flexible threading than the
 evenly split job management indicated above. This could be used as a convenient interface for
 launching threads for any parallel routine requiring as many threads as processors.
+(Some of these calls may be made sequentially from the same thread if the pool is busy.)
 
-@param nThreads Number of threads to launch (if <=0, as many as processors on system)
+@param nThreads Number of threads to launch (if <=0, as many as processors on system, with dynamic load balancing)
 @param func The function / object with operator() to invoke in a multithreaded fashion
 @param nJobs The number of jobs to be split between the various func threads
 @param args Arguments to pass to func
@@ -106,6 +124,26 @@ Same as #threadedLoop, but func() returns double, which is summed over and retur
 template<typename Callable,typename ... Args>
 double threadedAccumulate(Callable* func, size_t nIter, Args... args);
 
+/**
+@brief A task-parallel loop over a few heavyweight, independent tasks
+
+Given a callable object func and an argument list args, this routine calls func(i, args)
+for each i in [0:nTasks-1], handing out tasks dynamically to nGroups groups of threads.
+The available processors are split evenly between the groups, and operators called
+from within func are threaded only over the processors of the calling group.
+This is useful when individual tasks (eg. k-points of a small unit cell) are
+too small to scale over all processors with operator-level threading alone.
+
+Note that the calls are made from multiple threads, so func must be thread safe.
+
+@param nGroups Number of thread groups (if <=0, as many as tasks or processors, whichever is smaller)
+@param func The function / object with operator() to invoke for each task
+@param nTasks The number of tasks
+@param args Arguments to pass to func
+*/
+template<typename Callable,typename ... Args>
+void threadedTaskLoop(int nGroups, Callable* func, size_t nTasks, Args... args);
+
 //! @}
 
 
@@ -114,23 +152,25 @@ double threadedAccumulate(Callable* func, size_t nIter, Args... args);
 //##########################
 //! @cond
 
+//Run task(iMin, iMax) on nThreads threads of the pool (including the caller), for the job splitting described in threadLaunch
+void threadPoolRun(int nThreads, size_t nJobs, bool dynamic, const std::function<void(size_t,size_t)>& task);
+
+template<typename Callable,typename ... Args>
+void threadPoolCall(size_t iMin, size_t iMax, Callable* func, Args... args)
+{	(*func)(iMin, iMax, args...);
+}
+
 template<typename Callable,typename ... Args>
 void threadLaunch(int nThreads, Callable* func, size_t nJobs, Args... args)
-{	if(nThreads<=0) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
-	if(nThreads>1) suspendOperatorThreading(); //Prevent func and anything it calls from launching nested threads
-	std::thread** tArr = new std::thread*[nThreads-1];
-	for(int t=0; t<nThreads; t++)
-	{	size_t i1 = (nJobs>0 ? (  t   * nJobs)/nThreads : t);
-		size_t i2 = (nJobs>0 ? ((t+1) * nJobs)/nThreads : nThreads);
-		if(t<nThreads-1) tArr[t] = new std::thread(func, i1, i2, args...);
-		else (*func)(i1, i2, args...);
-	}
-	for(int t=0; t<nThreads-1; t++)
-	{	tArr[t]->join();
-		delete tArr[t];
+{	bool dynamic = (nThreads<=0); //only split into stealable chunks when the caller did not ask for a specific thread count
+	if(nThreads<=0) nThreads = nOperatorThreads();
+	if(nThreads==1)
+	{	(*func)(0, (nJobs>0 ? nJobs : 1), args...);
+		return;
 	}
-	delete[] tArr;
-	if(nThreads>1) resumeOperatorThreading(); //End nested threading guard section
+	suspendOperatorThreading(); //Prevent func and anything it calls from launching nested threads
+	threadPoolRun(nThreads, nJobs, dynamic, std::bind(threadPoolCall<Callable,Args...>, std::placeholders::_1, std::placeholders::_2, func, args...));
+	resumeOperatorThreading(); //End nested threading guard section
 }
 
 template<typename Callable,typename ... Args>
@@ -162,5 +202,28 @@ double threadedAccumulate(Callable* func, size_t nIter, Args... args)
 	return accumTot;
 }
 
+int threadGroupEnter(int nThreads); //set operator thread count of the calling thread to that of its task group; returns previous group size
+void threadGroupExit(int nThreadsPrev); //restore state of the calling thread from before threadGroupEnter
+
+template<typename Callable,typename ... Args>
+void threadedTaskLoop_sub(size_t iGroup, size_t nGroups, int nThreadsTot, std::atomic<size_t>* iNext, size_t nTasks, Callable* func, Args... args)
+{	//Divide total threads amongst groups:
+	int nThreadsPrev = threadGroupEnter(((iGroup+1)*nThreadsTot)/nGroups - (iGroup*nThreadsTot)/nGroups);
+	for(size_t i=(*iNext)++; i<nTasks; i=(*iNext)++) (*func)(i, args...);
+	threadGroupExit(nThreadsPrev);
+}
+template<typename Callable,typename ... Args>
+void threadedTaskLoop(int nGroups, Callable* func, size_t nTasks, Args... args)
+{	int nThreadsTot = nOperatorThreads();
+	int nGroupsMax = std::min(size_t(nThreadsTot), nTasks);
+	if(nGroups<=0 || nGroups>nGroupsMax) nGroups = nGroupsMax;
+	if(nGroups<=1)
+	{	for(size_t i=0; i<nTasks; i++) (*func)(i, args...);
+		return;
+	}
+	std::atomic<size_t> iNext(0);
+	threadLaunch(nGroups, threadedTaskLoop_sub<Callable,Args...>, 0, nThreadsTot, &iNext, nTasks, func, args...);
+}
+
 //!@endcond
 #endif // JDFTX_CORE_THREAD_H
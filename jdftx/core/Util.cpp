@@ -145,6 +145,12 @@ void logResume()
 {	globalLog = globalLogOrig;
 }
 
+FILE* logRedirect(FILE* fp)
+{	FILE* fpPrev = globalLogOrig;
+	globalLog = globalLogOrig = fp;
+	return fpPrev;
+}
+
 int nProcessGroups = 0;
 MPIUtil* mpiWorld = 0;
 MPIUtil* mpiGroup = 0;
@@ -273,6 +279,16 @@ void initSystem(int argc, char** argv, const InitParams* ip)
 	}
 	resumeOperatorThreading(); //if necessary, this informs MKL of the thread count
 	
+	//Pin threads to processors if requested:
+	const char* envPinThreads = getenv("JDFTX_PIN_THREADS");
+	if(envPinThreads)
+	{	string pinThreadsStr(envPinThreads);
+		if(pinThreadsStr=="yes" || pinThreadsStr=="1") pinThreads = true;
+		else if(pinThreadsStr=="no" || pinThreadsStr=="0") pinThreads = false;
+		else logPrintf("Could not determine thread pinning from JDFTX_PIN_THREADS=\"%s\" (should be yes or no).\n", envPinThreads);
+		if(pinThreads) logPrintf("Pinning threads to processors available to each process.\n");
+	}
+	
 	//Print total resources used by run:
 	{	int nProcsTot = nProcsAvailable; mpiWorld->allReduce(nProcsTot, MPIUtil::ReduceSum);
 		double nGPUsTot = nGPUs; mpiWorld->allReduce(nGPUsTot, MPIUtil::ReduceSum);
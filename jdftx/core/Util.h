@@ -127,6 +127,7 @@ extern FILE* globalLog;
 extern FILE* nullLog; //!< pointer to /dev/null
 void logSuspend(); //!< temporarily disable all log output (until logResume())
 void logResume(); //!< re-enable logging after a logSuspend() call
+FILE* logRedirect(FILE* fp); //!< send all log output (including after logResume()) to fp, and return the previous log stream (to restore later)
 
 #define logPrintf(...) fprintf(globalLog, __VA_ARGS__) //!< printf() for log files
 #define logFlush() fflush(globalLog) //!< fflush() for log files
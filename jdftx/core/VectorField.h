@@ -301,9 +301,9 @@ namespace ScalarFieldMultipletPrivate
 
 	template<typename FuncOut, typename FuncIn, typename Out, typename In>
 	void threadUnary(FuncOut (*func)(FuncIn,int), int N, Out* out, In in)
-	{	int nThreadsTot = (isGpuEnabled() || !shouldThreadOperators()) ? 1 : nProcsAvailable;
-		int nOperatorThreads = std::min(nThreadsTot, N);
-		threadLaunch(nOperatorThreads, threadUnary_sub<FuncOut,FuncIn,Out,In>, 0, nThreadsTot, N, func, out, in);
+	{	int nThreadsTot = isGpuEnabled() ? 1 : nOperatorThreads();
+		int nOpThreads = std::min(nThreadsTot, N);
+		threadLaunch(nOpThreads, threadUnary_sub<FuncOut,FuncIn,Out,In>, 0, nThreadsTot, N, func, out, in);
 	}
 };
 
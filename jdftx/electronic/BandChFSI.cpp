@@ -0,0 +1,153 @@
+/*-------------------------------------------------------------------
+Copyright 2026 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/BandChFSI.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+#include <core/Random.h>
+
+BandChFSI::BandChFSI(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.eInfo), q(q)
+{	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
+	for(const auto& sp: e.iInfo.species)
+		if(sp->isUltrasoft())
+			die_alone("ChFSI eigenvalue algorithm is not supported with ultrasoft pseudopotentials; use elec-eigen-algo Davidson.\n\n");
+}
+
+ColumnBundle BandChFSI::applyH(ColumnBundle& Y)
+{	std::vector<matrix> VdagY;
+	e.iInfo.project(Y, VdagY);
+	#define SWAP_C_Y \
+		std::swap(eVars.C[q], Y); \
+		std::swap(eVars.VdagC[q], VdagY);
+	SWAP_C_Y //Hamiltonian always operates on C, where we temporarily put Y
+	ColumnBundle HY = eVars.C[q].similar(); HY.zero(); //allocated HY requests H*Y without computing Hsub (Rayleigh-Ritz is done by the caller)
+	Energies ener; //not used here
+	eVars.applyHamiltonian(q, eye(eVars.C[q].nCols()), HY, ener);
+	SWAP_C_Y //Restore C and Y
+	#undef SWAP_C_Y
+	return HY;
+}
+
+double BandChFSI::upperBound(const ColumnBundle& Cref)
+{	//Lanczos on O^-1 H (= H/detR for norm-conserving pseudopotentials) using O inner products:
+	int nSteps = e.cntrl.chfsiLanczosSteps;
+	double detR = Cref.basis->gInfo->detR;
+	ColumnBundle v = Cref.similar(1), vPrev;
+	complex* vData = v.data(); //flat random start (unlike randomize(), which suppresses the high-energy components sought here)
+	for(size_t i=0; i<v.colLength(); i++)
+		vData[i] = Random::normalComplex();
+	v *= 1./sqrt(trace(v^O(v)).real());
+	matrix T = zeroes(nSteps, nSteps);
+	double beta = 0.;
+	for(int j=0; j<nSteps; j++)
+	{	ColumnBundle w = applyH(v) * (1./detR);
+		double alpha = trace(v^O(w)).real();
+		axpy(-alpha, v, w);
+		if(vPrev) axpy(-beta, vPrev, w);
+		T.set(j,j, alpha);
+		beta = sqrt(trace(w^O(w)).real());
+		if(j+1 < nSteps)
+		{	T.set(j,j+1, beta);
+			T.set(j+1,j, beta);
+		}
+		vPrev = v;
+		v = w * (1./beta);
+	}
+	matrix T_evecs; diagMatrix T_eigs;
+	T.diagonalize(T_evecs, T_eigs);
+	return T_eigs.back() + beta; //Ritz estimate of largest eigenvalue plus residual norm
+}
+
+void BandChFSI::minimize()
+{	ColumnBundle& C = eVars.C[q];
+	std::vector<matrix>& VdagC = eVars.VdagC[q];
+	matrix& Hsub = eVars.Hsub[q];
+	matrix& Hsub_evecs = eVars.Hsub_evecs[q];
+	diagMatrix& Hsub_eigs = eVars.Hsub_eigs[q];
+	const QuantumNumber& qnum = eInfo.qnums[q];
+	const MinimizeParams& mp = e.elecMinParams;
+	int nBands = eInfo.nBands;
+	int degree = e.cntrl.chfsiDegree;
+	double detR = C.basis->gInfo->detR;
+	if(nBands >= int(C.basis->nbasis))
+		die_alone("Cannot use ChFSI eigenvalue algorithm when nBands >= nBasis.\n"
+			"Reduce nBands, increase nBasis (Ecut) or use elec-eigen-algo Davidson.\n\n");
+	
+	//Initial Rayleigh-Ritz step in current subspace:
+	ColumnBundle HC;
+	diagMatrix I = eye(nBands);
+	Energies ener; //not really used here
+	eVars.applyHamiltonian(q, I, HC, ener, true);
+	C = C * Hsub_evecs;
+	HC = HC * Hsub_evecs;
+	e.iInfo.project(C, VdagC, &Hsub_evecs);
+	double Eband = qnum.weight * trace(Hsub_eigs);
+	logPrintf("BandChFSI: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(globalLog);
+	
+	//Upper bound of spectrum (unchanged by subspace updates):
+	double Emax = upperBound(C);
+	
+	int iter=1;
+	for(; iter<=mp.nIterations; iter++)
+	{	//Filter bounds: damp [Ecut, Emax], where Ecut is the highest Ritz value, scaled relative to the lowest one
+		double Emin = Hsub_eigs.front();
+		double Ecut = Hsub_eigs.back();
+		if(Ecut >= Emax) Emax = Ecut + 1.; //guard against an underestimated upper bound
+		double halfWidth = 0.5*(Emax - Ecut);
+		double center = 0.5*(Emax + Ecut);
+		double sigma = halfWidth/(Emin - center);
+		double tau = 2./sigma;
+		//Scaled Chebyshev recurrence (first step uses available HC):
+		ColumnBundle Yprev = C;
+		ColumnBundle Y = ((sigma/(halfWidth*detR)) * HC) - ((sigma*center/halfWidth) * C);
+		HC.free();
+		for(int iDeg=2; iDeg<=degree; iDeg++)
+		{	double sigmaNew = 1./(tau - sigma);
+			ColumnBundle HY = applyH(Y);
+			ColumnBundle Ynew = ((2.*sigmaNew/(halfWidth*detR)) * HY) - ((2.*sigmaNew*center/halfWidth) * Y);
+			HY.free();
+			axpy(-sigma*sigmaNew, Yprev, Ynew);
+			Yprev = Y;
+			Y = Ynew;
+			sigma = sigmaNew;
+		}
+		Yprev.free();
+		//Orthonormalize and Rayleigh-Ritz:
+		C = Y; Y.free();
+		eVars.orthonormalize(q);
+		eVars.applyHamiltonian(q, I, HC, ener, true);
+		C = C * Hsub_evecs;
+		HC = HC * Hsub_evecs;
+		e.iInfo.project(C, VdagC, &Hsub_evecs);
+		//Print and test convergence:
+		double EbandPrev = Eband;
+		Eband = qnum.weight * trace(Hsub_eigs);
+		double dEband = Eband - EbandPrev;
+		logPrintf("BandChFSI: Iter: %3d  Eband: %+.15lf  dEband: %le  t[s]: %9.2lf\n", iter, Eband, dEband, clock_sec()); fflush(globalLog);
+		if(fabs(dEband)<mp.energyDiffThreshold)
+		{	logPrintf("BandChFSI: Converged (|dEband|<%le)\n", mp.energyDiffThreshold);
+			break;
+		}
+	}
+	if(iter>mp.nIterations)
+		logPrintf("BandChFSI: None of the convergence criteria satisfied after %d iterations.\n", mp.nIterations);
+	fflush(globalLog);
+	Hsub = Hsub_eigs;
+	Hsub_evecs = I;
+}
@@ -0,0 +1,51 @@
+/*-------------------------------------------------------------------
+Copyright 2026 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_ELECTRONIC_BANDCHFSI_H
+#define JDFTX_ELECTRONIC_BANDCHFSI_H
+
+#include <core/Minimize.h>
+
+class Everything;
+class ColumnBundle;
+
+//! @addtogroup ElecSystem
+//! @{
+
+//! Chebyshev-filtered subspace iteration (ChFSI) eigensolver.
+//! Each iteration applies a Chebyshev polynomial filter that damps the spectrum above the current
+//! subspace (bounds estimated by a short Lanczos run), followed by a single Rayleigh-Ritz step.
+class BandChFSI
+{
+public:
+	BandChFSI(Everything& e, int q); //!< Construct ChFSI eigenvalue solver for quantum number q
+	void minimize(); //!< Converge eigenproblem with tolerance and number of filter passes set by e.elecMinParams
+	
+private:
+	Everything& e;
+	class ElecVars& eVars;
+	const class ElecInfo& eInfo;
+	int q;  //!< Current quantum number
+	
+	ColumnBundle applyH(ColumnBundle& Y); //!< Return H*Y without disturbing the wavefunctions and subspace Hamiltonian of q
+	double upperBound(const ColumnBundle& Cref); //!< Estimate upper bound of spectrum using a short Lanczos run (starting from a random vector similar to Cref)
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_BANDCHFSI_H
@@ -21,11 +21,35 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
 
+//Concatenate columns of A and B (either of which may be empty); used for maintaining the locked set
+inline ColumnBundle joinColumns(const ColumnBundle& A, const ColumnBundle& B)
+{	if(!A) return B;
+	if(!B) return A;
+	ColumnBundle AB = A.similar(A.nCols()+B.nCols());
+	AB.setSub(0, A);
+	AB.setSub(A.nCols(), B);
+	return AB;
+}
+inline matrix joinColumns(const matrix& A, const matrix& B)
+{	if(!A) return B;
+	if(!B) return A;
+	assert(A.nRows() == B.nRows());
+	matrix AB(A.nRows(), A.nCols()+B.nCols());
+	AB.set(0,A.nRows(), 0,A.nCols(), A);
+	AB.set(0,A.nRows(), A.nCols(),AB.nCols(), B);
+	return AB;
+}
+inline diagMatrix joinColumns(const diagMatrix& A, const diagMatrix& B)
+{	diagMatrix AB(A);
+	AB.insert(AB.end(), B.begin(), B.end());
+	return AB;
+}
+
 BandDavidson::BandDavidson(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.eInfo), q(q)
 {	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
 }
 
-void BandDavidson::minimize()
+int BandDavidson::minimize()
 {	//Use the same working set as the CG minimizer:
 	ColumnBundle& C = eVars.C[q];
 	std::vector<matrix>& VdagC = eVars.VdagC[q];
@@ -54,34 +78,93 @@ void BandDavidson::minimize()
 	logPrintf("BandDavidson: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(globalLog);
 	
 	const MinimizeParams& mp = e.elecMinParams;
+	//Use single-precision FFTs for the local potential on expansion vectors while the threshold is loose (eg. early SCF cycles);
+	//HC is recomputed in double precision at the start of each call, so these errors do not persist to tighter thresholds:
+	bool singlePrecisionExp = e.cntrl.mixedPrecisionThreshold && (mp.energyDiffThreshold > e.cntrl.mixedPrecisionThreshold);
+	//Block size: subspace expansion restricted to a window of unlocked bands, which bounds the size of Cexp, HCexp, OCexp and bigHsub.
+	//The window advances cyclically through the unlocked bands, so that every band is expanded once per sweep:
+	int blockSize = e.cntrl.davidsonBlockSize ? e.cntrl.davidsonBlockSize : nBandsMax;
+	int blockStart = 0; //start of expansion window (relative to first unlocked band)
+	int nBandsSwept = 0; double dEbandSweep = 0.; //progress and energy change in the current sweep (when blocked)
+	//Locked bands: lowest eigenpairs with converged residuals, which are
+	//excluded from subspace expansion, Hamiltonian application and subspace rotations:
+	ColumnBundle Clocked, OClocked;
+	std::vector<matrix> VdagClocked(VdagC.size());
+	diagMatrix eigsLocked;
+	int nLocked = 0;
+	double residualThreshold = mp.energyDiffThreshold/nBandsOut; //threshold on squared residual norm per band for locking
 	int iter=1;
 	for(; iter<=mp.nIterations; iter++)
-	{	int nBands = C.nCols();
+	{	//Calculate residual of current eigenvector guesses:
+		ColumnBundle OC = O(C);
+		ColumnBundle Cexp = HC; Cexp -= OC * Hsub_eigs;
+		//Lock lowest bands whose residual has converged:
+		{	diagMatrix residualNorm = diagDot(Cexp, Cexp);
+			int nBands = C.nCols();
+			int nLockNew = 0;
+			while(nLocked+nLockNew<nBandsOut && residualNorm[nLockNew]<residualThreshold)
+				nLockNew++;
+			if(nLocked+nLockNew == nBandsOut)
+			{	//All remaining required bands converged: stop without slicing (C may have no columns left otherwise)
+				nLocked += nLockNew; //these stay at the front of C, and are joined after Clocked below
+				logPrintf("BandDavidson: Converged (all %d bands locked with |residual|^2<%le)\n", nBandsOut, residualThreshold);
+				break;
+			}
+			if(nLockNew)
+			{	Clocked = joinColumns(Clocked, C.getSub(0,nLockNew));
+				OClocked = joinColumns(OClocked, OC.getSub(0,nLockNew));
+				eigsLocked = joinColumns(eigsLocked, Hsub_eigs(0,nLockNew));
+				for(size_t sp=0; sp<VdagC.size(); sp++) if(VdagC[sp])
+				{	VdagClocked[sp] = joinColumns(VdagClocked[sp], VdagC[sp](0,VdagC[sp].nRows(), 0,nLockNew));
+					VdagC[sp] = VdagC[sp](0,VdagC[sp].nRows(), nLockNew,nBands);
+				}
+				C = C.getSub(nLockNew, nBands);
+				HC = HC.getSub(nLockNew, nBands);
+				Cexp = Cexp.getSub(nLockNew, nBands);
+				Hsub_eigs = Hsub_eigs(nLockNew, nBands);
+				nLocked += nLockNew;
+				blockStart = std::max(0, blockStart-nLockNew); //window is relative to the first unlocked band
+			}
+		}
+		OC.free();
+		int nBands = C.nCols();
 		//Compute subspace expansion:
 		diagMatrix KEref = (-0.5) * diagDot(C, L(C)); //Update reference KE for preconditioning:
-		ColumnBundle Cexp = HC; Cexp -= O(C) * Hsub_eigs; //Calculate residual of current eigenvector guesses
 		precond_inv_kinetic_band(Cexp, KEref); //Davidson approximate inverse (using KE as the diagonal)
 		//Drop converged eigenpairs and approximately normalize subspace expansion (for avoiding roundoff issues only):
 		diagMatrix CexpNorm = diagDot(Cexp, Cexp);
 		double CexpNormCut = std::max(mp.energyDiffThreshold/nBands, 1e-15*Cexp.colLength());
-		{	//Drop columns whose norm falls below above cutoff
-			complex* CexpData = Cexp.dataPref();
-			int bOut = 0;
+		bool blocked = (nBandsOut-nLocked > blockSize); //expand only a window of blockSize bands at a time
+		int nBandsWin = nBandsOut-nLocked; //bands cycled through by the window when blocked
+		{	//Select columns above the cutoff (within the current window, when blocked):
+			std::vector<int> bSel;
 			for(int b=0; b<nBands; b++)
-			{	if(CexpNorm[b]<CexpNormCut) continue;
-				CexpNorm[bOut] = 1/sqrt(CexpNorm[b]);
-				if(bOut<b) callPref(eblas_copy)(CexpData+Cexp.index(bOut,0), CexpData+Cexp.index(b,0), Cexp.colLength());
-				bOut++;
-			}
-			if(!bOut) //This is unlikely, but just in case (to avoid zero column matrices below)
+				if(CexpNorm[b]>=CexpNormCut && int(bSel.size())<blockSize
+					&& (!blocked || (b<nBandsWin && ((b-blockStart)%nBandsWin + nBandsWin)%nBandsWin < blockSize)))
+					bSel.push_back(b);
+			if(bSel.empty() && blocked) //current window converged: fall back to the lowest unconverged bands
+				for(int b=0; b<nBands && int(bSel.size())<blockSize; b++)
+					if(CexpNorm[b]>=CexpNormCut)
+						bSel.push_back(b);
+			if(bSel.empty()) //This is unlikely, but just in case (to avoid zero column matrices below)
 			{	logPrintf("BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
 				break;
 			}
+			if(blocked) blockStart = (blockStart + blockSize) % nBandsWin; //advance window for next iteration
+			//Drop unselected columns (bSel is increasing, so the in-place copies are safe):
+			complex* CexpData = Cexp.dataPref();
+			int bOut = bSel.size();
+			for(int iSel=0; iSel<bOut; iSel++)
+			{	int b = bSel[iSel];
+				CexpNorm[iSel] = 1/sqrt(CexpNorm[b]);
+				if(iSel<b) callPref(eblas_copy)(CexpData+Cexp.index(iSel,0), CexpData+Cexp.index(b,0), Cexp.colLength());
+			}
 			if(bOut<nBands)
 			{	Cexp = Cexp.getSub(0,bOut);
 				CexpNorm = CexpNorm(0,bOut);
 			}
 		}
+		if(nLocked) Cexp -= Clocked * (OClocked ^ Cexp); //keep expansion orthogonal to locked bands
 		Cexp = Cexp * CexpNorm;
 		int nBandsNew = Cexp.nCols();
 		int nBandsBig = nBands + nBandsNew;
@@ -107,7 +190,7 @@ void BandDavidson::minimize()
 				std::swap(Hsub, HsubExp); \
 				std::swap(Hsub_eigs, HsubExp_eigs);
 			SWAP_C_Cexp //Temporarily swap C and Cexp
-			eVars.applyHamiltonian(q, eye(nBandsNew), HCexp, ener, true); //Hamiltonian always operates on C, where we put Cexp 
+			eVars.applyHamiltonian(q, eye(nBandsNew), HCexp, ener, true, singlePrecisionExp); //Hamiltonian always operates on C, where we put Cexp 
 			SWAP_C_Cexp  //Restore C and Cexp to correct places
 			matrix CdagHCexp = C  ^ HCexp;
 			bigHsub.set(0,nBands, 0,nBands, Hsub_eigs);
@@ -121,7 +204,7 @@ void BandDavidson::minimize()
 		matrix bigHsub_evecs; diagMatrix bigHsub_eigs;
 		bigHsub.diagonalize(bigHsub_evecs, bigHsub_eigs);
 		matrix rot = bigU * bigHsub_evecs; //rotation from [C,Cexp] to the expanded subspace eigenbasis
-		int nBandsNext = std::min(nBandsMax, nBandsBig); //number of bands to retain for next iteration
+		int nBandsNext = std::min(nBandsMax-nLocked, nBandsBig); //number of bands to retain for next iteration
 		matrix Crot = rot(0,nBands, 0,nBandsNext); //contribution of C to lowest nBandsNext eigenvectors
 		matrix CexpRot = rot(nBands,nBandsBig, 0,nBandsNext); //contribution of Cexp to lowest nBandsNext eigenvectors
 		//Update C to optimum nBands subspace from [C,Cexp]
@@ -132,9 +215,22 @@ void BandDavidson::minimize()
 			VdagC[sp] = VdagC[sp]*Crot + VdagCexp[sp]*CexpRot;
 		//Print and test convergence
 		double EbandPrev = Eband;
-		Eband = qnum.weight * trace(Hsub_eigs(0,nBandsOut));
+		Eband = qnum.weight * (trace(eigsLocked) + trace(Hsub_eigs(0,nBandsOut-nLocked)));
 		double dEband = Eband - EbandPrev;
 		logPrintf("BandDavidson: Iter: %3d  Eband: %+.15lf  dEband: %le  t[s]: %9.2lf\n", iter, Eband, dEband, clock_sec()); fflush(globalLog);
+		if(blocked)
+		{	//Energy change of one iteration only reflects the current window: test the change over a full sweep instead
+			dEbandSweep += dEband;
+			nBandsSwept += blockSize;
+			if(nBandsSwept < nBandsWin) continue;
+			dEband = dEbandSweep;
+			nBandsSwept = 0;
+			dEbandSweep = 0.;
+		}
+		else
+		{	nBandsSwept = 0;
+			dEbandSweep = 0.;
+		}
 		if(dEband<0 and fabs(dEband)<mp.energyDiffThreshold)
 		{	logPrintf("BandDavidson: Converged (dEband<%le)\n", mp.energyDiffThreshold);
 			break;
@@ -144,6 +240,14 @@ void BandDavidson::minimize()
 		logPrintf("BandDavidson: None of the convergence criteria satisfied after %d iterations.\n", mp.nIterations);
 	fflush(globalLog);
 	
+	//Restore locked bands ahead of the active ones:
+	if(Clocked)
+	{	C = joinColumns(Clocked, C);
+		for(size_t sp=0; sp<VdagC.size(); sp++) if(VdagC[sp])
+			VdagC[sp] = joinColumns(VdagClocked[sp], VdagC[sp]);
+		Hsub_eigs = joinColumns(eigsLocked, Hsub_eigs);
+	}
+	
 	//Update final quantities:
 	if(C.nCols() != nBandsOut)
 	{	//reduce outputs to size:
@@ -154,4 +258,5 @@ void BandDavidson::minimize()
 	}
 	Hsub = Hsub_eigs;
 	Hsub_evecs = I;
+	return nLocked;
 }
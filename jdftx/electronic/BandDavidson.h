@@ -33,7 +33,7 @@ class BandDavidson
 {
 public:
 	BandDavidson(Everything& e, int q); //!< Construct Davidson eigenvalue solver for quantum number q
-	void minimize(); //!< Converge eigenproblem with tolerance set by e.elecMinParams
+	int minimize(); //!< Converge eigenproblem with tolerance set by e.elecMinParams, and return number of bands locked by residual convergence
 	
 private:
 	Everything& e;
@@ -37,7 +37,8 @@ double BandMinimizer::compute(ColumnBundle* grad, ColumnBundle* Kgrad)
 	diagMatrix Fq = eye(eInfo.nBands);
 	const QuantumNumber& qnum = eInfo.qnums[q];
 	ColumnBundle Hq;
-	double KEq = eVars.applyHamiltonian(q, Fq, Hq, e.ener, true);
+	Energies ener; //not used here (and local, so that states may be minimized concurrently)
+	double KEq = eVars.applyHamiltonian(q, Fq, Hq, ener, true);
 	if(grad)
 	{	double KErollover = 2.*KEq/(qnum.weight*eInfo.nBands);
 		Hq -=  O(eVars.C[q])*eVars.Hsub[q]; //orthonormality contribution
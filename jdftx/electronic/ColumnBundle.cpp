@@ -24,6 +24,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Random.h>
 #include <core/BlasExtra.h>
 #include <core/ScalarFieldIO.h>
+#include <core/Checkpoint.h>
+#include <core/AsyncWriter.h>
 #include <fftw3.h>
 
 // Called by other constructors to do the work
@@ -182,8 +184,31 @@ void randomize(std::vector<ColumnBundle>& Y, const ElecInfo& eInfo)
 
 //--------- Read/write an array of ColumnBundles from/to a file --------------
 
-void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) const
-{
+void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname, AsyncWriter* writer) const
+{	if(writer)
+	{	//Compute offset of current process and file length as below, and queue a snapshot for background write:
+		std::vector<long> nBytes(mpiWorld->nProcesses(), 0);
+		for(int q=qStart; q<qStop; q++)
+			nBytes[mpiWorld->iProcess()] += Y[q].nData()*sizeof(complex);
+		if(mpiWorld->nProcesses()>1)
+			for(int iSrc=0; iSrc<mpiWorld->nProcesses(); iSrc++)
+				mpiWorld->bcast(nBytes[iSrc], iSrc);
+		long offset=0, fsize=0;
+		for(int iSrc=0; iSrc<mpiWorld->nProcesses(); iSrc++)
+		{	if(iSrc<mpiWorld->iProcess()) offset += nBytes[iSrc];
+			fsize += nBytes[iSrc];
+		}
+		std::vector<char> buf(nBytes[mpiWorld->iProcess()]);
+		char* bufPtr = buf.data();
+		for(int q=qStart; q<qStop; q++)
+		{	size_t nBytesQ = Y[q].nData()*sizeof(complex);
+			memcpy(bufPtr, Y[q].data(), nBytesQ);
+			bufPtr += nBytesQ;
+		}
+		convertToLE(buf.data(), sizeof(double), buf.size()/sizeof(double));
+		writer->write(fname, offset, buf, mpiWorld->isHead() ? fsize : -1);
+		return;
+	}
 #if MPI_SAFE_WRITE
 	//Safe mode / write from head:
 	if(mpiWorld->isHead())
@@ -231,14 +256,29 @@ void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) cons
 }
 
 
+void ElecInfo::writeCheckpoint(const std::vector<ColumnBundle>& Y, const char* fname, const CheckpointOptions& options, AsyncWriter* writer) const
+{	CheckpointFile cp;
+	initCheckpoint(cp, CheckpointWavefunctions);
+	for(int q=qStart; q<qStop; q++)
+	{	CheckpointChunk& chunk = cp.chunks[q];
+		chunk.nRows = Y[q].colLength();
+		chunk.nCols = Y[q].nCols();
+		chunk.isComplex = 1;
+		chunk.nbasis = Y[q].basis->nbasis;
+		cp.encode(q, (const double*)Y[q].data(), options);
+	}
+	cp.write(fname, &qDivision, writer);
+}
+
 ElecInfo::ColumnBundleReadConversion::ColumnBundleReadConversion()
 : realSpace(false), nBandsOld(0), Ecut(0), EcutOld(0)
 {
 }
 
-void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const ColumnBundleReadConversion* conversion) const
-{	if(conversion && conversion->realSpace)
-	{	if(qStop==qStart) return; //no k-point on this process
+int ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const ColumnBundleReadConversion* conversion) const
+{	int nBandsRead = (conversion && conversion->nBandsOld) ? conversion->nBandsOld : nBands;
+	if(conversion && conversion->realSpace)
+	{	if(qStop==qStart) return nBandsRead; //no k-point on this process
 		const GridInfo* gInfoWfns = Y[qStart].basis->gInfo;
 		//Create a custom gInfo if necessary:
 		GridInfo gInfoCustom;
@@ -262,6 +302,51 @@ void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const Colum
 			}
 		}
 	}
+	else if(CheckpointFile::isCheckpoint(fname))
+	{	//Self-describing container: convert basis and bands as needed based on recorded metadata
+		CheckpointFile cp; cp.open(fname);
+		checkCheckpoint(cp, CheckpointWavefunctions, fname);
+		if(conversion && (conversion->nBandsOld || conversion->EcutOld))
+			logPrintf("Note: using basis and band count recorded in checkpoint '%s' instead of nBandsOld / EcutOld.\n", fname);
+		int nSpinor = spinorLength();
+		if(cp.header.nSpinor != nSpinor)
+			die("Checkpoint '%s' has %d spinor components instead of the expected %d.\n", fname, int(cp.header.nSpinor), nSpinor);
+		nBandsRead = cp.header.nBands;
+		for(int q=qStart; q<qStop; q++)
+		{	const CheckpointChunk& chunk = cp.chunks[q];
+			vector3<> basisKold(chunk.basisK[0], chunk.basisK[1], chunk.basisK[2]);
+			bool sameBasis = (cp.header.Ecut == e->cntrl.Ecut)
+				&& ((basisKold - basisK(q)).length_squared() < 1e-12)
+				&& (size_t(chunk.nbasis) == Y[q].basis->nbasis);
+			if(sameBasis && chunk.nCols==Y[q].nCols())
+			{	cp.read(q, (double*)Y[q].data()); //no conversion needed
+				continue;
+			}
+			//Read into temporary with original basis and bands:
+			Basis basisTmp;
+			if(!sameBasis)
+			{	logSuspend();
+				basisTmp.setup(*(Y[q].basis->gInfo), *(Y[q].basis->iInfo), cp.header.Ecut, basisKold);
+				logResume();
+				if(basisTmp.nbasis != size_t(chunk.nbasis))
+					die_alone("Could not reconstruct basis of state %d in checkpoint '%s' (%zu instead of %ld plane waves).\n",
+						q, fname, basisTmp.nbasis, long(chunk.nbasis));
+			}
+			const Basis* basis = sameBasis ? Y[q].basis : &basisTmp;
+			ColumnBundle Ytmp(chunk.nCols, basis->nbasis*nSpinor, basis, Y[q].qnum);
+			cp.read(q, (double*)Ytmp.data());
+			//Convert:
+			if(!sameBasis)
+			{	for(int b=0; b<std::min(Y[q].nCols(), Ytmp.nCols()); b++)
+					for(int s=0; s<nSpinor; s++)
+						Y[q].setColumn(b,s, Ytmp.getColumn(b,s)); //convert using the full G-space as an intermediate
+			}
+			else
+			{	if(Ytmp.nCols()<Y[q].nCols()) Y[q].setSub(0, Ytmp);
+				else Y[q] = Ytmp.getSub(0, Y[q].nCols());
+			}
+		}
+	}
 	else
 	{	//Check if a conversion is actually needed:
 		std::vector<ColumnBundle> Ytmp(qStop);
@@ -325,4 +410,5 @@ void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const Colum
 		}
 		mpiWorld->fclose(fp);
 	}
+	return nBandsRead;
 }
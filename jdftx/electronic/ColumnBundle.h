@@ -142,7 +142,9 @@ vector3<matrix> spinOverlap(const scaled<ColumnBundle> &sY); //!< spin-resolved
 
 //! Return Idag V .* I C (evaluated columnwise)
 //! The handling of the spin structure of V parallels that of diagouterI, with V.size() taking the role of nDensities
-ColumnBundle Idag_DiagV_I(const ColumnBundle& C, const ScalarFieldArray& V);
+//! If singlePrecision is set (and single-precision FFTs are enabled at compile time), the FFTs and the multiply by V
+//! are performed in single precision for non-spinor C on the CPU, with the result accumulated in double precision
+ColumnBundle Idag_DiagV_I(const ColumnBundle& C, const ScalarFieldArray& V, bool singlePrecision=false);
 
 ColumnBundle L(const ColumnBundle &Y); //!< Apply Laplacian
 ColumnBundle Linv(const ColumnBundle &Y); //!< Apply Laplacian inverse
@@ -215,7 +215,40 @@ void Idag_DiagVmat_I_sub(int colStart, int colEnd, const ColumnBundle* C, const
 	
 }
 
-ColumnBundle Idag_DiagV_I(const ColumnBundle& C, const ScalarFieldArray& V)
+#ifdef SINGLE_PRECISION_FFT_ENABLED
+//Single-precision version of Idag_DiagV_I_sub, with Vf containing V (collinear) in single precision on the wavefunction grid
+void Idag_DiagV_I_single_sub(int colStart, int colEnd, const ColumnBundle* C, const std::vector<std::vector<float>>* Vf, ColumnBundle* VC)
+{	const GridInfo& gInfo = *(C->basis->gInfo);
+	const float* Vs = Vf->at(Vf->size()==1 ? 0 : C->qnum->index()).data();
+	fftwf_plan planI = gInfo.getPlanSingle(GridInfo::PlanInverseInPlace, 1);
+	fftwf_plan planIdag = gInfo.getPlanSingle(GridInfo::PlanForwardInPlace, 1);
+	ManagedArray<fftwf_complex> bufMem; bufMem.init(gInfo.nr);
+	fftwf_complex* buf = bufMem.data();
+	size_t nbasis = C->basis->nbasis;
+	const int* index = C->basis->index.data();
+	for(int col=colStart; col<colEnd; col++)
+	{	const complex* Cdata = C->data() + C->index(col,0);
+		complex* VCdata = VC->data() + VC->index(col,0);
+		//Scatter to full box, I, multiply by V and Idag, all in single precision:
+		memset(buf, 0, gInfo.nr*sizeof(fftwf_complex));
+		for(size_t j=0; j<nbasis; j++)
+		{	buf[index[j]][0] = float(Cdata[j].real());
+			buf[index[j]][1] = float(Cdata[j].imag());
+		}
+		fftwf_execute_dft(planI, buf, buf);
+		for(int i=0; i<gInfo.nr; i++)
+		{	buf[i][0] *= Vs[i];
+			buf[i][1] *= Vs[i];
+		}
+		fftwf_execute_dft(planIdag, buf, buf);
+		//Gather-accumulate back in double precision:
+		for(size_t j=0; j<nbasis; j++)
+			VCdata[j] += complex(buf[index[j]][0], buf[index[j]][1]);
+	}
+}
+#endif
+
+ColumnBundle Idag_DiagV_I(const ColumnBundle& C, const ScalarFieldArray& V, bool singlePrecision)
 {	static StopWatch watch("Idag_DiagV_I"); watch.start();
 	ColumnBundle VC = C.similar(); VC.zero();
 	//Convert V to wfns grid if necessary:
@@ -227,6 +260,15 @@ ColumnBundle Idag_DiagV_I(const ColumnBundle& C, const ScalarFieldArray& V)
 	const ScalarFieldArray& Vwfns = Vtmp.size() ? Vtmp : V;
 	assert(Vwfns.size()==1 || Vwfns.size()==2 || Vwfns.size()==4);
 	if(Vwfns.size()==2) assert(!C.isSpinor());
+	#ifdef SINGLE_PRECISION_FFT_ENABLED
+	if(singlePrecision && !isGpuEnabled() && !C.isSpinor()) //Vwfns.size() is 1 or 2 for non-spinor C
+	{	std::vector<std::vector<float>> Vf(Vwfns.size());
+		for(size_t s=0; s<Vwfns.size(); s++)
+			Vf[s].assign(Vwfns[s]->data(), Vwfns[s]->data()+gInfoWfns.nr);
+		threadLaunch(Idag_DiagV_I_single_sub, C.nCols(), &C, &Vf, &VC);
+	}
+	else
+	#endif
 	if(Vwfns.size()==1 || Vwfns.size()==2)
 	{	threadLaunch(isGpuEnabled()?1:0, Idag_DiagV_I_sub, C.nCols(), &C, &Vwfns, &VC);
 	}
@@ -539,7 +581,7 @@ ScalarFieldArray diagouterI(const diagMatrix &F,const ColumnBundle &X,  int nDen
 	if(nDensities==4) assert(X.isSpinor());
 	
 	//Collect the contributions for different sets of columns in separate scalar fields (one per thread):
-	int nThreads = isGpuEnabled() ? 1: nProcsAvailable;
+	int nThreads = isGpuEnabled() ? 1: nOperatorThreads();
 	std::vector<ScalarFieldArray> nSub(nThreads, ScalarFieldArray(nDensities==2 ? 1 : nDensities)); //collinear spin-polarized will have only one non-zero output channel
 	threadLaunch(nThreads, diagouterI_sub, 0, &F, &X, &nSub);
 
@@ -32,7 +32,7 @@ enum BasisKdep { BasisKpointDep, BasisKpointIndep } ;
 static EnumStringMap<BasisKdep> kdepMap(BasisKpointDep, "kpoint-dependent", BasisKpointIndep, "single" );
 
 //! Electronic eigenvalue method
-enum ElecEigenAlgo { ElecEigenCG, ElecEigenDavidson };
+enum ElecEigenAlgo { ElecEigenCG, ElecEigenDavidson, ElecEigenChFSI };
 
 //! Miscellaneous flags controlling electronic DFT
 class Control
@@ -40,7 +40,12 @@ class Control
 public:
 	bool fixed_H; //!< fixed Hamiltonian (band structure) mode for electronic sector
 	bool cacheProjectors; //!< whether to cache nonlocal projectors
+	int kpointThreadGroups; //!< number of thread groups for task-parallel loops over k-points (1 => one k-point at a time, 0 => automatic)
 	double davidsonBandRatio; //!< ratio of number of Davidson working bands to actual bands in system (>= 1)
+	int davidsonBlockSize; //!< maximum number of bands expanded per Davidson iteration (0 => all unlocked bands)
+	int chfsiDegree; //!< degree of Chebyshev filter polynomial in the ChFSI eigensolver
+	int chfsiLanczosSteps; //!< number of Lanczos steps used to estimate the spectral upper bound in the ChFSI eigensolver
+	double mixedPrecisionThreshold; //!< use single-precision FFTs for the Davidson expansion while the eigensolver energy threshold exceeds this (0 => never)
 	int exxBlockSize; //!< number of bands per FFT block used in exact exchange
 	int nOuterVxx; //!< number of outer loop iterations used to converge ACE representation of exact exchange operator
 	
@@ -68,7 +73,7 @@ public:
 	
 	Control()
 	:	fixed_H(false),
-		cacheProjectors(true), davidsonBandRatio(1.1), exxBlockSize(16), nOuterVxx(20),
+		cacheProjectors(true), kpointThreadGroups(1), davidsonBandRatio(1.1), davidsonBlockSize(0), chfsiDegree(10), chfsiLanczosSteps(8), mixedPrecisionThreshold(0.), exxBlockSize(16), nOuterVxx(20),
 		elecEigenAlgo(ElecEigenDavidson), basisKdep(BasisKpointDep), Ecut(0), EcutRho(0), dragWavefunctions(true),
 		fluidGummel_nIterations(10), fluidGummel_Atol(1e-5),
 		shouldPrintEigsFillings(false), shouldPrintEcomponents(false), shouldPrintMuSearch(false), shouldPrintKpointsBasis(false),
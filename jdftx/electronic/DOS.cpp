@@ -517,15 +517,16 @@ void DOS::dump()
 			mpiWorld->sendData(message, 0, 0, 0);
 		}
 	}
-	if(!mpiWorld->isHead()) return;
+	if(mpiWorld->nProcesses()>1) eval.bcastData(mpiWorld); //tetrahedron integration is distributed over bands below
 	
-	//Compute and print density of states (head only):
+	//Compute density of states (distributed over bands) and print it (head only):
 	string header = "\"Energy\"";
 	for(const Weight& weight: weights)
 		header += ("\t\"" + weight.getDescription(*e) + "\"");
 	eval.weldEigenvalues(Etol);
 	for(int iSpin=0; iSpin<nSpins; iSpin++)
-	{	TetrahedralDOS::Lspline dos = eval.getDOS(iSpin, Etol);
+	{	TetrahedralDOS::Lspline dos = eval.getDOS(iSpin, Etol, mpiWorld);
+		if(!mpiWorld->isHead()) continue;
 		if(Esigma>0.) dos = eval.gaussSmooth(dos, Esigma); //apply Gauss smoothing if requested
 		eval.printDOS(dos, e->dump.getFilename(nSpins==1 ? "dos" : (iSpin==0 ? "dosUp" : "dosDn")), header);
 	}
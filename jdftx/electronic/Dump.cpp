@@ -30,16 +30,32 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <fluid/FluidSolver.h>
 #include <core/VectorField.h>
 #include <core/ScalarFieldIO.h>
+#include <core/AsyncWriter.h>
 #include <ctime>
 
 Dump::Dump()
-: potentialSubtraction(true), Munfold(1,1,1), curIter(0)
+: potentialSubtraction(true), Munfold(1,1,1), asyncMaxInFlight(0), curIter(0)
 {
 }
 
+//Save raw binary from head, queuing a snapshot for background write if writer is available:
+template<typename T> void dumpRawBinary(const std::shared_ptr<T>& X, const char* fname, AsyncWriter* writer)
+{	if(writer)
+	{	std::vector<char> buf;
+		if(mpiWorld->isHead())
+		{	buf.resize(X->nElem * sizeof(typename T::DataType));
+			memcpy(buf.data(), X->data(), buf.size());
+			convertToLE(buf.data(), sizeof(double), buf.size()/sizeof(double));
+		}
+		writer->write(fname, 0, buf, mpiWorld->isHead() ? long(buf.size()) : -1);
+	}
+	else if(mpiWorld->isHead()) saveRawBinary(X, fname);
+}
+
 void Dump::setup(const Everything& everything)
 {	e = &everything;
 	if(dos) dos->setup(everything);
+	if(asyncMaxInFlight) asyncWriter = std::make_shared<AsyncWriter>(asyncMaxInFlight);
 	
 	//Add some citations here so that they are included in a dry run:
 	for(auto dumpPair: *this)
@@ -66,6 +82,7 @@ void Dump::setup(const Everything& everything)
 
 void Dump::operator()(DumpFrequency freq, int iter)
 {
+	if(asyncWriter && freq==DumpFreq_End) asyncWriter->commit(true); //complete background writes before final output
 	if(!checkInterval(freq, iter)) return; // => don't dump this time
 	curIter = iter; curFreq = freq; //used by getFilename()
 	
@@ -78,6 +95,10 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	if(!foundVars) return;
 	logPrintf("\n");
 	
+	//Write restart data and fields in the background during the calculation (if enabled):
+	AsyncWriter* writer = (asyncWriter && freq!=DumpFreq_End && freq!=DumpFreq_Init) ? asyncWriter.get() : 0;
+	if(writer) writer->beginBatch();
+	
 	const ElecInfo &eInfo = e->eInfo;
 	const ElecVars &eVars = e->eVars;
 	const IonInfo &iInfo = e->iInfo;
@@ -98,7 +119,7 @@ void Dump::operator()(DumpFrequency freq, int iter)
 
 	#define DUMP_nocheck(object, prefix) \
 		{	StartDump(prefix) \
-			if(mpiWorld->isHead()) saveRawBinary(object, fname.c_str()); \
+			dumpRawBinary(object, fname.c_str(), writer); \
 			EndDump \
 		}
 	
@@ -132,7 +153,8 @@ void Dump::operator()(DumpFrequency freq, int iter)
 		double wInv = eInfo.spinType==SpinNone ? 0.5 : 1.0; //normalization factor from external to internal fillings
 		for(int q=eInfo.qStart; q<eInfo.qStop; q++) ((ElecVars&)eVars).F[q] *= (1./wInv);
 		StartDump("fillings")
-		eInfo.write(eVars.F, fname.c_str());
+		if(checkpoint.enabled) eInfo.writeCheckpoint(eVars.F, fname.c_str(), checkpoint, writer);
+		else eInfo.write(eVars.F, fname.c_str(), 0, writer);
 		EndDump
 		for(int q=eInfo.qStart; q<eInfo.qStop; q++) ((ElecVars&)eVars).F[q] *= wInv;
 	}
@@ -141,7 +163,8 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	{
 		//Dump wave functions
 		StartDump("wfns")
-		eInfo.write(eVars.C, fname.c_str());
+		if(checkpoint.enabled) eInfo.writeCheckpoint(eVars.C, fname.c_str(), checkpoint, writer);
+		else eInfo.write(eVars.C, fname.c_str(), writer);
 		EndDump
 		
 		if(hasFluid)
@@ -262,7 +285,8 @@ void Dump::operator()(DumpFrequency freq, int iter)
 			( (eInfo.fillingsUpdate == ElecInfo::FillingsHsub)
 			|| (e->exCorr.orbitalDep && isCevec) ) ) )
 	{	StartDump("eigenvals")
-		eInfo.write(eVars.Hsub_eigs, fname.c_str());
+		if(checkpoint.enabled) eInfo.writeCheckpoint(eVars.Hsub_eigs, fname.c_str(), checkpoint, writer);
+		else eInfo.write(eVars.Hsub_eigs, fname.c_str(), 0, writer);
 		EndDump
 	}
 	
@@ -778,6 +802,8 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	if(freq==DumpFreq_End && ShouldDump(ElectronScattering))
 	{	electronScattering->dump(*e);
 	}
+	
+	if(writer) writer->endBatch();
 }
 
 bool Dump::checkInterval(DumpFrequency freq, int iter) const
@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/matrix.h>
 #include <core/ScalarField.h>
+#include <core/Checkpoint.h>
 #include <set>
 #include <memory>
 
@@ -85,7 +86,10 @@ public:
 	std::shared_ptr<struct BGWparams> bgwParams; //!< parameters for BGW claculation if any
 	bool potentialSubtraction; //!< whether to subtract neutral-atom potentials in Dvac and Dtot output
 	matrix3<int> Munfold; //!< transformation matrix for band structure unfolding
+	CheckpointOptions checkpoint; //!< format of restart files (wavefunctions, fillings, eigenvalues and fluid state)
+	int asyncMaxInFlight; //!< maximum number of dumps being written in the background (0 => write synchronously)
 private:
+	std::shared_ptr<class AsyncWriter> asyncWriter; //!< background writer (if asyncMaxInFlight > 0)
 	const Everything* e;
 	string format; //!< Filename format containing $VAR, $STAMP, $FREQ etc.
 	string stamp; //!< timestamp for current dump
@@ -112,37 +112,45 @@ void BGW::writeWfn() const
 	else //Default output of bands from usual totalE / bandstructure calculation
 	{	//Create dataset (must happen on all processes together):
 		hsize_t dims[4] = { hsize_t(nBands), hsize_t(nSpins*nSpinor), iGarr.size(), 2 };
-		hid_t sid = H5Screate_simple(4, dims, NULL);
-		hid_t did = H5Dcreate(gidWfns, "coeffs", H5T_NATIVE_DOUBLE, sid, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-		hid_t plid = H5Pcreate(H5P_DATASET_XFER);
-		H5Sclose(sid);
-		//Loop over k, bands and spin/spinors:
-		hsize_t offset[4] = { 0, 0, 0, 0 };
-		hsize_t count[4] = { 1, 1, 1, 2 };
-		std::vector<complex> buffer(*std::max_element(nBasis.begin(), nBasis.end()));
+		hsize_t nGchunk = std::min(hsize_t(nBasisMax), dims[2]);
+		hsize_t chunk[4] = { chunkCount(nBands, nGchunk*sizeof(complex)), 1, nGchunk, 2 };
+		hid_t did = createDataset(gidWfns, "coeffs", 4, dims, chunk);
+		hid_t plid = collectiveTransfer();
+		//Number of collective writes (local states on the process with the most):
+		int nStatesMax = 0;
+		for(int jProcess=0; jProcess<mpiWorld->nProcesses(); jProcess++)
+			nStatesMax = std::max(nStatesMax, eInfo.qStopOther(jProcess) - eInfo.qStartOther(jProcess));
+		//Loop over spinors and local states, writing all bands of each in one block:
+		std::vector<complex> buffer(nBands * nBasisMax);
 		double volScaleFac = sqrt(gInfo.detR);
-		for(int iSpin=0; iSpin<nSpins; iSpin++)
 		for(int iSpinor=0; iSpinor<nSpinor; iSpinor++)
-		{	offset[1] = iSpin*nSpinor + iSpinor;
-			for(int ik=0; ik<nReducedKpts; ik++)
-			{	int q=iSpin*nReducedKpts+ik;
-				if(!eInfo.isMine(q)) continue;
-				count[2] = nBasis[ik];
-				offset[2] = nBasisPrev[ik];
-				hid_t sidMem = H5Screate_simple(4, count, NULL);
-				for(int b=0; b<nBands; b++)
-				{	offset[0] = b;
-					sid = H5Dget_space(did);
+			for(int iState=0; iState<nStatesMax; iState++)
+			{	int q = eInfo.qStart + iState;
+				hid_t sid = H5Dget_space(did);
+				hid_t sidMem;
+				if(q < eInfo.qStop)
+				{	int iSpin = q / nReducedKpts;
+					int ik = q % nReducedKpts;
+					hsize_t offset[4] = { 0, hsize_t(iSpin*nSpinor + iSpinor), hsize_t(nBasisPrev[ik]), 0 };
+					hsize_t count[4] = { hsize_t(nBands), 1, hsize_t(nBasis[ik]), 2 };
 					H5Sselect_hyperslab(sid, H5S_SELECT_SET, offset, NULL, count, NULL);
-					//Copy to buffer and scale:
-					eblas_copy(buffer.data(), eVars.C[q].data()+eVars.C[q].index(b, iSpinor*nBasis[ik]), nBasis[ik]);
-					eblas_zdscal(nBasis[ik], volScaleFac, buffer.data(), 1);
-					//Write buffer to HDF5:
-					H5Dwrite(did, H5T_NATIVE_DOUBLE, sidMem, sid, plid, buffer.data());
+					sidMem = H5Screate_simple(4, count, NULL);
+					//Copy band block to buffer and scale:
+					for(int b=0; b<nBands; b++)
+						eblas_copy(buffer.data()+b*nBasis[ik], eVars.C[q].data()+eVars.C[q].index(b, iSpinor*nBasis[ik]), nBasis[ik]);
+					eblas_zdscal(nBands*nBasis[ik], volScaleFac, buffer.data(), 1);
 				}
+				else //no more states on this process: participate in collective write with empty selection
+				{	H5Sselect_none(sid);
+					hsize_t count[4] = { 1, 1, 1, 2 };
+					sidMem = H5Screate_simple(4, count, NULL);
+					H5Sselect_none(sidMem);
+				}
+				//Write buffer to HDF5:
+				H5Dwrite(did, H5T_NATIVE_DOUBLE, sidMem, sid, plid, buffer.data());
 				H5Sclose(sidMem);
+				H5Sclose(sid);
 			}
-		}
 		H5Pclose(plid);
 		H5Dclose(did);
 	}
@@ -234,6 +242,37 @@ hid_t BGW::openHDF5(string fname) const
 }
 
 
+//Create double dataset (collectively), chunked and compressed as specified in bgwp:
+hid_t BGW::createDataset(hid_t gid, const char* dname, int rank, const hsize_t* dims, const hsize_t* chunk) const
+{	hid_t sid = H5Screate_simple(rank, dims, NULL);
+	hid_t plid = H5Pcreate(H5P_DATASET_CREATE);
+	if(chunk and (bgwp.chunked or bgwp.compressLevel))
+	{	H5Pset_chunk(plid, rank, chunk);
+		if(bgwp.compressLevel) H5Pset_deflate(plid, bgwp.compressLevel); //requires collective writes in parallel HDF5
+	}
+	hid_t did = H5Dcreate(gid, dname, H5T_NATIVE_DOUBLE, sid, H5P_DEFAULT, plid, H5P_DEFAULT);
+	if(did<0) die("Could not create dataset '%s' in HDF5 file.\n", dname);
+	H5Pclose(plid);
+	H5Sclose(sid);
+	return did;
+}
+
+
+//Create transfer property list for collective MPI-IO writes:
+hid_t BGW::collectiveTransfer() const
+{	hid_t plid = H5Pcreate(H5P_DATASET_XFER);
+	H5Pset_dxpl_mpio(plid, H5FD_MPIO_COLLECTIVE);
+	return plid;
+}
+
+
+//Number of items of given size within a chunk of about 1 MB:
+hsize_t BGW::chunkCount(hsize_t countMax, hsize_t bytesPerItem)
+{	const hsize_t chunkBytes = 1<<20;
+	return std::max(hsize_t(1), std::min(countMax, chunkBytes/bytesPerItem));
+}
+
+
 //Write common HDF5 header specifying the mean-field claculation for BGW outputs
 void BGW::writeHeaderMF(hid_t fid) const
 {
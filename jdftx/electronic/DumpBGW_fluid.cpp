@@ -249,10 +249,10 @@ void BGW::writeChiFluid(bool write_q0) const
 	hid_t gidMats = h5createGroup(fid, "mats");
 	hsize_t dims[6] = { hsize_t(q.size()), hsize_t(nSpins*nSpinor),
 		hsize_t(freq.size()), hsize_t(nBasisMax), hsize_t(nBasisMax), 2 };
-	hid_t sid = H5Screate_simple(6, dims, NULL);
-	hid_t did = H5Dcreate(gidMats, "matrix", H5T_NATIVE_DOUBLE, sid, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-	hid_t plid = H5Pcreate(H5P_DATASET_XFER);
-	H5Sclose(sid);
+	hsize_t chunk[6] = { 1, 1, 1, chunkCount(nBasisMax, nBasisMax*sizeof(complex)), hsize_t(nBasisMax), 2 };
+	hid_t did = createDataset(gidMats, "matrix", 6, dims, chunk);
+	hid_t plid = collectiveTransfer(); //all processes write the same number of blocks below
+	hid_t sid;
 	//--- loop over q and frequencies:
 	matrix buf(nRowsMine, nColsMine);
 	for(int iq=0; iq<int(q.size()); iq++)
@@ -309,6 +309,7 @@ void BGW::writeChiFluid(bool write_q0) const
 				hid_t sidMem = H5Screate_simple(6, count, NULL);
 				H5Dwrite(did, H5T_NATIVE_DOUBLE, sidMem, sid, plid, buf.data());
 				H5Sclose(sidMem);
+				H5Sclose(sid);
 			}
 			logPrintf(" %d", iFreq+1); logFlush();
 		}
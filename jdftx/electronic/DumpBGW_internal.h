@@ -41,10 +41,14 @@ struct BGWparams
 	int freqNimag; //!< number of imaginary frequencies
 	double freqPlasma; //!< plasma frequency in Hartrees used in GW imaginary frequency grid, set to zero for RPA frequency grid
 	
+	bool chunked; //!< whether to store large HDF5 datasets (wavefunctions, polarizabilities) in chunks
+	int compressLevel; //!< deflate compression level (0-9) for large HDF5 datasets (non-zero implies chunked)
+	
 	BGWparams() : nBandsDense(0), blockSize(32), clusterSize(10),
 		EcutChiFluid(0.), elecOnly(true),
 		freqReMax_eV(30.), freqReStep_eV(1.), freqBroaden_eV(0.1),
-		freqNimag(25), freqPlasma(1.)
+		freqNimag(25), freqPlasma(1.),
+		chunked(false), compressLevel(0)
 	{}
 };
 
@@ -79,6 +83,9 @@ class BGW
 	std::vector<matrix> VxcSub; //!< exchange-correlation matrix elements
 	
 	hid_t openHDF5(string fname) const; //!< Open HDF5 file for collective access
+	hid_t createDataset(hid_t gid, const char* dname, int rank, const hsize_t* dims, const hsize_t* chunk=0) const; //!< Create double dataset, chunked (and compressed) as specified by bgwp if chunk is non-null
+	hid_t collectiveTransfer() const; //!< Create transfer property list for collective MPI-IO writes (all processes must make the same number of writes)
+	static hsize_t chunkCount(hsize_t countMax, hsize_t bytesPerItem); //!< Number of items (at most countMax) of given size within a chunk of about 1 MB
 	void writeHeaderMF(hid_t fid) const; //!< Write common HDF5 header specifying the mean-field claculation for BGW outputs
 
 public:
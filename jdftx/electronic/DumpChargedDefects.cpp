@@ -178,7 +178,8 @@ struct SlabPeriodicSolver : public LinearSolvable<ScalarFieldTilde>
 	{	return Ksqrt*(J(epsInv*I(Ksqrt*rTilde)));
 	}
 
-	double getEnergy(const ScalarFieldTilde& rho, ScalarFieldTilde& phi)
+	//Potential due to charge rho (solved from scratch, so that results are reproducible when cached below)
+	ScalarFieldTilde getPotential(ScalarFieldTilde rho)
 	{	MinimizeParams mp;
 		mp.nDim = gInfo.nr;
 		mp.knormThreshold = 1e-11;
@@ -186,11 +187,10 @@ struct SlabPeriodicSolver : public LinearSolvable<ScalarFieldTilde>
 		mp.linePrefix = "\tSlabPeriodicCG: ";
 		mp.energyFormat = "%+.15lf";
 
-		zeroNyquist((ScalarFieldTilde&)rho);
+		zeroNyquist(rho);
+		state->zero();
 		solve(rho, mp);
-		
-		phi = state;
-		return 0.5*dot(phi,O(rho));
+		return clone(state);
 	}
 };
 
@@ -282,6 +282,155 @@ struct CylindricalPoisson
 };
 
 
+//Periodic self-energy (with neutralizing background) of Gaussian model charges in vacuum, evaluated analytically
+//by splitting each pair interaction erf(r/(sqrt(2) s))/r into a short-ranged real-space part and a smooth
+//reciprocal-space part of Gaussian width b common to all pairs (s^2 = sum of squared widths of the pair)
+inline double gaussianEwald(const std::vector<ChargedDefect::Center>& center, const matrix3<>& R)
+{	const double nSigmas = 6.; //truncate both sums where the error functions / Gaussians fall below exp(-nSigmas^2)
+	double detR = fabs(det(R));
+	matrix3<> invR = inv(R);
+	matrix3<> GGT = (4*M_PI*M_PI) * (invR * (~invR));
+	//Common width of smooth part (at least the widest pair width, so that short-ranged parts are positive):
+	double sigmaMax = 0.;
+	for(const ChargedDefect::Center& cdc: center)
+		sigmaMax = std::max(sigmaMax, cdc.sigma);
+	double b = std::max(sqrt(2.)*sigmaMax, 0.25*pow(detR, 1./3));
+	double rMax = nSigmas*sqrt(2.)*b;
+	double Gmax = nSigmas*sqrt(2.)/b;
+	vector3<int> nR, nG; //extent of real and reciprocal lattice sums
+	for(int k=0; k<3; k++)
+	{	nR[k] = 1 + int(ceil(rMax * invR.row(k).length()));
+		nG[k] = int(ceil(Gmax * R.column(k).length() / (2*M_PI)));
+	}
+	double E = 0.;
+	for(const ChargedDefect::Center& ci: center)
+		for(const ChargedDefect::Center& cj: center)
+		{	double sSq = ci.sigma*ci.sigma + cj.sigma*cj.sigma, s = sqrt(sSq);
+			vector3<> dx = ci.pos - cj.pos;
+			for(int k=0; k<3; k++) dx[k] -= floor(0.5 + dx[k]); //nearest image
+			double Epair = -2*M_PI*(b*b - sSq)/detR; //G=0 contribution of short-ranged part (neutralizing background)
+			//Real-space sum:
+			vector3<int> iR;
+			for(iR[0]=-nR[0]; iR[0]<=nR[0]; iR[0]++)
+			for(iR[1]=-nR[1]; iR[1]<=nR[1]; iR[1]++)
+			for(iR[2]=-nR[2]; iR[2]<=nR[2]; iR[2]++)
+			{	double r = (R * (dx + iR)).length();
+				if(r > rMax) continue;
+				Epair += r
+					? (erfc(r/(sqrt(2.)*b)) - erfc(r/(sqrt(2.)*s))) / r
+					: sqrt(2./M_PI) * (1./s - 1./b);
+			}
+			//Reciprocal-space sum:
+			vector3<int> iG;
+			for(iG[0]=-nG[0]; iG[0]<=nG[0]; iG[0]++)
+			for(iG[1]=-nG[1]; iG[1]<=nG[1]; iG[1]++)
+			for(iG[2]=-nG[2]; iG[2]<=nG[2]; iG[2]++)
+			{	double Gsq = GGT.metric_length_squared(iG);
+				if(!Gsq || Gsq > Gmax*Gmax) continue;
+				Epair += (4*M_PI/detR) * exp(-0.5*Gsq*b*b) / Gsq * cos(2*M_PI*dot(iG,dx));
+			}
+			E += 0.5 * ci.q * cj.q * Epair;
+		}
+	return E;
+}
+
+
+//Incremental 64-bit FNV-1a hash, used to key the model potential library
+struct ModelKey
+{	uint64_t hash;
+	ModelKey() : hash(0xcbf29ce484222325ULL) {}
+	void add(const void* data, size_t nBytes)
+	{	const unsigned char* bytes = (const unsigned char*)data;
+		for(size_t i=0; i<nBytes; i++)
+		{	hash ^= bytes[i];
+			hash *= 0x100000001b3ULL;
+		}
+	}
+	template<typename T> void add(const T& x) { add(&x, sizeof(T)); }
+	void add(const ScalarField& X) { add(X->data(), sizeof(double)*X->nElem); }
+};
+
+//Slab-geometry model potential of a unit Gaussian charge at one center, for a given lattice and dielectric profile
+struct ModelPotential
+{	std::vector<double> phi; //periodic potential in real space (on the embedding grid, if truncated)
+	double Eisolated; //isolated self-energy
+};
+static std::map<uint64_t,ModelPotential> modelLibrary; //in-memory library (within this process)
+static const size_t modelLibraryMaxEntries = 64; //entries evicted beyond this to bound memory usage
+
+inline string modelLibraryFilename(const string& prefix, uint64_t key)
+{	char buf[32]; sprintf(buf, ".%016llx", (unsigned long long)key);
+	return prefix + buf;
+}
+
+//Retrieve unit-charge model potential from the in-memory library, or else from the on-disk library (if prefix non-empty)
+//Returns false if not available in either, in which case phi and Eisolated are unmodified.
+inline bool findModelPotential(uint64_t key, const string& prefix, const GridInfo& gInfo, ScalarFieldTilde& phi, double& Eisolated)
+{	ScalarField phiR(ScalarFieldData::alloc(gInfo));
+	auto iter = modelLibrary.find(key);
+	if(iter != modelLibrary.end())
+	{	const ModelPotential& mp = iter->second;
+		assert(mp.phi.size() == size_t(gInfo.nr));
+		eblas_copy(phiR->data(), mp.phi.data(), gInfo.nr);
+		phi = J(phiR);
+		Eisolated = mp.Eisolated;
+		return true;
+	}
+	if(!prefix.length()) return false;
+	//Head process reads file (if available and complete) and broadcasts:
+	bool found = false;
+	double EisolatedFile = 0.;
+	if(mpiWorld->isHead())
+	{	FILE* fp = fopen(modelLibraryFilename(prefix, key).c_str(), "rb");
+		if(fp)
+		{	found = (freadLE(&EisolatedFile, sizeof(double), 1, fp) == 1)
+				&& (freadLE(phiR->data(), sizeof(double), gInfo.nr, fp) == size_t(gInfo.nr));
+			fclose(fp);
+		}
+	}
+	mpiWorld->bcast(found);
+	if(!found) return false;
+	mpiWorld->bcast(EisolatedFile);
+	phiR->bcastData(mpiWorld);
+	//Add to in-memory library:
+	if(modelLibrary.size() >= modelLibraryMaxEntries) modelLibrary.erase(modelLibrary.begin());
+	ModelPotential& mp = modelLibrary[key];
+	mp.phi.assign(phiR->data(), phiR->data()+gInfo.nr);
+	mp.Eisolated = EisolatedFile;
+	phi = J(phiR);
+	Eisolated = EisolatedFile;
+	return true;
+}
+
+//Add unit-charge model potential to the in-memory library, and to the on-disk library (if prefix non-empty)
+inline void addModelPotential(uint64_t key, const string& prefix, const ScalarFieldTilde& phi, double Eisolated)
+{	ScalarField phiR = I(phi);
+	const GridInfo& gInfo = phiR->gInfo;
+	if(modelLibrary.size() >= modelLibraryMaxEntries) modelLibrary.erase(modelLibrary.begin());
+	ModelPotential& mp = modelLibrary[key];
+	mp.phi.assign(phiR->data(), phiR->data()+gInfo.nr);
+	mp.Eisolated = Eisolated;
+	if(prefix.length() && mpiWorld->isHead())
+	{	string fname = modelLibraryFilename(prefix, key);
+		FILE* fp = fopen(fname.c_str(), "wb");
+		if(!fp)
+		{	logPrintf("\tWARNING: could not open '%s' for writing model potential.\n", fname.c_str());
+			return;
+		}
+		fwriteLE(&Eisolated, sizeof(double), 1, fp);
+		fwriteLE(phiR->data(), sizeof(double), gInfo.nr, fp);
+		fclose(fp);
+	}
+}
+
+//Gaussian model charge of unit norm at a given center:
+inline ScalarFieldTilde unitModelCharge(const GridInfo& gInfo, const ChargedDefect::Center& cdc)
+{	ScalarFieldTilde trans(ScalarFieldTildeData::alloc(gInfo));
+	initTranslation(trans, gInfo.R * cdc.pos);
+	return gaussConvolve((1./gInfo.detR)*trans, cdc.sigma);
+}
+
+
 void ChargedDefect::dump(const Everything& e, ScalarField d_tot) const
 {	logPrintf("Calculating charged defect correction:\n"); logFlush();
 	if(!center.size())
@@ -291,9 +440,7 @@ void ChargedDefect::dump(const Everything& e, ScalarField d_tot) const
 	ScalarFieldTilde rhoModel;
 	double qTot = 0.;
 	for(const Center& cdc: center)
-	{	ScalarFieldTilde trans(ScalarFieldTildeData::alloc(e.gInfo));
-		initTranslation(trans, e.gInfo.R * cdc.pos);
-		rhoModel += gaussConvolve((cdc.q/e.gInfo.detR)*trans, cdc.sigma);
+	{	rhoModel += cdc.q * unitModelCharge(e.gInfo, cdc);
 		qTot += cdc.q;
 	}
 	
@@ -313,9 +460,9 @@ void ChargedDefect::dump(const Everything& e, ScalarField d_tot) const
 	ScalarField Vmodel; double Emodel=0., EmodelIsolated=0.;
 	switch(geometry)
 	{	case CoulombParams::Periodic: //Bulk defect
-		{	//Periodic potential and energy:
+		{	//Periodic potential (on grid, for alignment) and energy (analytically):
 			ScalarFieldTilde dModel = (*e.coulomb)(rhoModel) * (1./bulkEps); //assuming uniform dielectric
-			Emodel = 0.5*dot(rhoModel, O(dModel));
+			Emodel = gaussianEwald(center, e.gInfo.R) / bulkEps;
 			Vmodel = I(dModel);
 			//Isolated energy:
 			for(const Center& cdc: center)
@@ -326,7 +473,6 @@ void ChargedDefect::dump(const Everything& e, ScalarField d_tot) const
 		{	bool truncated = (e.coulombParams.geometry==CoulombParams::Slab);
 			if(truncated && !e.coulombParams.embed)
 				die("\tCoulomb truncation must be embedded for charged-defect correction in slab geometry.\n");
-			if(truncated) rhoModel = e.coulomb->embedExpand(rhoModel); //switch to embedding grid
 			
 			//Create dielectric model for slab:
 			ScalarFieldArray epsSlab; nullToZero(epsSlab, e.gInfo, 2); //2 components = perp, par
@@ -394,48 +540,92 @@ void ChargedDefect::dump(const Everything& e, ScalarField d_tot) const
 				}
 			}
 			
-			//Periodic potential and energy:
-			ScalarFieldTilde dModel;
+			//Key model potential library on lattice, grids and dielectric profile:
 			bool periodicCoulomb = e.coulombParams.embedFluidMode || (!truncated); //if true, don't use slab truncation in periodic model
-			Emodel = SlabPeriodicSolver(iDir, epsSlab[0], epsSlab[1], kappaSqSlab, periodicCoulomb).getEnergy(rhoModel, dModel);
-			if(truncated) dModel = e.coulomb->embedShrink(dModel);
-			Vmodel = I(dModel);
+			ModelKey profileKey;
+			profileKey.add(e.gInfo.R);
+			profileKey.add(e.gInfo.S);
+			profileKey.add(iDir);
+			profileKey.add(truncated);
+			profileKey.add(periodicCoulomb);
+			profileKey.add(e.coulomb->xCenter);
+			for(int dir=0; dir<2; dir++) profileKey.add(epsSlab[dir]);
+			profileKey.add(kappaSqSlab);
 			
-			//Isolated energy:
-			std::shared_ptr<Coulomb> truncatedCoulomb;
-			if(!truncated)
-			{	//Still use truncation for the isolated case:
-				CoulombParams truncatedParams = e.coulombParams;
-				truncatedParams.geometry = geometry; //Slab
-				truncatedParams.iDir = iDir;
-				truncatedParams.embed = true;
-				logSuspend();
-				truncatedCoulomb = truncatedParams.createCoulomb(e.gInfo);
-				logResume();
-				#define EMBED_EXPAND(x) \
-				{	/*--- Get bulk value ---*/ \
-					double iCut = (0.5 + truncatedParams.embedCenter[iDir]) * e.gInfo.S[iDir]; /* Mesh coordinates of cut point*/ \
-					double t = iCut - floor(iCut); /* Fractional part */ \
-					vector3<int> iL, iR; /* Indices of left and right points into mesh */ \
-					iL[iDir] = positiveRemainder(int(floor(iCut)),  e.gInfo.S[iDir]); \
-					iR[iDir] = positiveRemainder(1+int(floor(iCut)),  e.gInfo.S[iDir]); \
-					double xBulk /* Linearly interpolate: */ \
-						= x->data()[e.gInfo.fullRindex(iL)] * (1.-t) \
-						+ x->data()[e.gInfo.fullRindex(iR)] * t; \
-					/*--- Expand difference from bulk ---*/ \
-					ScalarFieldTilde xTilde = J(x - xBulk); /*subtract bulk value*/ \
-					xTilde = truncatedCoulomb->embedExpand(xTilde); /*switch to embedding grid*/ \
-					x = xBulk + I(xTilde); \
+			//Unit-charge periodic potentials and isolated energies of each center (solved only if not in library):
+			std::vector<ScalarFieldTilde> rhoUnit(center.size()), phiUnit(center.size());
+			std::vector<double> EisolatedUnit(center.size());
+			std::shared_ptr<SlabPeriodicSolver> periodicSolver;
+			std::shared_ptr<CylindricalPoisson> cp;
+			int nCached = 0;
+			for(size_t c=0; c<center.size(); c++)
+			{	const Center& cdc = center[c];
+				rhoUnit[c] = unitModelCharge(e.gInfo, cdc);
+				if(truncated) rhoUnit[c] = e.coulomb->embedExpand(rhoUnit[c]); //switch to embedding grid
+				zeroNyquist(rhoUnit[c]);
+				ModelKey key = profileKey;
+				key.add(cdc.pos);
+				key.add(cdc.sigma);
+				if(findModelPotential(key.hash, libraryPrefix, rhoUnit[c]->gInfo, phiUnit[c], EisolatedUnit[c]))
+				{	nCached++;
+					continue;
+				}
+				//Periodic potential:
+				if(!periodicSolver)
+					periodicSolver = std::make_shared<SlabPeriodicSolver>(iDir, epsSlab[0], epsSlab[1], kappaSqSlab, periodicCoulomb);
+				phiUnit[c] = periodicSolver->getPotential(rhoUnit[c]);
+				//Isolated energy:
+				if(!cp)
+				{	ScalarFieldArray epsIso = epsSlab; ScalarField kappaSqIso = kappaSqSlab; //embedded below if necessary
+					std::shared_ptr<Coulomb> truncatedCoulomb;
+					if(!truncated)
+					{	//Still use truncation for the isolated case:
+						CoulombParams truncatedParams = e.coulombParams;
+						truncatedParams.geometry = geometry; //Slab
+						truncatedParams.iDir = iDir;
+						truncatedParams.embed = true;
+						logSuspend();
+						truncatedCoulomb = truncatedParams.createCoulomb(e.gInfo);
+						logResume();
+						#define EMBED_EXPAND(x) \
+						{	/*--- Get bulk value ---*/ \
+							double iCut = (0.5 + truncatedParams.embedCenter[iDir]) * e.gInfo.S[iDir]; /* Mesh coordinates of cut point*/ \
+							double t = iCut - floor(iCut); /* Fractional part */ \
+							vector3<int> iL, iR; /* Indices of left and right points into mesh */ \
+							iL[iDir] = positiveRemainder(int(floor(iCut)),  e.gInfo.S[iDir]); \
+							iR[iDir] = positiveRemainder(1+int(floor(iCut)),  e.gInfo.S[iDir]); \
+							double xBulk /* Linearly interpolate: */ \
+								= x->data()[e.gInfo.fullRindex(iL)] * (1.-t) \
+								+ x->data()[e.gInfo.fullRindex(iR)] * t; \
+							/*--- Expand difference from bulk ---*/ \
+							ScalarFieldTilde xTilde = J(x - xBulk); /*subtract bulk value*/ \
+							xTilde = truncatedCoulomb->embedExpand(xTilde); /*switch to embedding grid*/ \
+							x = xBulk + I(xTilde); \
+						}
+						for(int dir=0; dir<2; dir++) EMBED_EXPAND(epsIso[dir])
+						EMBED_EXPAND(kappaSqIso);
+						#undef EMBED_EXPAND
+					}
+					cp = std::make_shared<CylindricalPoisson>(iDir, epsIso[0], epsIso[1], kappaSqIso);
 				}
-				for(int dir=0; dir<2; dir++) EMBED_EXPAND(epsSlab[dir])
-				EMBED_EXPAND(kappaSqSlab);
-				#undef EMBED_EXPAND
+				double zCenter = e.gInfo.R.column(iDir).length() * ws.restrict(cdc.pos - e.coulomb->xCenter)[iDir]; //Cartesian axial coordinate of center in embedding grid
+				EisolatedUnit[c] = cp->getEnergy(1., cdc.sigma, zCenter); //self energy of unit Gaussian (accounting for dielectric screening)
+				addModelPotential(key.hash, libraryPrefix, phiUnit[c], EisolatedUnit[c]);
 			}
-			CylindricalPoisson cp(iDir, epsSlab[0], epsSlab[1], kappaSqSlab);
-			for(const Center& cdc: center)
-			{	double zCenter = e.gInfo.R.column(iDir).length() * ws.restrict(cdc.pos - e.coulomb->xCenter)[iDir]; //Cartesian axial coordinate of center in embedding grid
-				EmodelIsolated += cp.getEnergy(cdc.q, cdc.sigma, zCenter); //self energy of Gaussian (accounting for dielectric screening)
+			if(nCached)
+				logPrintf("\tUsing cached model potentials for %d of %d centers.\n", nCached, int(center.size()));
+			
+			//Combine (by linearity in the model charges):
+			ScalarFieldTilde dModel;
+			for(size_t c=0; c<center.size(); c++)
+			{	dModel += center[c].q * phiUnit[c];
+				EmodelIsolated += std::pow(center[c].q,2) * EisolatedUnit[c];
 			}
+			for(size_t c1=0; c1<center.size(); c1++)
+				for(size_t c2=0; c2<center.size(); c2++)
+					Emodel += 0.5 * center[c1].q * center[c2].q * dot(rhoUnit[c1], O(phiUnit[c2]));
+			if(truncated) dModel = e.coulomb->embedShrink(dModel);
+			Vmodel = I(dModel);
 			break;
 		}
 		default: die("\tCoulomb-interaction geometry must be either slab or periodic for charged-defect correction.\n");
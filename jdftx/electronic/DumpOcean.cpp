@@ -40,6 +40,18 @@ void Dump::dumpOcean()
 	int nkPoints = eInfo.nStates / nSpins;
 	double sqrtvol=sqrt(e->gInfo.detR);
 
+	//Post sends of wavefunctions to the owner of the first spin channel at each k, so that
+	//owners of different k-points can convert and write their files concurrently:
+	std::vector<MPIUtil::Request> requests;
+	requests.reserve(eInfo.qStop - eInfo.qStart);
+	for(int q=std::max(eInfo.qStart, nkPoints); q<eInfo.qStop; q++)
+	{	int ik = q % nkPoints;
+		if(!eInfo.isMine(ik))
+		{	requests.push_back(MPIUtil::Request());
+			mpiWorld->sendData(eVars.C[q], eInfo.whose(ik), q/nkPoints, &requests.back()); //use spin as a tag
+		}
+	}
+	
 	logPrintf("\nDumping Kohn-Sham orbitals for the OCEAN code:\n");
 	for(int ik=0; ik<nkPoints; ik++)
 	{
@@ -71,10 +83,9 @@ void Dump::dumpOcean()
 			//Write header:
 			int nbasis = basis.nbasis; //cast nbasis to int
 			fwriteLE(&nbasis, sizeof(int), 1, fp); //Number of G-vectors
-			for(const vector3<int>& iGin: basis.iGarr)
-			{	vector3<int> iGout = iGin + kOffset;
-				fwriteLE(&iGout, sizeof(int), 3, fp); //List of G-vectors
-			}
+			std::vector< vector3<int> > iGout(basis.iGarr.begin(), basis.iGarr.end());
+			for(vector3<int>& iG: iGout) iG += kOffset;
+			fwriteLE(iGout.data(), sizeof(int), 3*nbasis, fp); //List of G-vectors
 			
 			//Collect relevant wavefunctions:
 			std::vector<ColumnBundle> CkTemp(nSpins);
@@ -99,16 +110,8 @@ void Dump::dumpOcean()
 					(phase * (*Cq)).write_real(fp); //outer loop over bands, inner loop over G-vectors
 			
 			fclose(fp);
-			
-		}
-		else //Send wavefunctions to the owner of the first spin channel at this k
-		{
-			for(int s=0; s<nSpins; s++)
-			{	int q = ik + nkPoints*s; //net quantum number
-				if(eInfo.isMine(q))
-					mpiWorld->sendData(eVars.C[q], eInfo.whose(ik), s); //use spin as a tag
-			}
 		}
 		logPrintf("done.\n"); logFlush();
 	}
+	mpiWorld->waitAll(requests);
 }
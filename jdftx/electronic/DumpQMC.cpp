@@ -29,6 +29,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/ScalarFieldIO.h>
 #include <config.h>
 #include <map>
+#include <cstring>
 
 int nAtomsTot(const IonInfo& iInfo)
 {	unsigned res=0;
@@ -99,6 +100,46 @@ struct ImagPartMinimizer: public Minimizable<ElecGradient>  //Uses only the Haux
 	double sync(double x) const { mpiWorld->bcast(x); return x; } //!< All processes minimize together; make sure scalars are in sync to round-off error
 };
 
+//Header for each k-point in the CASINO bwfn.data file
+inline string qmcKpointHeader(int ik, int nBands, int nSpins, vector3<> k)
+{	ostringstream oss;
+	oss.precision(12);
+	oss.setf(std::ios::scientific);
+	oss <<
+		" k-point # ; # of bands (up spin/down spin) ; k-point coords (au)\n"
+		"  " << ik+1 << " " << nBands << " " << (nSpins==2 ? nBands : 0)
+		<< " " << k[0] << " " << k[1] << " " << k[2] << "\n";
+	return oss.str();
+}
+
+//Header for each band in the CASINO bwfn.data file
+inline string qmcBandHeader(int bandIndex, int spinIndex, double eig, bool isReal)
+{	ostringstream oss;
+	oss.precision(12);
+	oss.setf(std::ios::scientific);
+	oss <<
+		" Band, spin, eigenvalue (au), localized\n"
+		"  " << bandIndex << " " << spinIndex << " " << eig << " F\n"
+		" " << (isReal ? "Real" : "Complex") << " blip coefficients for extended orbitals\n";
+	return oss.str();
+}
+
+//Bytes per line of blip coefficients in bwfn.data (fixed width, so that file offsets are known in advance)
+inline int qmcBlipLineWidth(bool isReal)
+{	return isReal ? 23 : 46;
+}
+
+//Format blip coefficients as fixed-width lines of bwfn.data (threaded over grid points)
+void qmcFormatBlip_sub(size_t iStart, size_t iStop, const complex* data, bool isReal, char* buf)
+{	int lineWidth = qmcBlipLineWidth(isReal);
+	char line[64];
+	for(size_t i=iStart; i<iStop; i++)
+	{	if(isReal) snprintf(line, sizeof(line), "%22.12le\n", data[i].real());
+		else snprintf(line, sizeof(line), "  (%20.12le,%20.12le)\n", data[i].real(), data[i].imag());
+		memcpy(buf + i*lineWidth, line, lineWidth);
+	}
+}
+
 void Dump::dumpQMC()
 {
 	const IonInfo &iInfo = e->iInfo;
@@ -193,12 +234,12 @@ void Dump::dumpQMC()
 	
 	//-------------------------------------------------------------------------------------------
 	//Output wavefunctions directly in BLIP-function basis (cubic B-splines)
-	StartDump("bwfn.data")
-	logPrintf("\n");
-	ofs.open(fname);
-	ofs.precision(12);
-	ofs.setf(std::ios::scientific);
-	ofs <<
+	fname = getFilename("bwfn.data");
+	logPrintf("Dumping '%s'...\n", fname.c_str()); logFlush();
+	ostringstream oss; //header (identical on all processes)
+	oss.precision(12);
+	oss.setf(std::ios::scientific);
+	oss <<
 		"CASINO Blip orbitals exported by  " PACKAGE_NAME "\n"
 		"\n"
 		"BASIC INFO\n"
@@ -240,11 +281,11 @@ void Dump::dumpQMC()
 		{
 			assert(sp->atomicNumber);
 			vector3<> coord(gInfo.R * sp->atpos[a]);
-			ofs << "  " << sp->atomicNumber << " "
+			oss << "  " << sp->atomicNumber << " "
 				<< coord[0] << " " << coord[1] << " " << coord[2]
 				<< "\n";
 		}
-	ofs <<
+	oss <<
 		" Primitive lattice vectors (au)\n"
 		"  " << gInfo.R(0,0) << " " << gInfo.R(1,0) << " " << gInfo.R(2,0) << "\n"
 		"  " << gInfo.R(0,1) << " " << gInfo.R(1,1) << " " << gInfo.R(2,1) << "\n"
@@ -256,13 +297,13 @@ void Dump::dumpQMC()
 		"  " << basis.nbasis << "\n"
 		" Gx Gy Gz (au)\n";
 	vector3<> Gvec;
-	ofs << "  " << Gvec[0] << " " << Gvec[1] << " " << Gvec[2] << "\n"; //G=0
+	oss << "  " << Gvec[0] << " " << Gvec[1] << " " << Gvec[2] << "\n"; //G=0
 	for(const vector3<int>& iG: basis.iGarr) //G!=0:
 		if(iG.length_squared())
 		{	vector3<> Gvec = iG * gInfo.G;		
-			ofs << "  " << Gvec[0] << " " << Gvec[1] << " " << Gvec[2] << "\n";
+			oss << "  " << Gvec[0] << " " << Gvec[1] << " " << Gvec[2] << "\n";
 		}
-	ofs <<
+	oss <<
 		" Blip Grid\n"
 		"  " << gInfo.S[0] << " " << gInfo.S[1] << " " << gInfo.S[2] << "\n"
 		"\n"
@@ -270,7 +311,7 @@ void Dump::dumpQMC()
 		"-------------\n";
 	int nSpins = eInfo.nSpins();
 	int nkPoints = eInfo.nStates / nSpins;
-	ofs <<
+	oss <<
 		" Number of k-points\n"
 		"  " << nkPoints << "\n";
 
@@ -293,105 +334,104 @@ void Dump::dumpQMC()
 		}
 	}
 	
+	//Determine file layout: header, and for each k-point a k-point header followed by band blocks for each spin
+	//(blip coefficients are written as fixed-width lines, so that the offset of each block is known in advance)
+	bool isReal = (nkPoints==1);
+	std::vector<string> kpointHeaders(nkPoints);
 	for(int ik=0; ik<nkPoints; ik++)
-	{
-		vector3<> k(eInfo.qnums[ik].k * gInfo.G); //cartesian k-vector
-		ofs <<
-			" k-point # ; # of bands (up spin/down spin) ; k-point coords (au)\n"
-			"  " << ik+1 << " " << eInfo.nBands << " " << (nSpins==2 ? eInfo.nBands : 0)
-			<< " " << k[0] << " " << k[1] << " " << k[2] << "\n";
+		kpointHeaders[ik] = qmcKpointHeader(ik, eInfo.nBands, nSpins, eInfo.qnums[ik].k * gInfo.G);
+	std::vector<long> stateBytes(eInfo.nStates, 0); //size of band blocks of each state
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	int s = q / nkPoints;
+		for(int b=0; b<eInfo.nBands; b++)
+			stateBytes[q] += qmcBandHeader(b+1 + s*eInfo.nBands, 1-2*s, eVars.Hsub_eigs[q][b], isReal).length()
+				+ long(gInfo.nr) * qmcBlipLineWidth(isReal);
+	}
+	mpiWorld->allReduceData(stateBytes, MPIUtil::ReduceSum);
+	std::vector<long> stateOffsets(eInfo.nStates);
+	long offset = oss.str().length();
+	for(int ik=0; ik<nkPoints; ik++)
+	{	offset += kpointHeaders[ik].length();
 		for(int s=0; s<nSpins; s++)
-		{
-			int spinIndex = 1-2*s;
-			int q = ik + nkPoints*s; //net quantum number
-			
-			//Get relevant wavefunctions and eigenvalues (from another process if necessary)
-			ColumnBundle CqTemp; diagMatrix Hsub_eigsqTemp;
-			const ColumnBundle* Cq=0; const diagMatrix* Hsub_eigsq=0;
-			if(mpiWorld->isHead())
-			{	if(eInfo.isMine(q))
-				{	Cq = &eVars.C[q];
-					Hsub_eigsq = &eVars.Hsub_eigs[q];
-				}
-				else
-				{	Cq = &CqTemp;
-					CqTemp.init(eInfo.nBands, e->basis[q].nbasis, &e->basis[q], &eInfo.qnums[q]);
-					mpiWorld->recvData(CqTemp, eInfo.whose(q), q);
-					Hsub_eigsq = &Hsub_eigsqTemp;
-					Hsub_eigsqTemp.resize(eInfo.nBands);
-					mpiWorld->recvData(Hsub_eigsqTemp, eInfo.whose(q), q);
-					if(Udeg.size())
-					{	Udeg[q].init(eInfo.nBands, eInfo.nBands);
-						mpiWorld->recvData(Udeg[q], eInfo.whose(q), q);
-					}
-				}
-			}
-			else
-			{	if(eInfo.isMine(q))
-				{	mpiWorld->sendData(eVars.C[q], 0, q);
-					mpiWorld->sendData(eVars.Hsub_eigs[q], 0, q);
-					if(Udeg.size()) mpiWorld->sendData(Udeg[q], 0, q);
-				}
-				continue; //only head performs computation below
-			}
-			
-			//Apply degeneracy rotations (if any):
-			if(Udeg.size())
-			{	CqTemp = (*Cq) * Udeg[q];
-				Cq = &CqTemp;
-			}
-			
-			//Loop over bands
-			for (int b=0; b < eInfo.nBands; b++)
-			{
-				logPrintf("\tProcessing state %3d band %3d:\n", q, b); logFlush();
-				int bandIndex = b+1 + s*eInfo.nBands;
-				ofs <<
-					" Band, spin, eigenvalue (au), localized\n"
-					"  " << bandIndex << " " << spinIndex << " " << Hsub_eigsq->at(b) << " F\n"
-					" " << (nkPoints==1 ? "Real" : "Complex") << " blip coefficients for extended orbitals\n";
-				//Get orbital in real space
-				complexScalarField phi = I(Cq->getColumn(b,0));
-				//Compute kinetic and potential energy (in Vdiel) of original PW orbitals:
-				double Tpw = -0.5*dot(phi, Jdag(L(J(phi)))).real();
-				double Vpw = gInfo.dV*dot(phi, Vdiel*phi).real();
-				//Adjust phase, convert to blip and output in appropriate format:
-				if(nkPoints==1)
-				{	//Convert orbital to real:
-					double phaseMean, phaseSigma, imagErrorRMS;
-					removePhase(gInfo.nr, phi->data(), phaseMean, phaseSigma, imagErrorRMS);
-					logPrintf("\t\tPhase = %lf +/- %lf\n", phaseMean, phaseSigma); logFlush();
-					logPrintf("\t\tImagErrorRMS = %le\n", imagErrorRMS); logFlush();
-					//Convert PW to blip and output:
-					phi = blipConvert(phi);
-					complex* phiData = phi->data();
-					for(int i=0; i<gInfo.nr; i++)
-						ofs << "  " << phiData[i].real() << "\n";
-				}
-				else
-				{	//Convert PW to blip:
-					phi = blipConvert(phi); complex* phiData = phi->data();
-					//Output:
-					for(int i=0; i<gInfo.nr; i++)
-						ofs << "  (" << phiData[i].real() << "," << phiData[i].imag() << ")\n";
+		{	int q = ik + nkPoints*s; //net quantum number
+			stateOffsets[q] = offset;
+			offset += stateBytes[q];
+		}
+	}
+	
+	//Write headers from head:
+	MPIUtil::File fp;
+	mpiWorld->fopenWrite(fp, fname.c_str());
+	if(mpiWorld->isHead())
+	{	string header = oss.str();
+		mpiWorld->fwrite(header.data(), 1, header.length(), fp);
+		for(int ik=0; ik<nkPoints; ik++)
+		{	mpiWorld->fseek(fp, stateOffsets[ik] - kpointHeaders[ik].length(), SEEK_SET);
+			mpiWorld->fwrite(kpointHeaders[ik].data(), 1, kpointHeaders[ik].length(), fp);
+		}
+	}
+	
+	//Convert and write band blocks of local states:
+	const int nDiag = 11; //diagnostics per band, reported from head after conversion
+	std::vector<double> diag(eInfo.nStates * eInfo.nBands * nDiag, 0.);
+	std::vector<char> buf(size_t(gInfo.nr) * qmcBlipLineWidth(isReal));
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	int s = q / nkPoints;
+		int spinIndex = 1-2*s;
+		//Apply degeneracy rotations (if any):
+		ColumnBundle CqRot;
+		const ColumnBundle* Cq = &eVars.C[q];
+		if(Udeg.size())
+		{	CqRot = eVars.C[q] * Udeg[q];
+			Cq = &CqRot;
+		}
+		mpiWorld->fseek(fp, stateOffsets[q], SEEK_SET);
+		for(int b=0; b<eInfo.nBands; b++)
+		{	double* diagCur = diag.data() + (q*eInfo.nBands + b)*nDiag;
+			string bandHeader = qmcBandHeader(b+1 + s*eInfo.nBands, spinIndex, eVars.Hsub_eigs[q][b], isReal);
+			mpiWorld->fwrite(bandHeader.data(), 1, bandHeader.length(), fp);
+			//Get orbital in real space
+			complexScalarField phi = I(Cq->getColumn(b,0));
+			//Compute kinetic and potential energy (in Vdiel) of original PW orbitals:
+			diagCur[0] = -0.5*dot(phi, Jdag(L(J(phi)))).real(); //Tpw
+			diagCur[1] = gInfo.dV*dot(phi, Vdiel*phi).real(); //Vpw
+			//Adjust phase (if real) and convert to blip:
+			if(isReal)
+				removePhase(gInfo.nr, phi->data(), diagCur[2], diagCur[3], diagCur[4]); //phaseMean, phaseSigma, imagErrorRMS
+			phi = blipConvert(phi);
+			//Format and output:
+			threadLaunch(qmcFormatBlip_sub, gInfo.nr, (const complex*)phi->data(), isReal, buf.data());
+			mpiWorld->fwrite(buf.data(), 1, buf.size(), fp);
+			//Blip kinetic and potential energies:
+			int i0max, i1max, i2max;
+			diagCur[5] = ::Tblip(phi, &diagCur[6], &i0max, &i1max, &i2max); //Tblip, tMax
+			diagCur[7] = i0max; diagCur[8] = i1max; diagCur[9] = i2max;
+			if(A_diel) diagCur[10] = ::Vblip(phi, VdielBlip); //Vdiel potential contribution only when Adiel is non-zero
+		}
+	}
+	mpiWorld->fclose(fp);
+	
+	//Report diagnostics:
+	mpiWorld->allReduceData(diag, MPIUtil::ReduceSum);
+	for(int ik=0; ik<nkPoints; ik++)
+		for(int s=0; s<nSpins; s++)
+		{	int q = ik + nkPoints*s; //net quantum number
+			for(int b=0; b<eInfo.nBands; b++)
+			{	const double* diagCur = diag.data() + (q*eInfo.nBands + b)*nDiag;
+				double Tpw = diagCur[0], Vpw = diagCur[1], Tblip = diagCur[5], Vblip = diagCur[10];
+				logPrintf("\tProcessed state %3d band %3d:\n", q, b);
+				if(isReal)
+				{	logPrintf("\t\tPhase = %lf +/- %lf\n", diagCur[2], diagCur[3]);
+					logPrintf("\t\tImagErrorRMS = %le\n", diagCur[4]);
 				}
-				//Compare PW and Blip kinetic and potential energies
-				double tMax; int i0max, i1max, i2max;
-				double Tblip = ::Tblip(phi, &tMax, &i0max, &i1max, &i2max);
 				logPrintf("\t\tKinetic Energy    (PW)    = %.12le\n", Tpw);
 				logPrintf("\t\tKinetic Energy    (Blip)  = %.12le (Ratio = %.6lf)\n", Tblip, Tblip/Tpw);
-				logPrintf("\t\tMax local KE      (Blip)  = %.12le at cell#(%d,%d,%d)\n", tMax, i0max, i1max, i2max);
-				logFlush();
+				logPrintf("\t\tMax local KE      (Blip)  = %.12le at cell#(%d,%d,%d)\n", diagCur[6], int(diagCur[7]), int(diagCur[8]), int(diagCur[9]));
 				if(A_diel)
-				{	//Vdiel potential contribution only when Adiel is non-zero
-					double Vblip = ::Vblip(phi, VdielBlip);
-					logPrintf("\t\tInt Vdiel.|phi^2| (PW)    = %.12le\n", Vpw);
+				{	logPrintf("\t\tInt Vdiel.|phi^2| (PW)    = %.12le\n", Vpw);
 					logPrintf("\t\tInt Vdiel.|phi^2| (Blip)  = %.12le (Ratio = %.6lf)\n", Vblip, Vblip/Vpw);
-					logFlush();
 				}
 			}
 		}
-	}
 	logPrintf("\tDone.\n"); logFlush();
-	ofs.close();
 }
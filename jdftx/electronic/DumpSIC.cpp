@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/ColumnBundle.h>
 #include <core/Operators.h>
 #include <core/Util.h>
+#include <core/Thread.h>
 
 DumpSelfInteractionCorrection::DumpSelfInteractionCorrection(const Everything& everything)
 {
@@ -30,22 +31,24 @@ DumpSelfInteractionCorrection::DumpSelfInteractionCorrection(const Everything& e
 
 double DumpSelfInteractionCorrection::operator()(std::vector<diagMatrix>* correctedEigenvalues)
 {
-	// Loop over all quantum numbers (spin+kpoint) and bands; and corrects their eigenvalues
+	// Loop over local quantum numbers (spin+kpoint) and bands; and corrects their eigenvalues
+	// (each process handles its own states, with XC and Coulomb evaluated locally and bands distributed over threads)
+	const ElecInfo& eInfo = e->eInfo;
 	double selfInteractionEnergy = 0;
-	DC.resize(3);
-	for(int q=0; q<e->eInfo.nStates; q++) //need to loop over all states since XC is MPI parallelized
-	{	if(e->exCorr.needsKEdensity() && e->eInfo.isMine(q))
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	if(e->exCorr.needsKEdensity())
+		{	DC.resize(3);
 			for(int iDir=0; iDir<3; iDir++)
 				DC[iDir] = D(e->eVars.C[q], iDir);
-		if(e->eInfo.isMine(q) && correctedEigenvalues)
-			(*correctedEigenvalues)[q].resize(e->eInfo.nBands);
-		for(int n=0; n<e->eInfo.nBands; n++)
-		{	double selfInteractionError = calcSelfInteractionError(q,n);
-			if(e->eInfo.isMine(q))
-			{	if(correctedEigenvalues)
-					(*correctedEigenvalues)[q][n] = e->eVars.Hsub_eigs[q][n] - selfInteractionError;
-				selfInteractionEnergy += e->eVars.F[q][n]*e->eInfo.qnums[q].weight*selfInteractionError;
-			}
+		}
+		std::vector<double> selfInteractionErrors(eInfo.nBands);
+		threadLaunch(isGpuEnabled() ? 1 : 0, calcSelfInteractionError_thread, eInfo.nBands, this, q, selfInteractionErrors.data());
+		if(correctedEigenvalues)
+			(*correctedEigenvalues)[q].resize(eInfo.nBands);
+		for(int n=0; n<eInfo.nBands; n++)
+		{	if(correctedEigenvalues)
+				(*correctedEigenvalues)[q][n] = e->eVars.Hsub_eigs[q][n] - selfInteractionErrors[n];
+			selfInteractionEnergy += e->eVars.F[q][n]*eInfo.qnums[q].weight*selfInteractionErrors[n];
 		}
 	}
 	DC.clear();
@@ -54,13 +57,15 @@ double DumpSelfInteractionCorrection::operator()(std::vector<diagMatrix>* correc
 	
 }
 
-double DumpSelfInteractionCorrection::calcSelfInteractionError(int q, int n)
+void DumpSelfInteractionCorrection::calcSelfInteractionError_thread(int nStart, int nStop, const DumpSelfInteractionCorrection* dsic, int q, double* selfInteractionErrors)
+{	for(int n=nStart; n<nStop; n++)
+		selfInteractionErrors[n] = dsic->calcSelfInteractionError(q,n);
+}
+
+double DumpSelfInteractionCorrection::calcSelfInteractionError(int q, int n) const
 {
 	// Get the real-space orbital density
-	ScalarField orbitalDensity; nullToZero(orbitalDensity, e->gInfo);
-	if(e->eInfo.isMine(q))
-		orbitalDensity = diagouterI(eye(1), e->eVars.C[q].getSub(n,n+1), 1, &e->gInfo)[0];
-	orbitalDensity->bcastData(mpiWorld, e->eInfo.whose(q));
+	ScalarField orbitalDensity = diagouterI(eye(1), e->eVars.C[q].getSub(n,n+1), 1, &e->gInfo)[0];
 	ScalarFieldTilde orbitalDensityTilde = J(orbitalDensity);
 	
 	// Calculate the Coulomb energy
@@ -76,13 +81,11 @@ double DumpSelfInteractionCorrection::calcSelfInteractionError(int q, int n)
 	ScalarFieldArray KEdensity(2);
 	if(e->exCorr.needsKEdensity())
 	{	nullToZero(KEdensity, e->gInfo);
-		if(e->eInfo.isMine(q))
-			for(int iDir=0; iDir<3; iDir++)
-				KEdensity[0] += 0.5 * diagouterI(eye(1), DC[iDir].getSub(n,n+1), 1, &e->gInfo)[0];
-		KEdensity[0]->bcastData(mpiWorld, e->eInfo.whose(q));
+		for(int iDir=0; iDir<3; iDir++)
+			KEdensity[0] += 0.5 * diagouterI(eye(1), DC[iDir].getSub(n,n+1), 1, &e->gInfo)[0];
 	}
 
-	double xcEnergy = e->exCorr(orbitalSpinDensity, 0, IncludeTXC(), &KEdensity, 0);
+	double xcEnergy = e->exCorr(orbitalSpinDensity, 0, IncludeTXC(), &KEdensity, 0, 0, true); //local to this process
 	
 	return coulombEnergy + xcEnergy;
 }
@@ -44,7 +44,8 @@ public:
 	bool needsTau;  //!< The kinetic energy density is needed for meta-gga functionals.
 private:
 	const Everything* e;
-	double calcSelfInteractionError(int q, int n); //!< Calculates the self-interaction error of the KS orbital atthe n'th band at q'th quantum number
+	double calcSelfInteractionError(int q, int n) const; //!< Calculates the self-interaction error of the KS orbital atthe n'th band at q'th quantum number (locally on the current process)
+	static void calcSelfInteractionError_thread(int nStart, int nStop, const DumpSelfInteractionCorrection* dsic, int q, double* selfInteractionErrors); //!< Self-interaction errors for a range of bands (threaded)
 	std::vector<ColumnBundle> DC; //!< ColumnBundle for the derivative of the wavefunctions in each cartesian direction
 };
 
@@ -105,6 +106,8 @@ struct ChargedDefect
 	double rMin; //!< Minimum distance from defect used for calculating alignment
 	double rSigma; //!< Turn-on width of region used for calculating alignment
 	
+	string libraryPrefix; //!< if non-empty, filename prefix for storing / reusing unit-charge model potentials (Slab mode only)
+	
 	void dump(const Everything& e, ScalarField d_tot) const;
 };
 
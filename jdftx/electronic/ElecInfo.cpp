@@ -21,6 +21,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Everything.h>
 #include <electronic/SpeciesInfo.h>
 #include <core/matrix.h>
+#include <core/Checkpoint.h>
+#include <core/AsyncWriter.h>
 #include <fluid/Euler.h>
 #include <algorithm>
 #include <limits>
@@ -113,7 +115,13 @@ void ElecInfo::setup(const Everything &everything, std::vector<diagMatrix>& F, E
 	}
 	else
 	{	logPrintf("Reading initial fillings from file %s.\n", initialFillingsFilename.c_str());
-		if(nBandsOld <= 0) nBandsOld=nBands;
+		if(nBandsOld <= 0)
+		{	if(CheckpointFile::isCheckpoint(initialFillingsFilename.c_str()))
+			{	CheckpointFile cp; cp.open(initialFillingsFilename.c_str());
+				nBandsOld = cp.header.nBands; //band count recorded in checkpoint
+			}
+			else nBandsOld=nBands;
+		}
 		read(F, initialFillingsFilename.c_str(), nBandsOld);
 		
 		for(int q=qStart; q<qStop; q++)
@@ -508,6 +516,17 @@ void ElecInfo::kpointPrint(FILE* fp, int q, bool printSpin) const
 void ElecInfo::read(std::vector<diagMatrix>& M, const char *fname, int nRowsOverride) const
 {	int nRows = nRowsOverride ? nRowsOverride : nBands;
 	M.resize(nStates);
+	if(CheckpointFile::isCheckpoint(fname))
+	{	CheckpointFile cp; cp.open(fname);
+		checkCheckpoint(cp, CheckpointDiagMatrices, fname);
+		if(cp.header.nBands != nRows)
+			die("Checkpoint '%s' contains %d bands instead of the expected %d.\n", fname, int(cp.header.nBands), nRows);
+		for(int q=qStart; q<qStop; q++)
+		{	M[q].resize(nRows);
+			cp.read(q, M[q].data());
+		}
+		return;
+	}
 	MPIUtil::File fp; mpiWorld->fopenRead(fp, fname, nStates*nRows*sizeof(double));
 	mpiWorld->fseek(fp, qStart*nRows*sizeof(double), SEEK_SET);
 	for(int q=qStart; q<qStop; q++)
@@ -530,9 +549,20 @@ void ElecInfo::read(std::vector<matrix>& M, const char *fname, int nRowsOverride
 	mpiWorld->fclose(fp);
 }
 
-void ElecInfo::write(const std::vector<diagMatrix>& M, const char *fname, int nRowsOverride) const
+void ElecInfo::write(const std::vector<diagMatrix>& M, const char *fname, int nRowsOverride, AsyncWriter* writer) const
 {	int nRows = nRowsOverride ? nRowsOverride : nBands;
 	assert(int(M.size())==nStates);
+	if(writer)
+	{	//Queue a snapshot of local data for background write:
+		std::vector<char> buf((qStop-qStart)*nRows*sizeof(double));
+		for(int q=qStart; q<qStop; q++)
+		{	assert(M[q].nRows()==nRows);
+			memcpy(buf.data()+(q-qStart)*nRows*sizeof(double), M[q].data(), nRows*sizeof(double));
+		}
+		convertToLE(buf.data(), sizeof(double), (qStop-qStart)*nRows);
+		writer->write(fname, qStart*nRows*sizeof(double), buf, mpiWorld->isHead() ? long(nStates*nRows*sizeof(double)) : -1);
+		return;
+	}
 #if MPI_SAFE_WRITE
 	//Safe mode / write from head:
 	if(mpiWorld->isHead())
@@ -563,6 +593,19 @@ void ElecInfo::write(const std::vector<diagMatrix>& M, const char *fname, int nR
 #endif
 }
 
+void ElecInfo::writeCheckpoint(const std::vector<diagMatrix>& M, const char *fname, const CheckpointOptions& options, AsyncWriter* writer) const
+{	assert(int(M.size())==nStates);
+	CheckpointFile cp;
+	initCheckpoint(cp, CheckpointDiagMatrices);
+	for(int q=qStart; q<qStop; q++)
+	{	assert(M[q].nRows()==nBands);
+		cp.chunks[q].nRows = nBands;
+		cp.chunks[q].nCols = 1;
+		cp.encode(q, M[q].data(), options);
+	}
+	cp.write(fname, &qDivision, writer);
+}
+
 void ElecInfo::write(const std::vector<matrix>& M, const char *fname, int nRowsOverride, int nColsOverride) const
 {	int nRows = nRowsOverride ? nRowsOverride : nBands;
 	int nCols = nColsOverride ? nColsOverride : nBands;
@@ -595,3 +638,54 @@ void ElecInfo::write(const std::vector<matrix>& M, const char *fname, int nRowsO
 	mpiWorld->fclose(fp);
 #endif
 }
+
+
+//-------------- Checkpoint container metadata ------------------
+
+vector3<> ElecInfo::basisK(int q) const
+{	return (e->cntrl.basisKdep==BasisKpointIndep) ? vector3<>() : qnums[q].k;
+}
+
+void ElecInfo::initCheckpoint(CheckpointFile& cp, int kind) const
+{	const GridInfo& gInfo = e->gInfo;
+	cp.header.kind = kind;
+	for(int i=0; i<3; i++)
+	{	for(int j=0; j<3; j++) cp.header.R[3*i+j] = gInfo.R(i,j);
+		cp.header.S[i] = gInfo.S[i];
+	}
+	cp.header.Ecut = e->cntrl.Ecut;
+	cp.header.nBands = nBands;
+	cp.header.nSpinor = spinorLength();
+	cp.header.basisKdep = (e->cntrl.basisKdep==BasisKpointDep);
+	cp.chunks.resize(nStates);
+	for(int q=0; q<nStates; q++)
+	{	CheckpointChunk& chunk = cp.chunks[q];
+		vector3<> kBasis = basisK(q);
+		for(int k=0; k<3; k++)
+		{	chunk.k[k] = qnums[q].k[k];
+			chunk.basisK[k] = kBasis[k];
+		}
+		chunk.spin = qnums[q].spin;
+		chunk.weight = qnums[q].weight;
+	}
+}
+
+void ElecInfo::checkCheckpoint(const CheckpointFile& cp, int kind, const char* fname) const
+{	if(cp.header.kind != kind)
+		die("Checkpoint '%s' does not contain the expected kind of data.\n", fname);
+	if(cp.header.nChunks != nStates)
+		die("Checkpoint '%s' contains %d states instead of the expected %d.\n%s", fname, int(cp.header.nChunks), nStates,
+			(e->vibrations and qnums.size()>1)
+			? "Hint: Vibrations requires wavefunctions without symmetries:\n"
+				"either don't read in state, or consider using phonon instead.\n"
+			: "Hint: Was the checkpoint written with the same k-point mesh and symmetries?\n");
+	const double kTol = 1e-6;
+	for(int q=0; q<nStates; q++)
+	{	const CheckpointChunk& chunk = cp.chunks[q];
+		vector3<> k(chunk.k[0], chunk.k[1], chunk.k[2]);
+		if((k - qnums[q].k).length_squared() > kTol*kTol || chunk.spin != qnums[q].spin)
+			die("Checkpoint '%s' state %d has k-point [ %+.7f %+.7f %+.7f ] and spin %d instead of the expected\n"
+				"[ %+.7f %+.7f %+.7f ] and spin %d.\n", fname, q, k[0], k[1], k[2], int(chunk.spin),
+				qnums[q].k[0], qnums[q].k[1], qnums[q].k[2], qnums[q].spin);
+	}
+}
@@ -136,8 +136,9 @@ public:
 	//Parallel I/O utilities for diagMatrix/matrix array (one-per-kpoint, with nBands rows and columns unless overridden):
 	void read(std::vector<diagMatrix>&, const char *fname, int nRowsOverride=0) const; //!< parallel read array of diagonal matrices
 	void read(std::vector<matrix>&, const char *fname, int nRowsOverride=0, int nColsOverride=0) const; //!< parallel read array of matrices
-	void write(const std::vector<diagMatrix>&, const char *fname, int nRowsOverride=0) const; //!< parallel write array of diagonal matrices
+	void write(const std::vector<diagMatrix>&, const char *fname, int nRowsOverride=0, class AsyncWriter* writer=0) const; //!< parallel write array of diagonal matrices (queued for background write if writer specified)
 	void write(const std::vector<matrix>&, const char *fname, int nRowsOverride=0, int nColsOverride=0) const;  //!< parallel write array of matrices
+	void writeCheckpoint(const std::vector<diagMatrix>&, const char *fname, const struct CheckpointOptions&, class AsyncWriter* writer=0) const; //!< parallel write array of diagonal matrices as a checkpoint container (read() detects these automatically)
 
 	//Parallel I/O utilities for ColumnBundle array (defined in COlumnBUndle.cpp):
 	struct ColumnBundleReadConversion //!< Utility to convert columnbundle basis / bands
@@ -147,12 +148,16 @@ public:
 		vector3<int> S_old; //!< fftbox size for the input wavefunction in double space
 		ColumnBundleReadConversion();
 	};
-	void read(std::vector<class ColumnBundle>&, const char *fname, const ColumnBundleReadConversion* conversion=0) const; //!< Read array of columnbundles, optionally with conversion
-	void write(const std::vector<class ColumnBundle>&, const char *fname) const; //!< write an array of columnbundles to file
+	int read(std::vector<class ColumnBundle>&, const char *fname, const ColumnBundleReadConversion* conversion=0) const; //!< Read array of columnbundles, optionally with conversion (returns number of bands initialized)
+	void write(const std::vector<class ColumnBundle>&, const char *fname, class AsyncWriter* writer=0) const; //!< write an array of columnbundles to file (queued for background write if writer specified)
+	void writeCheckpoint(const std::vector<class ColumnBundle>&, const char *fname, const struct CheckpointOptions&, class AsyncWriter* writer=0) const; //!< write an array of columnbundles as a checkpoint container (read() detects these automatically)
 
 private:
 	const Everything* e;
 	TaskDivision qDivision; //!< MPI division of k-points
+	void initCheckpoint(class CheckpointFile& cp, int kind) const; //!< initialize checkpoint header and k-point metadata for writing
+	void checkCheckpoint(const class CheckpointFile& cp, int kind, const char* fname) const; //!< check checkpoint contents and k-points against current calculation
+	vector3<> basisK(int q) const; //!< k-point at which the basis of state q is set up
 	
 	//Initial fillings:
 	int nBandsOld; //!<number of bands in file being read
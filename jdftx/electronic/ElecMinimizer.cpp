@@ -20,6 +20,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/ElecMinimizer.h>
 #include <electronic/BandMinimizer.h>
 #include <electronic/BandDavidson.h>
+#include <electronic/BandChFSI.h>
 #include <electronic/ColumnBundle.h>
 #include <electronic/Everything.h>
 #include <electronic/ExactExchange.h>
@@ -271,7 +272,18 @@ double ElecMinimizer::sync(double x) const
 	return x;
 }
 
-void bandMinimize(Everything& e, bool updateVxx)
+//Minimize bands of one state (task-parallel loop body for bandMinimize)
+void bandMinimize_sub(size_t iTask, Everything* e, std::vector<int>* nLockedQ)
+{	int q = e->eInfo.qStart + iTask;
+	logPrintf("\n---- Minimization of quantum number: "); e->eInfo.kpointPrint(globalLog, q, true); logPrintf(" ----\n");
+	switch(e->cntrl.elecEigenAlgo)
+	{	case ElecEigenCG: { BandMinimizer(*e, q).minimize(e->elecMinParams); break; }
+		case ElecEigenDavidson: { (*nLockedQ)[iTask] = BandDavidson(*e, q).minimize(); break; }
+		case ElecEigenChFSI: { BandChFSI(*e, q).minimize(); break; }
+	}
+}
+
+int bandMinimize(Everything& e, bool updateVxx)
 {	bool fixed_H = true; std::swap(fixed_H, e.cntrl.fixed_H); //remember fixed_H flag and temporarily set it to true
 	bool loopOuter = updateVxx and e.exCorr.exxFactor(); //whether an outer loop to converge VXX is required
 	int nOuter = loopOuter ? e.cntrl.nOuterVxx : 1;
@@ -280,18 +292,32 @@ void bandMinimize(Everything& e, bool updateVxx)
 		die("Convergence parameter energyDiffThreshold must be > 0 in exact exchange calculations.\n");
 	logPrintf("Minimization will be done independently for each quantum number.\n");
 	double EbandPrev = 0.;
+	int nLocked = 0;
 	for(int iOuter=0; iOuter<nOuter; iOuter++)
 	{	if(loopOuter) e.exx->prepareHamiltonian(e.exCorr.exxRange(), e.eVars.F, e.eVars.C);
+		int nStatesMine = e.eInfo.qStop - e.eInfo.qStart;
+		std::vector<int> nLockedQ(nStatesMine, 0);
+		int nGroups = e.eVars.kpointThreadGroups();
+		if(nGroups==1 or nStatesMine<=1)
+			for(int iTask=0; iTask<nStatesMine; iTask++)
+				bandMinimize_sub(iTask, &e, &nLockedQ);
+		else
+		{	//Suppress per-state output from concurrent minimizations (would interleave):
+			logPrintf("\nMinimizing %d quantum numbers concurrently (per-state output suppressed).\n", nStatesMine); logFlush();
+			FILE* globalLogPrev = globalLog; globalLog = nullLog;
+			FILE* fpLogPrev = e.elecMinParams.fpLog; e.elecMinParams.fpLog = nullLog;
+			threadedTaskLoop(nGroups, bandMinimize_sub, nStatesMine, &e, &nLockedQ);
+			globalLog = globalLogPrev;
+			e.elecMinParams.fpLog = fpLogPrev;
+		}
 		e.ener.Eband = 0.;
+		nLocked = 0;
 		for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
-		{	logPrintf("\n---- Minimization of quantum number: "); e.eInfo.kpointPrint(globalLog, q, true); logPrintf(" ----\n");
-			switch(e.cntrl.elecEigenAlgo)
-			{	case ElecEigenCG: { BandMinimizer(e, q).minimize(e.elecMinParams); break; }
-				case ElecEigenDavidson: { BandDavidson(e, q).minimize(); break; }
-			}
-			e.ener.Eband += e.eInfo.qnums[q].weight * trace(e.eVars.Hsub_eigs[q]);
+		{	e.ener.Eband += e.eInfo.qnums[q].weight * trace(e.eVars.Hsub_eigs[q]);
+			nLocked += nLockedQ[q-e.eInfo.qStart];
 		}
 		mpiWorld->allReduce(e.ener.Eband, MPIUtil::ReduceSum);
+		mpiWorld->allReduce(nLocked, MPIUtil::ReduceSum);
 		//Check convergence of outer loop:
 		if(loopOuter)
 		{	logPrintf("\nVxxLoop: Iter: %2i   EbandTot: %+.15lf", iOuter, e.ener.Eband);
@@ -311,6 +337,7 @@ void bandMinimize(Everything& e, bool updateVxx)
 	}
 	std::swap(fixed_H, e.cntrl.fixed_H); //restore fixed_H flag
 	e.eVars.setEigenvectors();
+	return nLocked;
 }
 
 
@@ -197,8 +197,7 @@ void ElecVars::setup(const Everything &everything)
 		if(wfnsFilename.length())
 		{	logPrintf("reading from '%s'\n", wfnsFilename.c_str()); logFlush();
 			if(readConversion) readConversion->Ecut = e->cntrl.Ecut;
-			eInfo.read(C, wfnsFilename.c_str(), readConversion.get());
-			nBandsInited = (readConversion && readConversion->nBandsOld) ? readConversion->nBandsOld : eInfo.nBands;
+			nBandsInited = eInfo.read(C, wfnsFilename.c_str(), readConversion.get());
 			isRandom = false;
 		}
 		else if(initLCAO)
@@ -408,21 +407,15 @@ double ElecVars::elecEnergyAndGrad(Energies& ener, ElecGradient* grad, ElecGradi
 	}
 	
 	//Do the single-particle contributions one state at a time to save memory (and for better cache warmth):
+	//(or a few states at a time on separate thread groups, if kpointThreadGroups > 1)
+	int nStatesMine = eInfo.qStop - eInfo.qStart;
+	std::vector<Energies> enerQ(nStatesMine); //energy contributions by state (avoids races in task-parallel mode)
+	threadedTaskLoop(kpointThreadGroups(), elecEnergyAndGrad_sub, nStatesMine, this, &HC, &enerQ, grad, Kgrad, need_Hsub);
 	ener.E["KE"] = 0.;
 	ener.E["Enl"] = 0.;
-	for(int q=eInfo.qStart; q<e->eInfo.qStop; q++)
-	{	double KEq = applyHamiltonian(q, F[q], HC[q], ener, need_Hsub);
-		if(grad) //Calculate wavefunction gradients:
-		{	const QuantumNumber& qnum = eInfo.qnums[q];
-			HC[q] -= O(C[q]) * Hsub[q]; //Include orthonormality contribution
-			grad->C[q] = HC[q] * (F[q]*qnum.weight);
-			if(Kgrad)
-			{	double Nq = qnum.weight*trace(F[q]);
-				double KErollover = 2. * (Nq>1e-3 ? KEq/Nq : 1.);
-				precond_inv_kinetic(HC[q], KErollover); //apply preconditioner
-				std::swap(Kgrad->C[q], HC[q]); //this frees HC[q]
-			}
-		}
+	for(Energies& enerq: enerQ)
+	{	ener.E["KE"] += enerq.E["KE"];
+		ener.E["Enl"] += enerq.E["Enl"];
 	}
 	mpiWorld->allReduce(ener.E["KE"], MPIUtil::ReduceSum);
 	mpiWorld->allReduce(ener.E["Enl"], MPIUtil::ReduceSum);
@@ -474,6 +467,27 @@ double ElecVars::elecEnergyAndGrad(Energies& ener, ElecGradient* grad, ElecGradi
 	return relevantFreeEnergy(*e);
 }
 
+void ElecVars::elecEnergyAndGrad_sub(size_t iTask, ElecVars* eVars, std::vector<ColumnBundle>* HC, std::vector<Energies>* enerQ,
+	ElecGradient* grad, ElecGradient* Kgrad, bool need_Hsub)
+{	const ElecInfo& eInfo = eVars->e->eInfo;
+	int q = eInfo.qStart + iTask;
+	ColumnBundle& HCq = (*HC)[q];
+	const ColumnBundle& Cq = eVars->C[q];
+	const diagMatrix& Fq = eVars->F[q];
+	double KEq = eVars->applyHamiltonian(q, Fq, HCq, (*enerQ)[iTask], need_Hsub);
+	if(grad) //Calculate wavefunction gradients:
+	{	const QuantumNumber& qnum = eInfo.qnums[q];
+		HCq -= O(Cq) * eVars->Hsub[q]; //Include orthonormality contribution
+		grad->C[q] = HCq * (Fq*qnum.weight);
+		if(Kgrad)
+		{	double Nq = qnum.weight*trace(Fq);
+			double KErollover = 2. * (Nq>1e-3 ? KEq/Nq : 1.);
+			precond_inv_kinetic(HCq, KErollover); //apply preconditioner
+			std::swap(Kgrad->C[q], HCq); //this frees HC[q]
+		}
+	}
+}
+
 //Latice derivative
 matrix3<> ElecVars::latticeGrad() const
 {
@@ -597,12 +611,27 @@ void ElecVars::setEigenvectors()
 	}
 }
 
+int ElecVars::kpointThreadGroups() const
+{	if(isGpuEnabled() or e->exCorr.exxFactor()) return 1; //task-parallel mode not supported
+	return e->cntrl.kpointThreadGroups;
+}
+
+void ElecVars::KEdensity_sub(size_t iTask, const ElecVars* eVars, ScalarFieldArray* tau, std::mutex* tauLock)
+{	int q = eVars->e->eInfo.qStart + iTask;
+	const ColumnBundle& Cq = eVars->C[q];
+	ScalarFieldArray tauq(tau->size());
+	for(int iDir=0; iDir<3; iDir++)
+		tauq += (0.5*Cq.qnum->weight) * diagouterI(eVars->F[q], D(Cq,iDir), tau->size(), &eVars->e->gInfo);
+	tauLock->lock();
+	*tau += tauq;
+	tauLock->unlock();
+}
+
 ScalarFieldArray ElecVars::KEdensity() const
 {	ScalarFieldArray tau(n.size());
 	//Compute KE density from valence electrons:
-	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
-		for(int iDir=0; iDir<3; iDir++)
-			tau += (0.5*C[q].qnum->weight) * diagouterI(F[q], D(C[q],iDir), tau.size(), &e->gInfo);
+	std::mutex tauLock;
+	threadedTaskLoop(kpointThreadGroups(), KEdensity_sub, e->eInfo.qStop-e->eInfo.qStart, this, &tau, &tauLock);
 	for(ScalarField& tau_s: tau)
 	{	nullToZero(tau_s, e->gInfo);
 		tau_s->allReduceData(mpiWorld, MPIUtil::ReduceSum);
@@ -617,14 +646,24 @@ ScalarFieldArray ElecVars::KEdensity() const
 	return tau;
 }
 
+void ElecVars::calcDensity_sub(size_t iTask, const ElecVars* eVars, ScalarFieldArray* density, std::mutex* densityLock)
+{	const Everything& e = *(eVars->e);
+	int q = e.eInfo.qStart + iTask;
+	ScalarFieldArray nq = e.eInfo.qnums[q].weight * diagouterI(eVars->F[q], eVars->C[q], density->size(), &e.gInfo);
+	densityLock->lock();
+	*density += nq;
+	densityLock->unlock();
+}
+
 ScalarFieldArray ElecVars::calcDensity() const
 {	ScalarFieldArray density(n.size());
 	//Runs over all states and accumulates density to the corresponding spin channel of the total density
+	std::mutex densityLock;
+	threadedTaskLoop(kpointThreadGroups(), calcDensity_sub, e->eInfo.qStop-e->eInfo.qStart, this, &density, &densityLock);
+	//Pseudopotential contributions:
 	e->iInfo.augmentDensityInit();
 	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
-	{	density += e->eInfo.qnums[q].weight * diagouterI(F[q], C[q], density.size(), &e->gInfo);
-		e->iInfo.augmentDensitySpherical(e->eInfo.qnums[q], F[q], VdagC[q]); //pseudopotential contribution
-	}
+		e->iInfo.augmentDensitySpherical(e->eInfo.qnums[q], F[q], VdagC[q]);
 	e->iInfo.augmentDensityGrid(density);
 	for(ScalarField& ns: density)
 	{	nullToZero(ns, e->gInfo);
@@ -643,14 +682,15 @@ void ElecVars::orthonormalize(int q, matrix* extraRotation)
 	e->iInfo.project(C[q], VdagC[q], &rot); //update the atomic projections
 }
 
-double ElecVars::applyHamiltonian(int q, const diagMatrix& Fq, ColumnBundle& HCq, Energies& ener, bool need_Hsub)
+double ElecVars::applyHamiltonian(int q, const diagMatrix& Fq, ColumnBundle& HCq, Energies& ener, bool need_Hsub, bool singlePrecision)
 {	assert(C[q]); //make sure wavefunction is available for this state
 	const QuantumNumber& qnum = e->eInfo.qnums[q];
 	std::vector<matrix> HVdagCq(e->iInfo.species.size());
+	bool need_HC = need_Hsub || bool(HCq); //HC is also needed when the caller provides a buffer to accumulate into
 	
 	//Propagate grad_n (Vscloc) to HCq (which is grad_Cq upto weights and fillings) if required
-	if(need_Hsub)
-	{	HCq += Idag_DiagV_I(C[q], Vscloc); //Accumulate Idag Diag(Vscloc) I C
+	if(need_HC)
+	{	HCq += Idag_DiagV_I(C[q], Vscloc, singlePrecision); //Accumulate Idag Diag(Vscloc) I C
 		e->iInfo.augmentDensitySphericalGrad(qnum, VdagC[q], HVdagCq); //Contribution via pseudopotential density augmentation
 		if(e->exCorr.needsKEdensity() && Vtau[qnum.index()]) //Contribution via orbital KE:
 		{	for(int iDir=0; iDir<3; iDir++)
@@ -25,6 +25,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/ScalarFieldArray.h>
 #include <string>
 #include <memory>
+#include <mutex>
 
 struct ElecGradient;
 
@@ -125,11 +126,22 @@ public:
 	
 	//! Applies the Kohn-Sham Hamiltonian on the orthonormal wavefunctions C, and computes Hsub if necessary, for a single quantum number
 	//! Returns the Kinetic energy contribution from q, which can be used for the inverse kinetic preconditioner
-	double applyHamiltonian(int q, const diagMatrix& Fq, ColumnBundle& HCq, Energies& ener, bool need_Hsub = false);
+	//! HCq is computed (accumulated) if need_Hsub, or if HCq is already allocated on input, in which case Hsub is left untouched
+	//! If singlePrecision is set, the local potential is applied using single-precision FFTs where supported (see Idag_DiagV_I)
+	double applyHamiltonian(int q, const diagMatrix& Fq, ColumnBundle& HCq, Energies& ener, bool need_Hsub = false, bool singlePrecision = false);
+	
+	//! Number of thread groups to use for task-parallel loops over states on this process (see Control::kpointThreadGroups)
+	int kpointThreadGroups() const;
 	
 private:
 	const Everything* e;
 	
+	//Task-parallel loop bodies over states of this process:
+	static void calcDensity_sub(size_t iTask, const ElecVars* eVars, ScalarFieldArray* density, std::mutex* densityLock);
+	static void KEdensity_sub(size_t iTask, const ElecVars* eVars, ScalarFieldArray* tau, std::mutex* tauLock);
+	static void elecEnergyAndGrad_sub(size_t iTask, ElecVars* eVars, std::vector<ColumnBundle>* HC, std::vector<Energies>* enerQ,
+		ElecGradient* grad, ElecGradient* Kgrad, bool need_Hsub);
+	
 	std::vector<string> VexternalFilename; //!< external potential filename (read in real space)
 	friend struct CommandVexternal;
 	
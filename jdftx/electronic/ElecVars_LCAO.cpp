@@ -38,12 +38,19 @@ struct LCAOminimizer : Minimizable<ElecGradient> //Uses only the Haux entries of
 	const ExCorr* exCorr;
 	std::vector<matrix> HniSub;
 	std::vector<matrix> rotPrev; //Accumulated rotations of the wavefunctions
+	int nGroups; //number of thread groups for task-parallel loops over states
 	
 	LCAOminimizer(ElecVars& eVars, const Everything& e)
-	: eVars(eVars), e(e), eInfo(e.eInfo), HniSub(eInfo.nStates), rotPrev(eInfo.nStates)
+	: eVars(eVars), e(e), eInfo(e.eInfo), HniSub(eInfo.nStates), rotPrev(eInfo.nStates), nGroups(eVars.kpointThreadGroups())
 	{
 	}
 	
+	//Task-parallel loop bodies over states of this process (iTask = q - qStart):
+	static void initOrbitals_sub(size_t iTask, LCAOminimizer* lcao, int nExtra); //compute atomic orbitals
+	static void initHni_sub(size_t iTask, LCAOminimizer* lcao); //orthonormalize and compute non-interacting subspace Hamiltonian
+	static void subspaceRotate_sub(size_t iTask, LCAOminimizer* lcao); //switch to eigenvectors of subspace Hamiltonian
+	static void computeGrad_sub(size_t iTask, LCAOminimizer* lcao, double mu, double Bz, diagMatrix* dmuNumQ, diagMatrix* dmuDenQ);
+	
 	void step(const ElecGradient& dir, double alpha)
 	{	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
 		{	assert(dir.Haux[q]);
@@ -82,30 +89,23 @@ struct LCAOminimizer : Minimizable<ElecGradient> //Uses only the Haux entries of
 		//Wavefunction dependent parts:
 		ener.E["NI"] = 0.;
 		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
-		{	const QuantumNumber& qnum = eInfo.qnums[q];
-			
-			//KE and Nonlocal pseudopotential from precomputed subspace matrix:
+		{	//KE and Nonlocal pseudopotential from precomputed subspace matrix:
 			matrix HniRot = dagger(rotPrev[q]) * HniSub[q] * rotPrev[q];
-			ener.E["NI"] += qnum.weight * trace(eVars.F[q] * HniRot).real();
+			ener.E["NI"] += eInfo.qnums[q].weight * trace(eVars.F[q] * HniRot).real();
+		}
+		mpiWorld->allReduce(ener.E["NI"], MPIUtil::ReduceSum);
 		
-			//Gradient and subspace Hamiltonian:
-			if(grad)
-			{	ColumnBundle HCq = Idag_DiagV_I(eVars.C[q], eVars.Vscloc); //Accumulate Idag Diag(Vscloc) I C
-				if(eInfo.hasU) e.iInfo.rhoAtom_grad(eVars.C[q], eVars.U_rhoAtom, HCq); //Contribution via atomic density matrices (DFT+U)
-				std::vector<matrix> HVdagCq(e.iInfo.species.size());
-				e.iInfo.augmentDensitySphericalGrad(qnum, eVars.VdagC[q], HVdagCq); //Contribution via pseudopotential density augmentation
-				e.iInfo.projectGrad(HVdagCq, eVars.C[q], HCq);
-				eVars.Hsub[q] = HniRot + (eVars.C[q]^HCq);
-				eVars.Hsub[q].diagonalize(eVars.Hsub_evecs[q], eVars.Hsub_eigs[q]);
-				//N/M constraint contributions to gradient:
-				diagMatrix fprime = eInfo.smearPrime(eInfo.muEff(mu,Bz,q), eVars.Haux_eigs[q]);
-				double w = eInfo.qnums[q].weight;
-				int sIndex = eInfo.qnums[q].index();
-				dmuNum[sIndex] += w * trace(fprime * (diag(eVars.Hsub[q])-eVars.Haux_eigs[q]));
-				dmuDen[sIndex] += w * trace(fprime);
+		//Gradient and subspace Hamiltonian:
+		if(grad)
+		{	int nStatesMine = eInfo.qStop - eInfo.qStart;
+			diagMatrix dmuNumQ(nStatesMine), dmuDenQ(nStatesMine); //contributions by state (summed in order below)
+			threadedTaskLoop(nGroups, computeGrad_sub, nStatesMine, this, mu, Bz, &dmuNumQ, &dmuDenQ);
+			for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+			{	int sIndex = eInfo.qnums[q].index();
+				dmuNum[sIndex] += dmuNumQ[q-eInfo.qStart];
+				dmuDen[sIndex] += dmuDenQ[q-eInfo.qStart];
 			}
 		}
-		mpiWorld->allReduce(ener.E["NI"], MPIUtil::ReduceSum);
 		
 		//Final gradient propagation to auxiliary Hamiltonian:
 		if(grad) 
@@ -147,6 +147,66 @@ struct LCAOminimizer : Minimizable<ElecGradient> //Uses only the Haux entries of
 };
 
 
+void LCAOminimizer::computeGrad_sub(size_t iTask, LCAOminimizer* lcao, double mu, double Bz, diagMatrix* dmuNumQ, diagMatrix* dmuDenQ)
+{	ElecVars& eVars = lcao->eVars;
+	const ElecInfo& eInfo = lcao->eInfo;
+	const IonInfo& iInfo = lcao->e.iInfo;
+	int q = eInfo.qStart + iTask;
+	const QuantumNumber& qnum = eInfo.qnums[q];
+	ColumnBundle HCq = Idag_DiagV_I(eVars.C[q], eVars.Vscloc); //Accumulate Idag Diag(Vscloc) I C
+	if(eInfo.hasU) iInfo.rhoAtom_grad(eVars.C[q], eVars.U_rhoAtom, HCq); //Contribution via atomic density matrices (DFT+U)
+	std::vector<matrix> HVdagCq(iInfo.species.size());
+	iInfo.augmentDensitySphericalGrad(qnum, eVars.VdagC[q], HVdagCq); //Contribution via pseudopotential density augmentation
+	iInfo.projectGrad(HVdagCq, eVars.C[q], HCq);
+	eVars.Hsub[q] = dagger(lcao->rotPrev[q]) * lcao->HniSub[q] * lcao->rotPrev[q] + (eVars.C[q]^HCq);
+	eVars.Hsub[q].diagonalize(eVars.Hsub_evecs[q], eVars.Hsub_eigs[q]);
+	//N/M constraint contributions to gradient:
+	diagMatrix fprime = eInfo.smearPrime(eInfo.muEff(mu,Bz,q), eVars.Haux_eigs[q]);
+	(*dmuNumQ)[iTask] = qnum.weight * trace(fprime * (diag(eVars.Hsub[q])-eVars.Haux_eigs[q]));
+	(*dmuDenQ)[iTask] = qnum.weight * trace(fprime);
+}
+
+void LCAOminimizer::initOrbitals_sub(size_t iTask, LCAOminimizer* lcao, int nExtra)
+{	int q = lcao->eInfo.qStart + iTask;
+	lcao->eVars.C[q] = lcao->e.iInfo.getAtomicOrbitals(q, false, nExtra);
+}
+
+void LCAOminimizer::initHni_sub(size_t iTask, LCAOminimizer* lcao)
+{	ElecVars& eVars = lcao->eVars;
+	const IonInfo& iInfo = lcao->e.iInfo;
+	int q = lcao->eInfo.qStart + iTask;
+	eVars.orthonormalize(q);
+	//Non-interacting Hamiltonian:
+	ColumnBundle HniCq = -0.5*L(eVars.C[q]);
+	std::vector<matrix> HVdagCq(iInfo.species.size());
+	iInfo.EnlAndGrad(lcao->eInfo.qnums[q], eye(lcao->nBands), eVars.VdagC[q], HVdagCq); //non-local pseudopotentials
+	iInfo.projectGrad(HVdagCq, eVars.C[q], HniCq);
+	lcao->HniSub[q] = eVars.C[q]^HniCq;
+	lcao->rotPrev[q] = eye(lcao->nBands);
+}
+
+void LCAOminimizer::subspaceRotate_sub(size_t iTask, LCAOminimizer* lcao)
+{	ElecVars& eVars = lcao->eVars;
+	const IonInfo& iInfo = lcao->e.iInfo;
+	int q = lcao->eInfo.qStart + iTask;
+	//Calculate subspace Hamiltonian:
+	ColumnBundle HCq = Idag_DiagV_I(eVars.C[q], eVars.Vscloc); //local self-consistent potential
+	std::vector<matrix> HVdagCq(iInfo.species.size());
+	iInfo.augmentDensitySphericalGrad(lcao->eInfo.qnums[q], eVars.VdagC[q], HVdagCq); //ultrasoft augmentation
+	iInfo.projectGrad(HVdagCq, eVars.C[q], HCq);
+	eVars.Hsub[q] = dagger(lcao->rotPrev[q]) * lcao->HniSub[q] * lcao->rotPrev[q] + (eVars.C[q]^HCq);
+	
+	//Switch to eigenvectors of Hsub:
+	eVars.Hsub[q].diagonalize(eVars.Hsub_evecs[q], eVars.Hsub_eigs[q]);
+	eVars.C[q] = eVars.C[q] * eVars.Hsub_evecs[q];
+	for(unsigned sp=0; sp<iInfo.species.size(); sp++)
+		if(eVars.VdagC[q][sp]) eVars.VdagC[q][sp] = eVars.VdagC[q][sp] * eVars.Hsub_evecs[q]; 
+	lcao->rotPrev[q] = lcao->rotPrev[q] * eVars.Hsub_evecs[q];
+	eVars.Hsub[q] = eVars.Hsub_eigs[q];
+	eVars.Hsub_evecs[q] = eye(lcao->nBands);
+}
+
+
 int ElecVars::LCAO()
 {	const ElecInfo& eInfo = e->eInfo;
 	const IonInfo& iInfo = e->iInfo;
@@ -183,20 +243,15 @@ int ElecVars::LCAO()
 	std::vector<diagMatrix> Forig = F;
 	
 	//Get orthonormal atomic orbitals and non-interacting part of subspace Hamiltonian:
+	//(task-parallel over states if kpointThreadGroups > 1, except for the random numbers which are drawn in state order)
 	lcao.nBands = std::max(nAtomic+1, std::max(eInfo.nBands, int(ceil(1+eInfo.nElectrons/eInfo.qWeightSum))));
+	int nStatesMine = eInfo.qStop - eInfo.qStart;
+	threadedTaskLoop(lcao.nGroups, LCAOminimizer::initOrbitals_sub, nStatesMine, &lcao, lcao.nBands-nAtomic);
 	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
-	{	C[q] = iInfo.getAtomicOrbitals(q, false, lcao.nBands-nAtomic);
-		if(nAtomic<lcao.nBands) C[q].randomize(nAtomic, lcao.nBands); //Randomize extra columns if any
-		orthonormalize(q);
-		//Non-interacting Hamiltonian:
-		ColumnBundle HniCq = -0.5*L(C[q]);
-		std::vector<matrix> HVdagCq(iInfo.species.size());
-		iInfo.EnlAndGrad(eInfo.qnums[q], eye(lcao.nBands), VdagC[q], HVdagCq); //non-local pseudopotentials
-		iInfo.projectGrad(HVdagCq, C[q], HniCq);
-		lcao.HniSub[q] = C[q]^HniCq;
-		lcao.rotPrev[q] = eye(lcao.nBands);
+	{	if(nAtomic<lcao.nBands) C[q].randomize(nAtomic, lcao.nBands); //Randomize extra columns if any
 		F[q].resize(lcao.nBands, 0.);
 	}
+	threadedTaskLoop(lcao.nGroups, LCAOminimizer::initHni_sub, nStatesMine, &lcao);
 	
 	//Get electron density obtained by adding those of the atoms:
 	if(!e->cntrl.fixed_H)
@@ -225,25 +280,7 @@ int ElecVars::LCAO()
 		}
 		iInfo.augmentDensityInit();
 		iInfo.augmentDensityGridGrad(Vscloc); //Update Vscloc projections on ultrasoft pseudopotentials
-		
-		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
-		{
-			//Calculate subspace Hamiltonian:
-			ColumnBundle HCq = Idag_DiagV_I(C[q], Vscloc); //local self-consistent potential
-			std::vector<matrix> HVdagCq(iInfo.species.size());
-			iInfo.augmentDensitySphericalGrad(eInfo.qnums[q], VdagC[q], HVdagCq); //ultrasoft augmentation
-			iInfo.projectGrad(HVdagCq, C[q], HCq);
-			Hsub[q] = dagger(lcao.rotPrev[q]) * lcao.HniSub[q] * lcao.rotPrev[q] + (C[q]^HCq);
-			
-			//Switch to eigenvectors of Hsub:
-			Hsub[q].diagonalize(Hsub_evecs[q], Hsub_eigs[q]);
-			C[q] = C[q] * Hsub_evecs[q];
-			for(unsigned sp=0; sp<iInfo.species.size(); sp++)
-				if(VdagC[q][sp]) VdagC[q][sp] = VdagC[q][sp] * Hsub_evecs[q]; 
-			lcao.rotPrev[q] = lcao.rotPrev[q] * Hsub_evecs[q];
-			Hsub[q] = Hsub_eigs[q];
-			Hsub_evecs[q] = eye(lcao.nBands);
-		}
+		threadedTaskLoop(lcao.nGroups, LCAOminimizer::subspaceRotate_sub, nStatesMine, &lcao); //HniSub reused from above in rotated basis
 		
 		if(pass+1<nPasses) n = calcDensity(); //only needed here for a subsequent pass
 	}
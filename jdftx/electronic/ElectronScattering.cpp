@@ -45,7 +45,7 @@ double regularizedDelta(double omega, double omega0, double etaInv)
 
 ElectronScattering::ElectronScattering()
 : eta(0.), Ecut(0.), fCut(1e-6), omegaMax(0.), RPA(false), slabResponse(false), EcutTransverse(0.),
-	computeRange(false), iqStart(0), iqStop(0)
+	computeRange(false), iqStart(0), iqStop(0), nStatesCache(0)
 {
 }
 
@@ -121,7 +121,8 @@ void ElectronScattering::dump(const Everything& everything)
 		return;
 	}
 	
-	//Make necessary quantities available on all processes:
+	//Make energies and fillings available on all processes, while wavefunctions
+	//and projections of remote states are fetched on demand (see fetchStates):
 	C.resize(e.eInfo.nStates);
 	E.resize(e.eInfo.nStates);
 	F.resize(e.eInfo.nStates);
@@ -135,21 +136,14 @@ void ElectronScattering::dump(const Everything& everything)
 			std::swap(VdagC[q], e.eVars.VdagC[q]);
 		}
 		else
-		{	C[q].init(nBands, e.basis[q].nbasis * nSpinor, &e.basis[q], &e.eInfo.qnums[q]);
-			E[q].resize(nBands);
+		{	E[q].resize(nBands);
 			F[q].resize(nBands);
-			VdagC[q].resize(e.iInfo.species.size());
 		}
-		mpiWorld->bcastData(C[q], procSrc);
 		mpiWorld->bcastData(E[q], procSrc);
 		mpiWorld->bcastData(F[q], procSrc);
-		for(unsigned iSp=0; iSp<e.iInfo.species.size(); iSp++)
-			if(e.iInfo.species[iSp]->isUltrasoft())
-			{	if(!e.eInfo.isMine(q))
-					VdagC[q][iSp].init(e.iInfo.species[iSp]->nProjectors(), nBands);
-				mpiWorld->bcastData(VdagC[q][iSp], procSrc);
-			}
 	}
+	if(!nStatesCache) nStatesCache = std::max(1, e.eInfo.qStop - e.eInfo.qStart);
+	logPrintf("Caching at most %lu remote states per process.\n", nStatesCache);
 	
 	//Randomize supercell to improve load balancing on k-mesh:
 	{	std::vector< vector3<> >& kmesh = e.coulombParams.supercell->kmesh;
@@ -171,6 +165,13 @@ void ElectronScattering::dump(const Everything& everything)
 	plook = std::make_shared< PeriodicLookup< vector3<> > >(supercell->kmesh, e.gInfo.GGT);
 	size_t ikStart, ikStop;
 	TaskDivision(supercell->kmesh.size(), mpiWorld).myRange(ikStart, ikStop);
+	//--- order local k-points by reduced state, so that consecutive ones share fetched states:
+	std::multimap<int,size_t> ikByReduced;
+	for(size_t ik=ikStart; ik<ikStop; ik++)
+		ikByReduced.insert(std::make_pair(supercell->kmeshTransform[ik].iReduced, ik));
+	ikMine.clear();
+	for(const auto& entry: ikByReduced)
+		ikMine.push_back(entry.second);
 	double dEmax = 0.;
 	for(size_t ik=ikStart; ik<ikStop; ik++)
 	for(int iSpin=0; iSpin<nSpins; iSpin++)
@@ -295,31 +296,40 @@ void ElectronScattering::dump(const Everything& everything)
 		//Calculate chi_KS:
 		std::vector<matrix> chiKS(omegaGrid.nRows());
 		logPrintf("\tComputing chi_KS ...  "); logFlush(); 
-		size_t nkMine = ikStop-ikStart;
+		std::vector< std::vector<size_t> > ikBlocks = kBlocks(iq); //blocks of local k-points with bounded remote states
+		size_t nBlocks = ikBlocks.size();
+		mpiWorld->allReduce(nBlocks, MPIUtil::ReduceMax); //all processes must participate in each fetch
+		ikBlocks.resize(nBlocks);
+		size_t nkMine = ikMine.size(), ikDone = 0;
 		int ikInterval = std::max(1, int(round(nkMine/20.))); //interval for reporting progress
-		for(size_t ik=ikStart; ik<ikStop; ik++)
-		for(int iSpin=0; iSpin<nSpins; iSpin++)
-		{	//Report progress:
-			size_t ikDone = ik-ikStart+1;
-			if(ikDone % ikInterval == 0 && !iSpin)
-			{	logPrintf("%d%% ", int(round(ikDone*100./nkMine)));
-				logFlush();
-			}
-			//Get events:
-			size_t jk; matrix nij;
-			std::vector<Event> events = getEvents(true, iSpin, ik, iq, jk, nij);
-			if(!events.size()) continue;
-			//Collect contributions for each frequency:
-			for(int iOmega=0; iOmega<omegaGrid.nRows(); iOmega++)
-			{	double omega = omegaGrid[iOmega];
-				std::vector<complex> Xks; Xks.reserve(events.size());
-				for(const Event& event: events)
-					Xks.push_back(-e.gInfo.detR * kWeight * event.fWeight *
-						( regularizedPole(omega, -event.Eji, etaInv)
-						- regularizedPole(omega, +event.Eji, etaInv) ) );
-				chiKS[iOmega] += (nij * Xks) * dagger(nij);
+		for(const std::vector<size_t>& ikBlock: ikBlocks)
+		{	fetchStates(ikBlock, iq);
+			for(size_t ik: ikBlock)
+			{	//Report progress:
+				ikDone++;
+				if(ikDone % ikInterval == 0)
+				{	logPrintf("%d%% ", int(round(ikDone*100./nkMine)));
+					logFlush();
+				}
+				for(int iSpin=0; iSpin<nSpins; iSpin++)
+				{	//Get events:
+					size_t jk; matrix nij;
+					std::vector<Event> events = getEvents(true, iSpin, ik, iq, jk, nij);
+					if(!events.size()) continue;
+					//Collect contributions for each frequency:
+					for(int iOmega=0; iOmega<omegaGrid.nRows(); iOmega++)
+					{	double omega = omegaGrid[iOmega];
+						std::vector<complex> Xks; Xks.reserve(events.size());
+						for(const Event& event: events)
+							Xks.push_back(-e.gInfo.detR * kWeight * event.fWeight *
+								( regularizedPole(omega, -event.Eji, etaInv)
+								- regularizedPole(omega, +event.Eji, etaInv) ) );
+						chiKS[iOmega] += (nij * Xks) * dagger(nij);
+					}
+				}
 			}
 		}
+		fetchStates(std::vector<size_t>(), iq); //release remote states while computing screened interaction
 		for(int iOmega=0; iOmega<omegaGrid.nRows(); iOmega++)
 		{	mpiWorld->allReduceData(chiKS[iOmega], MPIUtil::ReduceSum);
 			if(!omegaDiv.isMine(iOmega)) chiKS[iOmega] = 0; //no longer needed on this process
@@ -355,52 +365,58 @@ void ElectronScattering::dump(const Everything& everything)
 		//Calculate ImSigma contributions:
 		std::vector<diagMatrix> ImSigmaCur(e.eInfo.nStates, diagMatrix(nBands, 0.)); //results from current momentum transfer
 		logPrintf("\tComputing ImSigma ... "); logFlush(); 
-		for(size_t ik=ikStart; ik<ikStop; ik++)
-		for(int iSpin=0; iSpin<nSpins; iSpin++)
-		{	//Report progress:
-			size_t ikDone = ik-ikStart+1;
-			if(ikDone % ikInterval == 0 && !iSpin)
-			{	logPrintf("%d%% ", int(round(ikDone*100./nkMine)));
-				logFlush();
-			}
-			//Get events:
-			size_t jk; matrix nij;
-			std::vector<Event> events = getEvents(false, iSpin, ik, iq, jk, nij);
-			if(!events.size()) continue;
-			//Integrate over frequency for event contributions to linewidth:
-			diagMatrix eventContrib(events.size(), 0);
-			for(size_t iEvent=0; iEvent<events.size(); iEvent++)
-			{	const Event& event = events[iEvent];
-				//Get Im(<nij|W|nij>) at required frequency:
-				matrix nijCur = nij(0,nij.nRows(), iEvent, iEvent+1); //current pair density
-				double omega0byEta = etaInv * fabs(event.Eji);
-				int iOmega = int(floor(omega0byEta)); //index into frequency mesh
-				double tOmega = omega0byEta - iOmega; //weight for linear interpolation into adjacent frequency mesh points
-				if(iOmega+1 < omegaGrid.nRows()) //i.e. omega0 < omegaMax
-				{	//Compute ImW interpolated to the required frequency:
-					double ImWL = iOmega ? dot(nijCur, ImKscr[iOmega] * nijCur) : 0.; //enforce exact zero-ness of ImW(0)
-					double ImWR = dot(nijCur, ImKscr[iOmega+1] * nijCur);
-					double ImW = copysign(ImWL + tOmega * (ImWR -ImWL), event.Eji); //interpolate and get correct sign (ImW is odd in omega)
-					//Add occupation factors:
-					const double& fj = event.fWeight;
-					double omegaByT = event.Eji / T; //note: could be negative
-					double nomega = (omegaByT<-36 ? -1. : //avoid underflow in exp
-						(omegaByT>36. ? 0. : //avoid overflow in exp
-							(fabs(omegaByT)<1e-8 ? 0. : //avoid 0/0 between ImW and bose
-								1./(exp(omegaByT)-1.) )));
-					eventContrib[iEvent] = e.gInfo.detR * ImW * (fj + nomega);
+		ikDone = 0;
+		for(const std::vector<size_t>& ikBlock: ikBlocks)
+		{	fetchStates(ikBlock, iq);
+			for(size_t ik: ikBlock)
+			{	//Report progress:
+				ikDone++;
+				if(ikDone % ikInterval == 0)
+				{	logPrintf("%d%% ", int(round(ikDone*100./nkMine)));
+					logFlush();
 				}
-			}
+				for(int iSpin=0; iSpin<nSpins; iSpin++)
+				{	//Get events:
+					size_t jk; matrix nij;
+					std::vector<Event> events = getEvents(false, iSpin, ik, iq, jk, nij);
+					if(!events.size()) continue;
+					//Integrate over frequency for event contributions to linewidth:
+					diagMatrix eventContrib(events.size(), 0);
+					for(size_t iEvent=0; iEvent<events.size(); iEvent++)
+					{	const Event& event = events[iEvent];
+						//Get Im(<nij|W|nij>) at required frequency:
+						matrix nijCur = nij(0,nij.nRows(), iEvent, iEvent+1); //current pair density
+						double omega0byEta = etaInv * fabs(event.Eji);
+						int iOmega = int(floor(omega0byEta)); //index into frequency mesh
+						double tOmega = omega0byEta - iOmega; //weight for linear interpolation into adjacent frequency mesh points
+						if(iOmega+1 < omegaGrid.nRows()) //i.e. omega0 < omegaMax
+						{	//Compute ImW interpolated to the required frequency:
+							double ImWL = iOmega ? dot(nijCur, ImKscr[iOmega] * nijCur) : 0.; //enforce exact zero-ness of ImW(0)
+							double ImWR = dot(nijCur, ImKscr[iOmega+1] * nijCur);
+							double ImW = copysign(ImWL + tOmega * (ImWR -ImWL), event.Eji); //interpolate and get correct sign (ImW is odd in omega)
+							//Add occupation factors:
+							const double& fj = event.fWeight;
+							double omegaByT = event.Eji / T; //note: could be negative
+							double nomega = (omegaByT<-36 ? -1. : //avoid underflow in exp
+								(omegaByT>36. ? 0. : //avoid overflow in exp
+									(fabs(omegaByT)<1e-8 ? 0. : //avoid 0/0 between ImW and bose
+										1./(exp(omegaByT)-1.) )));
+							eventContrib[iEvent] = e.gInfo.detR * ImW * (fj + nomega);
+						}
+					}
 			
-			//Accumulate contributions to linewidth:
-			int iReduced = supercell->kmeshTransform[ik].iReduced; //directly collect to reduced k-point
-			double symFactor = e.eInfo.spinWeight / (supercell->kmesh.size() * e.eInfo.qnums[iReduced].weight); //symmetrization factor = 1 / |orbit of iReduced|
-			double qWeight = qmesh[iq].weight;
-			for(size_t iEvent=0; iEvent<events.size(); iEvent++)
-			{	const Event& event = events[iEvent];
-				ImSigmaCur[iReduced+iSpin*qCount][event.i] += symFactor * qWeight * eventContrib[iEvent];
+					//Accumulate contributions to linewidth:
+					int iReduced = supercell->kmeshTransform[ik].iReduced; //directly collect to reduced k-point
+					double symFactor = e.eInfo.spinWeight / (supercell->kmesh.size() * e.eInfo.qnums[iReduced].weight); //symmetrization factor = 1 / |orbit of iReduced|
+					double qWeight = qmesh[iq].weight;
+					for(size_t iEvent=0; iEvent<events.size(); iEvent++)
+					{	const Event& event = events[iEvent];
+						ImSigmaCur[iReduced+iSpin*qCount][event.i] += symFactor * qWeight * eventContrib[iEvent];
+					}
+				}
 			}
 		}
+		fetchStates(std::vector<size_t>(), iq); //release remote states
 		logPrintf("done.\n"); logFlush();
 
 		//Accumulate contributions from this momentum transfer and write them to a file (for check-pointing):
@@ -568,6 +584,89 @@ ColumnBundle ElectronScattering::getWfns(size_t ik, int iSpin, const vector3<>&
 	return result;
 }
 
+void ElectronScattering::neededStates(size_t ik, size_t iq, std::set<int>& qNeeded) const
+{	size_t jk = plook->find(supercell->kmesh[ik] + qmesh[iq].k);
+	assert(jk != string::npos);
+	for(int iSpin=0; iSpin<nSpins; iSpin++)
+	{	int qi = supercell->kmeshTransform[ik].iReduced + iSpin*qCount;
+		int qj = supercell->kmeshTransform[jk].iReduced + iSpin*qCount;
+		if(!e->eInfo.isMine(qi)) qNeeded.insert(qi);
+		if(!e->eInfo.isMine(qj)) qNeeded.insert(qj);
+	}
+}
+
+std::vector< std::vector<size_t> > ElectronScattering::kBlocks(size_t iq) const
+{	std::vector< std::vector<size_t> > blocks(1);
+	std::set<int> qBlock; //remote states needed by current block
+	for(size_t ik: ikMine)
+	{	std::set<int> qNew = qBlock;
+		neededStates(ik, iq, qNew);
+		if(qNew.size() > nStatesCache && blocks.back().size())
+		{	//Start a new block:
+			blocks.push_back(std::vector<size_t>());
+			qNew.clear();
+			neededStates(ik, iq, qNew);
+		}
+		blocks.back().push_back(ik);
+		std::swap(qBlock, qNew);
+	}
+	return blocks;
+}
+
+void ElectronScattering::fetchStates(const std::vector<size_t>& ikBlock, size_t iq)
+{	static StopWatch watch("ElectronScattering::fetchStates"); watch.start();
+	const ElecInfo& eInfo = e->eInfo;
+	int nStates = eInfo.nStates;
+	int nProcs = mpiWorld->nProcesses();
+	int iProc = mpiWorld->iProcess();
+	//Release remote states that are no longer needed:
+	std::set<int> qNeeded;
+	for(size_t ik: ikBlock) neededStates(ik, iq, qNeeded);
+	for(int q=0; q<nStates; q++)
+		if(!eInfo.isMine(q) && C[q] && !qNeeded.count(q))
+		{	C[q].free();
+			VdagC[q].clear();
+		}
+	if(nProcs == 1) { watch.stop(); return; } //all states are local
+	//Collect requests for remote states from all processes:
+	std::vector<int> need(nProcs*nStates, 0); //whether each process needs each state
+	for(int q: qNeeded)
+		if(!C[q]) need[iProc*nStates+q] = 1;
+	mpiWorld->allReduceData(need, MPIUtil::ReduceMax);
+	//Send local states and receive remote ones concurrently:
+	//(both ends post states in increasing order and MPI preserves message order between a pair of processes,
+	// so tags need only distinguish the kind of data: 0 for wavefunctions, 1+iSp for projections)
+	std::vector<MPIUtil::Request> requests;
+	for(int jProc=0; jProc<nProcs; jProc++)
+		for(int q=0; q<nStates; q++)
+			if(need[jProc*nStates+q])
+			{	if(jProc == iProc) //receive remote state:
+				{	int procSrc = eInfo.whose(q);
+					C[q].init(nBands, e->basis[q].nbasis * nSpinor, &e->basis[q], &eInfo.qnums[q]);
+					requests.push_back(MPIUtil::Request());
+					mpiWorld->recvData(C[q], procSrc, 0, &requests.back());
+					VdagC[q].resize(e->iInfo.species.size());
+					for(unsigned iSp=0; iSp<e->iInfo.species.size(); iSp++)
+						if(e->iInfo.species[iSp]->isUltrasoft())
+						{	VdagC[q][iSp].init(e->iInfo.species[iSp]->nProjectors(), nBands);
+							requests.push_back(MPIUtil::Request());
+							mpiWorld->recvData(VdagC[q][iSp], procSrc, 1+iSp, &requests.back());
+						}
+				}
+				else if(eInfo.isMine(q)) //send local state:
+				{	requests.push_back(MPIUtil::Request());
+					mpiWorld->sendData(C[q], jProc, 0, &requests.back());
+					for(unsigned iSp=0; iSp<e->iInfo.species.size(); iSp++)
+						if(e->iInfo.species[iSp]->isUltrasoft())
+						{	requests.push_back(MPIUtil::Request());
+							mpiWorld->sendData(VdagC[q][iSp], jProc, 1+iSp, &requests.back());
+						}
+				}
+			}
+	MPIUtil::waitAll(requests);
+	watch.stop();
+}
+
 matrix ElectronScattering::coulombMatrix(size_t iq, matrix& Kxc) const
 {	//Use functions implemented in Polarizability:
 	matrix coulombMatrix(const ColumnBundle& V, const Everything& e, vector3<> dk);
@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Basis.h>
 #include <core/LatticeUtils.h>
 #include <memory>
+#include <set>
 
 class ColumnBundle;
 class diagMatrix;
@@ -47,6 +48,8 @@ struct ElectronScattering
 	bool computeRange; //!< only compute a subset of momentum transfers
 	size_t iqStart, iqStop; //!< range of q to compute in the current run
 	
+	size_t nStatesCache; //!< maximum number of remote reduced states (wavefunctions and projections) held on each process at a time (if zero, set to number of local states)
+	
 	ElectronScattering();
 	void dump(const Everything& e); //!< compute and dump Im(Sigma_ee) for each eigenstate
 
@@ -54,9 +57,10 @@ private:
 	const Everything* e;
 	int nBands, nSpinor, nSpins, qCount;
 	double Emin, Emax; //!< energy range that contributes to transitions less than omegaMax
-	std::vector<ColumnBundle> C; //wavefunctions, made available on all processes
+	std::vector<ColumnBundle> C; //wavefunctions: local states, and remote states while fetched on demand
 	std::vector<diagMatrix> E, F; //energies and fillings, available on all processes
-	std::vector<std::vector<matrix>> VdagC; //pseudopotential projections
+	std::vector<std::vector<matrix>> VdagC; //pseudopotential projections (same availability as C)
+	std::vector<size_t> ikMine; //k-mesh indices handled by current process (ordered by reduced state to improve reuse of fetched states)
 	std::shared_ptr<const Supercell> supercell; //contains transformations between full and reduced k-mesh
 	std::shared_ptr<const PeriodicLookup< vector3<> > > plook; //O(1) lookup for finding k-points in mesh
 	std::vector<QuantumNumber> qmesh; //reduced momentum-transfer mesh
@@ -82,6 +86,9 @@ private:
 	) const;
 	
 	ColumnBundle getWfns(size_t ik, int iSpin, const vector3<>& k, std::vector<matrix>* VdagCi=0) const; //get wavefunctions at an arbitrary point in k-mesh
+	void neededStates(size_t ik, size_t iq, std::set<int>& qNeeded) const; //add remote reduced states needed for events at ik and momentum transfer iq to qNeeded
+	std::vector< std::vector<size_t> > kBlocks(size_t iq) const; //split ikMine into blocks each needing at most nStatesCache remote states (unless a single ik needs more)
+	void fetchStates(const std::vector<size_t>& ikBlock, size_t iq); //release remote states no longer needed and fetch those needed for ikBlock (collective)
 	matrix coulombMatrix(size_t iq, matrix& Kxc) const; //retrieve the Coulomb and XC (if not RPA) operators for a specific momentum transfer
 	void nAugRhoAtomInit(size_t iq); //Initialize nAugRhoAtom for a specific momentum transfer
 	void dumpSlabResponse(Everything& e, const diagMatrix& omegaGrid);
@@ -628,15 +628,18 @@ template<typename Func> bool shouldInclude(const std::shared_ptr<Func>& function
 }
 
 double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, IncludeTXC includeTXC,
-		const ScalarFieldArray* tauPtr, ScalarFieldArray* Vtau, matrix3<>* Exc_RRT) const
+		const ScalarFieldArray* tauPtr, ScalarFieldArray* Vtau, matrix3<>* Exc_RRT, bool local) const
 {
 	static StopWatch watch("ExCorrTotal"), watchComm("ExCorrCommunication"), watchFunc("ExCorrFunctional");
-	watch.start();
+	//(timers are skipped when local, since local evaluations may run concurrently from several threads; see DumpSIC)
+	if(!local) watch.start();
 	
 	const int nInCount = n.size(); assert(nInCount==1 || nInCount==2 || nInCount==4);
 	const int nCount = std::min(nInCount, 2); //Number of spin-densities used in the parametrization of the functional
 	const int sigmaCount = 2*nCount-1;
 	const GridInfo& gInfo = n[0]->gInfo;
+	int irStart = local ? 0 : gInfo.irStart; //division of grid points (all on current process if local)
+	int irStop = local ? gInfo.nr : gInfo.irStop;
 	
 	//------- Prepare inputs, allocate outputs -------
 	
@@ -668,8 +671,8 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 	
 	//Calculate spatial gradients for GGA (if needed)
 	std::vector<VectorField> Dn(nInCount);
-	int iDirStart, iDirStop;
-	TaskDivision(3, mpiWorld).myRange(iDirStart, iDirStop);
+	int iDirStart = 0, iDirStop = 3;
+	if(!local) TaskDivision(3, mpiWorld).myRange(iDirStart, iDirStop);
 	if(needsSigma)
 	{	//Compute the gradients of the (spin-)densities:
 		for(int s=0; s<nInCount; s++)
@@ -744,10 +747,10 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 			for(int s2=s1; s2<nCount; s2++)
 			{	for(int i=iDirStart; i<iDirStop; i++)
 					sigma[s1+s2] += Dn[s1][i] * Dn[s2][i];
-				watchComm.start();
+				if(!local) watchComm.start();
 				nullToZero(sigma[s1+s2], gInfo);
-				sigma[s1+s2]->allReduceData(mpiWorld, MPIUtil::ReduceSum);
-				watchComm.stop();
+				if(!local) sigma[s1+s2]->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+				if(!local) watchComm.stop();
 			}
 		//Allocate gradient if required:
 		if(needGradients) nullToZero(E_sigma, gInfo, sigmaCount);
@@ -785,12 +788,12 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 		}
 		
 		//Calculate all the required functionals:
-		watchFunc.start();
+		if(!local) watchFunc.start();
 		for(auto func: functionals->libXC)
 			if(shouldInclude(func, includeTXC))
-				func->evaluateSub(nCount, gInfo.irStart, gInfo.irStop, nData, sigmaData, lapData, tauData,
+				func->evaluateSub(nCount, irStart, irStop, nData, sigmaData, lapData, tauData,
 					eData, E_nData, E_sigmaData, E_lapData, E_tauData);
-		watchFunc.stop();
+		if(!local) watchFunc.stop();
 		
 		//Uninterleave spin-vector field results:
 		if(nCount != 1)
@@ -812,13 +815,13 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 	#endif //LIBXC_ENABLED
 	
 	//---------------- Compute internal functionals ----------------
-	watchFunc.start();
+	if(!local) watchFunc.start();
 	for(auto func: functionals->internal)
 		if(shouldInclude(func, includeTXC))
-			func->evaluateSub(gInfo.irStart, gInfo.irStop,
+			func->evaluateSub(irStart, irStop,
 				constDataPref(nCapped), constDataPref(sigma), constDataPref(lap), constDataPref(tau),
 				E->dataPref(), dataPref(E_n), dataPref(E_sigma), dataPref(E_lap), dataPref(E_tau));
-	watchFunc.stop();
+	if(!local) watchFunc.stop();
 	
 	//Cleanup unneeded derived quantities (free memory before starting communications and gradient propagation)
 	double Exc = integral(E); E = 0; //note Exc accumulated over processes below in communication block
@@ -828,13 +831,15 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 	tau.clear();
 	
 	//---------------- Collect results over processes ----------------
-	watchComm.start();
-	mpiWorld->allReduce(Exc, MPIUtil::ReduceSum);
-	for(ScalarField& x: E_n) if(x) x->allReduceData(mpiWorld, MPIUtil::ReduceSum);
-	for(ScalarField& x: E_sigma) if(x) x->allReduceData(mpiWorld, MPIUtil::ReduceSum);
-	for(ScalarField& x: E_lap) if(x) x->allReduceData(mpiWorld, MPIUtil::ReduceSum);
-	for(ScalarField& x: E_tau) if(x) x->allReduceData(mpiWorld, MPIUtil::ReduceSum);
-	watchComm.stop();
+	if(!local)
+	{	watchComm.start();
+		mpiWorld->allReduce(Exc, MPIUtil::ReduceSum);
+		for(ScalarField& x: E_n) if(x) x->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+		for(ScalarField& x: E_sigma) if(x) x->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+		for(ScalarField& x: E_lap) if(x) x->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+		for(ScalarField& x: E_tau) if(x) x->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+		watchComm.stop();
+	}
 
 	//--------------- Gradient propagation ---------------------
 	if(needGradients)
@@ -911,14 +916,14 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 			}
 			//Accumulate over processes:
 			for(int s=0; s<nInCount; s++)
-			{	watchComm.start();
+			{	if(!local) watchComm.start();
 				nullToZero(E_nTilde[s], gInfo);
-				E_nTilde[s]->allReduceData(mpiWorld, MPIUtil::ReduceSum);
-				watchComm.stop();
+				if(!local) E_nTilde[s]->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+				if(!local) watchComm.stop();
 				E_n[s] += Jdag(E_nTilde[s]);
 			}
 			if(Exc_RRT)
-			{	mpiWorld->allReduce(Esigma_RRT, MPIUtil::ReduceSum);
+			{	if(!local) mpiWorld->allReduce(Esigma_RRT, MPIUtil::ReduceSum);
 				*Exc_RRT += Esigma_RRT;
 			}
 		}
@@ -926,17 +931,17 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 	
 	if(Vxc) *Vxc = E_n;
 	if(Vtau) *Vtau = E_tau;
-	watch.stop();
+	if(!local) watch.stop();
 	return Exc;
 }
 
 //Unpolarized wrapper to above function:
 double ExCorr::operator()(const ScalarField& n, ScalarField* Vxc, IncludeTXC includeTXC,
-		const ScalarField* tau, ScalarField* Vtau, matrix3<>* Exc_RRT) const
+		const ScalarField* tau, ScalarField* Vtau, matrix3<>* Exc_RRT, bool local) const
 {	ScalarFieldArray VxcArr(1), tauArr(1), VtauArr(1);
 	if(tau) tauArr[0] = *tau;
 	double Exc =  (*this)(ScalarFieldArray(1, n), Vxc ? &VxcArr : 0, includeTXC,
-		tau ? &tauArr :0, Vtau ? &VtauArr : 0, Exc_RRT);
+		tau ? &tauArr :0, Vtau ? &VtauArr : 0, Exc_RRT, local);
 	if(Vxc) *Vxc = VxcArr[0];
 	if(Vtau) *Vtau = VtauArr[0];
 	return Exc;
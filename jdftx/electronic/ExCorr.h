@@ -86,12 +86,14 @@ public:
 	//! and the corresponding gradient will be returned in Vtau if non-null
 	//! For metaGGAs, Vtau should be non-null if Vxc is non-null
 	//! Optionally compute stress due to XC if Exc_RRT is non-null
+	//! By default, the work is divided over mpiWorld (all processes must call with the same n);
+	//! if local=true, the evaluation is entirely on the current process without any communication
 	double operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc=0, IncludeTXC includeTXC=IncludeTXC(),
-		const ScalarFieldArray* tau=0, ScalarFieldArray* Vtau=0, matrix3<>* Exc_RRT=0) const;
+		const ScalarFieldArray* tau=0, ScalarFieldArray* Vtau=0, matrix3<>* Exc_RRT=0, bool local=false) const;
 	
 	//! Unpolarized wrapper to above function
 	double operator()(const ScalarField& n, ScalarField* Vxc=0, IncludeTXC includeTXC=IncludeTXC(),
-		const ScalarField* tau=0, ScalarField* Vtau=0, matrix3<>* Exc_RRT=0) const;
+		const ScalarField* tau=0, ScalarField* Vtau=0, matrix3<>* Exc_RRT=0, bool local=false) const;
 
 	double exxFactor() const; //!< retrieve the exact exchange scale factor (0 if no exact exchange)
 	double exxRange() const; //!< range parameter (omega) for screened exchange (0 for long-range exchange)
@@ -67,6 +67,12 @@ IonicDynamics::IonicDynamics(Everything& e)
 	if(statP) stressTarget = -idp.P0 * matrix3<>(1,1,1);
 	assert(not (statStress and statP));
 	
+	//Check extended-Lagrangian and multiple time-step options:
+	if((idp.xlbomdOrder or idp.respaSteps>1) and (statP or statStress))
+		die("Extended-Lagrangian and multiple time-step dynamics are not supported with barostats.\n\n");
+	if(idp.respaSteps > 1)
+		logPrintf("Integrating pair-potential forces with %d inner steps per time step.\n", idp.respaSteps);
+	
 	//Initialize velocities if necessary:
 	if(vInitNeeded)
 		initializeVelocities();
@@ -256,10 +262,25 @@ bool IonicDynamics::report(int iter, double t)
 
 void IonicDynamics::run()
 {	const IonicDynamicsParams& idp = e.ionicDynParams;
+	bool xlbomd = idp.xlbomdOrder and (not e.iInfo.ljOverride);
+	bool respa = (idp.respaSteps > 1);
 	
 	//Initial energies and forces
 	if(nAccumNeeded) nullToZero(e.eVars.nAccum, e.gInfo);
 	LatticeGradient accel = computePE(), accelV = thermostat(getVelocities()); //in Cartesian coordinates
+	LatticeGradient accelFast; //pair-potential acceleration (multiple time stepping only)
+	if(respa)
+	{	accelFast = computeFastAccel();
+		accel = accel - accelFast; //outer steps only integrate the remaining (slow) forces
+	}
+	
+	//Limit electronic iterations per step when propagating auxiliary wavefunctions:
+	int& elecIterations = e.cntrl.scf ? e.scfParams.nIterations : e.elecMinParams.nIterations;
+	int elecIterationsOrig = elecIterations;
+	if(xlbomd)
+	{	xlbomdInit();
+		elecIterations = idp.xlbomdElecSteps;
+	}
 	
 	for(int iter=0; iter<=idp.nSteps; iter++)
 	{	double t = iter*idp.dt;
@@ -271,8 +292,12 @@ void IonicDynamics::run()
 		LatticeGradient vel = getVelocities();
 		axpy(0.5*idp.dt, accel+accelV, vel);
 		//--- position and position-dependent acceleration update:
-		lmin.step(vel, idp.dt);
+		if(respa) respaStep(vel, accelFast); //also updates accelFast
+		else lmin.step(vel, idp.dt);
+		if(xlbomd) xlbomdGuess();
 		accel = computePE();
+		if(xlbomd) xlbomdPropagate();
+		if(respa) accel = accel - accelFast;
 		//--- velocity update: second half step estimator
 		axpy(0.5*idp.dt, accel+accelV, vel); //note second-order error here due to first-order error in accelV
 		//--- velocity update: second half step corrector
@@ -287,4 +312,101 @@ void IonicDynamics::run()
 				e.eVars.nAccum[s] += fracNew*(e.eVars.n[s] - e.eVars.nAccum[s]);
 			}
 	}
+	if(xlbomd) elecIterations = elecIterationsOrig;
+}
+
+
+//Coefficients for dissipative extended-Lagrangian propagation from Niklasson et al, J. Chem. Phys. 130, 214109 (2009)
+//for dissipation orders K = 3 to 9 (index K-3):
+static const double xlbomdKappa[7] = { 1.69, 1.75, 1.82, 1.84, 1.86, 1.88, 1.89 };
+static const double xlbomdAlpha[7] = { 150e-3, 57e-3, 18e-3, 5.5e-3, 1.6e-3, 0.44e-3, 0.12e-3 };
+static const int xlbomdCoeffs[7][10] =
+{	{ -2, 3, 0, -1 },
+	{ -3, 6, -2, -2, 1 },
+	{ -6, 14, -8, -3, 4, -1 },
+	{ -14, 36, -27, -2, 12, -6, 1 },
+	{ -36, 99, -88, 11, 32, -25, 8, -1 },
+	{ -99, 286, -286, 78, 78, -90, 42, -10, 1 },
+	{ -286, 858, -936, 364, 168, -300, 184, -63, 12, -1 }
+};
+
+void IonicDynamics::xlbomdInit()
+{	const IonicDynamicsParams& idp = e.ionicDynParams;
+	logPrintf("IonicDynamics: propagating auxiliary wavefunctions with dissipation order %d and at most %d electronic iterations per step.\n",
+		idp.xlbomdOrder, idp.xlbomdElecSteps);
+	Caux.assign(idp.xlbomdOrder+1, std::vector<ColumnBundle>(e.eInfo.nStates));
+	for(std::vector<ColumnBundle>& Ck: Caux)
+		for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+			Ck[q] = clone(e.eVars.C[q]);
+}
+
+void IonicDynamics::xlbomdPropagate()
+{	int K = e.ionicDynParams.xlbomdOrder;
+	double kappa = xlbomdKappa[K-3];
+	double alpha = xlbomdAlpha[K-3];
+	const int* c = xlbomdCoeffs[K-3];
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+	{	//Align gauge of electronic solution to current auxiliary wavefunctions (unitary polar factor of overlap):
+		matrix M = e.eVars.C[q] ^ O(Caux[0][q]);
+		ColumnBundle Cnext = e.eVars.C[q] * (M * invsqrt(dagger(M) * M));
+		//Verlet propagation with harmonic coupling to electronic solution and dissipation:
+		Cnext *= kappa;
+		Cnext += (2.-kappa) * Caux[0][q];
+		Cnext -= Caux[1][q];
+		for(int k=0; k<=K; k++)
+			if(c[k]) Cnext += (alpha*c[k]) * Caux[k][q];
+		//Update history:
+		for(int k=K; k>0; k--)
+			std::swap(Caux[k][q], Caux[k-1][q]);
+		Caux[0][q] = Cnext;
+	}
+}
+
+void IonicDynamics::xlbomdGuess()
+{	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+	{	e.eVars.C[q] = clone(Caux[0][q]);
+		e.eVars.orthonormalize(q); //at new ionic positions
+	}
+}
+
+
+LatticeGradient IonicDynamics::computeFastAccel()
+{	IonicGradient forces; forces.init(e.iInfo);
+	e.iInfo.pairPotentialsAndGrad(0, &forces);
+	e.symm.symmetrize(forces);
+	LatticeGradient accel; accel.init(e.iInfo);
+	accel.ionic = e.gInfo.invRT * forces; //Cartesian forces
+	for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+	{	const SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
+		for(size_t at=0; at<spInfo.atpos.size(); at++)
+			accel.ionic[sp][at] *= (spInfo.constraints[at].moveScale ? 1./(spInfo.mass*amu) : 0.);
+	}
+	lmin.constrain(accel);
+	return accel;
+}
+
+void IonicDynamics::respaStep(LatticeGradient& vel, LatticeGradient& accelFast)
+{	const IonicDynamicsParams& idp = e.ionicDynParams;
+	double dtInner = idp.dt / idp.respaSteps;
+	//Move ions directly on the inner steps (pair potentials need nothing else):
+	std::vector<std::vector<vector3<>>> atposOrig;
+	for(const auto& sp: e.iInfo.species) atposOrig.push_back(sp->atpos);
+	LatticeGradient dir; dir.init(e.iInfo); //net Cartesian displacement
+	for(int iInner=0; iInner<idp.respaSteps; iInner++)
+	{	axpy(0.5*dtInner, accelFast, vel);
+		for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+		{	SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
+			for(size_t at=0; at<spInfo.atpos.size(); at++)
+			{	vector3<> dpos = dtInner * vel.ionic[sp][at];
+				dir.ionic[sp][at] += dpos;
+				spInfo.atpos[at] += e.gInfo.invR * dpos;
+			}
+		}
+		accelFast = computeFastAccel();
+		axpy(0.5*dtInner, accelFast, vel);
+	}
+	//Restore ions and take the net step (with wavefunction drag and orthonormalization as usual):
+	for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+		e.iInfo.species[sp]->atpos = atposOrig[sp];
+	lmin.step(dir, 1.);
 }
@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_ELECTRONIC_IONICDYNAMICS_H
 
 #include <electronic/LatticeMinimizer.h>
+#include <electronic/ColumnBundle.h>
 #include <core/matrix3.h>
 
 //! @addtogroup IonicSystem
@@ -43,6 +44,7 @@ private:
 	matrix3<> stressTarget; //!< target stress tensor (for both types of barostats)
 	LatticeMinimizer lmin; //!< Helper class for changing atomic positions / lattice vectors (doesn't minimize anything)
 	bool nAccumNeeded; //!< Whether accumulated electron density is needed
+	std::vector<std::vector<ColumnBundle>> Caux; //!< history of auxiliary wavefunctions (most recent first) for extended-Lagrangian dynamics
 	
 	//Current thermodynamic properties:
 	double KE; //!< current kinetic energy
@@ -60,6 +62,15 @@ private:
 	LatticeGradient computePE(); //!< Update potential energy and return acceleration (due to potential forces)
 	LatticeGradient thermostat(const LatticeGradient& vel); //!< Return velocity-dependent acceleration due to thermostat (calls setVelocities, computeKE and computePressure)
 	bool report(int iter, double t); //!< Report properties at current step
+	
+	//Extended-Lagrangian Born-Oppenheimer dynamics:
+	void xlbomdInit(); //!< initialize auxiliary wavefunction history from current (converged) wavefunctions
+	void xlbomdPropagate(); //!< propagate auxiliary wavefunctions using current electronic solution (call after computePE)
+	void xlbomdGuess(); //!< set electronic initial guess from auxiliary wavefunctions (call after moving ions)
+	
+	//Multiple time stepping:
+	LatticeGradient computeFastAccel(); //!< Return acceleration due to pair potentials alone (fast forces integrated on the inner steps)
+	void respaStep(LatticeGradient& vel, LatticeGradient& accelFast); //!< Integrate fast forces over one time step (updating vel, accelFast and ionic positions)
 };
 
 //! @}
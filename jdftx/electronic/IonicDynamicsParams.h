@@ -39,11 +39,15 @@ struct IonicDynamicsParams
 	int chainLengthT; //!< Nose-Hoover chain length for thermostat
 	int chainLengthP; //!< Nose-Hoover chain length for barostat
 	double B0; //!< characteristic bulk modulus for Berendsen barostat (default: water bulk modulus)
+	int xlbomdOrder; //!< dissipation order K (3 to 9) for extended-Lagrangian propagation of auxiliary wavefunctions (0 => disabled)
+	int xlbomdElecSteps; //!< maximum electronic iterations per step (after the first) in extended-Lagrangian mode
+	int respaSteps; //!< number of inner steps per time step for pair-potential forces in multiple time stepping (1 => disabled)
 	
 	IonicDynamicsParams() : dt(1.*fs), nSteps(0), statMethod(StatNone),
 		T0(298*Kelvin), P0(NAN), stress0(NAN,NAN,NAN),
 		tDampT(50.*fs), tDampP(100.*fs),
-		chainLengthT(3), chainLengthP(3), B0(2.2E9*Pascal) {}
+		chainLengthT(3), chainLengthP(3), B0(2.2E9*Pascal),
+		xlbomdOrder(0), xlbomdElecSteps(4), respaSteps(1) {}
 };
 
 //! @}
@@ -41,7 +41,7 @@ inline ScalarFieldArray operator*(const RealKernel& K, const ScalarFieldArray& x
 	return Kx;
 }
 
-SCF::SCF(Everything& e): Pulay<SCFvariable>(e.scfParams), e(e), kerkerMix(e.gInfo), diisMetric(e.gInfo)
+SCF::SCF(Everything& e): Pulay<SCFvariable>(e.scfParams), e(e), kerkerMix(e.gInfo), diisMetric(e.gInfo), nBandsLocked(0)
 {	SCFparams& sp = e.scfParams;
 	mixTau = e.exCorr.needsKEdensity();
 	
@@ -147,7 +147,7 @@ double SCF::cycle(double dEprev, std::vector<double>& extraValues)
 	if(not sp.verbose) { logSuspend(); e.elecMinParams.fpLog = nullLog; } // Silence eigensolver output
 	e.elecMinParams.energyDiffThreshold = std::min(1e-6, 0.1*fabs(dEprev));
 	if(sp.nEigSteps) e.elecMinParams.nIterations = sp.nEigSteps;
-	bandMinimize(e, false);
+	nBandsLocked = bandMinimize(e, false); //converged bands are locked and k-points with all bands locked exit early
 	if(not sp.verbose) { logResume(); e.elecMinParams.fpLog = globalLog; }  // Resume output
 
 	//Compute new density and energy
@@ -162,6 +162,9 @@ double SCF::cycle(double dEprev, std::vector<double>& extraValues)
 
 void SCF::report(int iter)
 {
+	if(e.cntrl.elecEigenAlgo == ElecEigenDavidson)
+		logPrintf("%sEigensolver locked %d of %d bands (summed over k-points).\n",
+			e.scfParams.linePrefix, nBandsLocked, e.eInfo.nBands*e.eInfo.nStates);
 	if(e.cntrl.shouldPrintEigsFillings) print_Hsub_eigs(e);
 	if(e.cntrl.shouldPrintEcomponents) { logPrintf("\n"); e.ener.print(); logPrintf("\n"); }
 	logFlush();
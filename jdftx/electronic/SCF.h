@@ -65,6 +65,7 @@ private:
 	Everything& e;
 	bool mixTau; //!< whether KE needs to be mixed
 	RealKernel kerkerMix, diisMetric; //!< convolution kernels for kerker preconditioning and the DIIS overlap metric
+	int nBandsLocked; //!< number of bands locked (residual converged) by the eigensolver in the latest cycle, summed over k-points
 	
 	double eigDiffRMS(const std::vector<diagMatrix>&, const std::vector<diagMatrix>&) const; //!< weighted RMS difference between two sets of eigenvalues
 };
@@ -80,6 +80,39 @@ void Vnl_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, vector3<> k,
 }
 
 
+//Structure factors for reuse across l,m in VnlSF:
+__global__
+void structureFactor_kernel(int nbasis, int nAtoms, vector3<> k, const vector3<int>* iGarr, const vector3<>* pos, complex* SF)
+{	int n = kernelIndex1D();
+	if(n<nbasis) structureFactor_calc(n, nbasis, nAtoms, k, iGarr, pos, SF);
+}
+void structureFactor_gpu(int nbasis, int nAtoms, vector3<> k, const vector3<int>* iGarr, const vector3<>* pos, complex* SF)
+{	GpuLaunchConfig1D glc(structureFactor_kernel, nbasis);
+	structureFactor_kernel<<<glc.nBlocks,glc.nPerBlock>>>(nbasis, nAtoms, k, iGarr, pos, SF);
+	gpuErrorCheck();
+}
+
+//Calculate non-local pseudopotential projector from precomputed structure factors:
+template<int l, int m> __global__
+void VnlSF_kernel(int nbasis, int atomStride, int nAtoms, vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* SF, const RadialFunctionG VnlRadial, complex* V)
+{	int n = kernelIndex1D();
+	if(n<nbasis) VnlSF_calc<l,m>(n, atomStride, nAtoms, k, iGarr, G, nbasis, SF, VnlRadial, V);
+}
+template<int l, int m>
+void VnlSF_gpu(int nbasis, int atomStride, int nAtoms, vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* SF, const RadialFunctionG& VnlRadial, complex* V)
+{	GpuLaunchConfig1D glc(VnlSF_kernel<l,m>, nbasis);
+	VnlSF_kernel<l,m><<<glc.nBlocks,glc.nPerBlock>>>(nbasis, atomStride, nAtoms, k, iGarr, G, SF, VnlRadial, V);
+	gpuErrorCheck();
+}
+void VnlSF_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* SF, const RadialFunctionG& VnlRadial, complex* V)
+{
+	SwitchTemplate_lm(l,m, VnlSF_gpu, (nbasis, atomStride, nAtoms, k, iGarr, G, SF, VnlRadial, V) )
+}
+
+
 //Augment electron density by spherical functions
 template<int Nlm> __global__ void nAugment_kernel(int zBlock, const vector3<int> S, const matrix3<> G, int iGstart, int iGstop,
 	int nCoeff, double dGinv, const double* nRadial, const vector3<> atpos, complex* n)
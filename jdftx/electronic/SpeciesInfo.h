@@ -135,8 +135,9 @@ public:
 	void setAtomicOrbitals(ColumnBundle& Y, bool applyO, int colOffset=0,
 		const vector3<>* derivDir=0, const int stressDir=-1) const; //!< Calculate atomic orbitals with/without O preapplied (store in Y with an optional column offset, or calculate derivatives instead)
 	void setAtomicOrbitals(ColumnBundle& Y, bool applyO, unsigned n, int l, int colOffset=0, int atomColStride=0,
-		const vector3<>* derivDir=0, const int stressDir=-1) const;  //!< Same as above, but for specific n and l.
+		const vector3<>* derivDir=0, const int stressDir=-1, const complex* SF=0) const;  //!< Same as above, but for specific n and l.
 		//!< If non-zero, atomColStride overrides the number of columns between the same orbital of multiple atoms (default = number of orbitals at current n and l)
+		//!< If non-null, SF contains precomputed structure factors of all atoms at Y's basis (see structureFactor(); values only, not derivatives)
 	int nAtomicOrbitals() const; //!< return number of atomic orbitals in this species (all atoms)
 	int lMaxAtomicOrbitals() const; //!< return maximum angular momentum in available atomic orbitals
 	int nAtomicOrbitals(int l) const; //!< return number of (pseudo-)principal quantum numbers for atomic orbitals of given l
@@ -252,6 +253,7 @@ private:
 	friend class IonInfo;
 	friend class PCM;
 	friend class Phonon;
+	friend class PhononDFPT;
 	friend class VanDerWaals;
 	friend class WannierMinimizer;
 };
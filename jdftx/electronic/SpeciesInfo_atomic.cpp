@@ -159,14 +159,21 @@ void SpeciesInfo::setAtomicOrbitals(ColumnBundle& Y, bool applyO, int colOffset,
 	int nOrbitalsPerAtom = 0;
 	for(int l=0; l<int(fRadial.size()); l++)
 		nOrbitalsPerAtom += nAtomicOrbitals(l)*(2*l+1)*nSpinCopies;
+	//Precompute structure factors once for all orbitals (values only; memory is a fraction 1/nOrbitalsPerAtom of Y):
+	ManagedArray<complex> SF;
+	if((!derivDir) && (stressDir<0) && (nOrbitalsPerAtom > nSpinCopies))
+	{	const Basis& basis = *Y.basis;
+		SF.init(basis.nbasis * atpos.size(), isGpuEnabled());
+		callPref(structureFactor)(basis.nbasis, atpos.size(), Y.qnum->k, basis.iGarr.dataPref(), atposManaged.dataPref(), SF.dataPref());
+	}
 	int iCol = colOffset;
 	for(int l=0; l<int(fRadial.size()); l++)
 		for(int n=0; n<nAtomicOrbitals(l); n++)
-		{	setAtomicOrbitals(Y, applyO, n, l, iCol, nOrbitalsPerAtom, derivDir, stressDir);
+		{	setAtomicOrbitals(Y, applyO, n, l, iCol, nOrbitalsPerAtom, derivDir, stressDir, SF.nData() ? SF.dataPref() : 0);
 			iCol += (2*l+1)*nSpinCopies;
 		}
 }
-void SpeciesInfo::setAtomicOrbitals(ColumnBundle& psi, bool applyO, unsigned n, int l, int colOffset, int atomColStride, const vector3<>* derivDir, const int stressDir) const
+void SpeciesInfo::setAtomicOrbitals(ColumnBundle& psi, bool applyO, unsigned n, int l, int colOffset, int atomColStride, const vector3<>* derivDir, const int stressDir, const complex* SF) const
 {	if(!atpos.size()) return;
 	assert(l < int(psiRadial.size()));
 	assert(int(n) < nAtomicOrbitals(l));
@@ -195,8 +202,12 @@ void SpeciesInfo::setAtomicOrbitals(ColumnBundle& psi, bool applyO, unsigned n,
 		for(int p: pArr) for(int m=-l; m<=l; m++)
 		{	size_t atomStride = V.colLength() * nOrbitalsPerAtom;
 			size_t offs = iCol * V.colLength();
-			callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(),
-				e->gInfo.G, atposManaged.dataPref(), fRadial[l][p], V.dataPref()+offs, derivDir, stressDir);
+			if(SF)
+				callPref(VnlSF)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(),
+					e->gInfo.G, SF, fRadial[l][p], V.dataPref()+offs);
+			else
+				callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(),
+					e->gInfo.G, atposManaged.dataPref(), fRadial[l][p], V.dataPref()+offs, derivDir, stressDir);
 			iCol++;
 		}
 		//Transform the non-spinor ColumnBundle to the spinorial j eigenfunctions:
@@ -213,8 +224,12 @@ void SpeciesInfo::setAtomicOrbitals(ColumnBundle& psi, bool applyO, unsigned n,
 		{	//Set atomic orbitals for all atoms at specified (n,l,m):
 			size_t atomStride = psi.colLength() * atomColStride;
 			size_t offs = iCol * psi.colLength();
-			callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(),
-				e->gInfo.G, atposManaged.dataPref(), fRadial[l][n], psi.dataPref()+offs, derivDir, stressDir);
+			if(SF)
+				callPref(VnlSF)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(),
+					e->gInfo.G, SF, fRadial[l][n], psi.dataPref()+offs);
+			else
+				callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, psi.qnum->k, basis.iGarr.dataPref(),
+					e->gInfo.G, atposManaged.dataPref(), fRadial[l][n], psi.dataPref()+offs, derivDir, stressDir);
 			if(nSpinCopies>1) //make copy for other spin
 			{	complex* dataPtr = psi.dataPref()+offs;
 				for(size_t a=0; a<atpos.size(); a++)
@@ -174,6 +174,7 @@ void SpeciesInfo::augmentDensityGrid(ScalarFieldArray& n) const
 	matrix nAugTot = nAug; mpiWorld->allReduceData(nAugTot, MPIUtil::ReduceSum); //collect radial functions from all processes, and split by G-vectors below
 	matrix nAugRadial = QradialMat * nAugTot; //transform from radial functions to spline coeffs
 	double* nAugRadialData = (double*)nAugRadial.dataPref();
+	#ifdef GPU_ENABLED
 	for(unsigned s=0; s<n.size(); s++)
 	{	ScalarFieldTilde nAugTilde; nullToZero(nAugTilde, gInfo);
 		for(unsigned atom=0; atom<atpos.size(); atom++)
@@ -182,6 +183,15 @@ void SpeciesInfo::augmentDensityGrid(ScalarFieldArray& n) const
 		}
 		n[s] += I(nAugTilde);
 	}
+	#else
+	//All atoms and density components in one G-space sweep:
+	ScalarFieldTildeArray nAugTilde(n.size());
+	nullToZero(nAugTilde, gInfo);
+	std::vector<complex*> nAugTildeData = dataPref(nAugTilde);
+	nAugmentBatch(Nlm, gInfo.S, gInfo.G, gInfo.iGstart, gInfo.iGstop, nCoeff, dGinv, nAugRadialData, atpos.size(), atpos.data(), n.size(), nAugTildeData.data());
+	for(unsigned s=0; s<n.size(); s++)
+		n[s] += I(nAugTilde[s]);
+	#endif
 	watch.stop();
 }
 
@@ -199,6 +209,7 @@ void SpeciesInfo::augmentDensityGridGrad(const ScalarFieldArray& E_n, std::vecto
 		nAugRadial = QradialMat * nAugTot;
 		nAugRadialData = (const double*)nAugRadial.dataPref();
 	}
+	#ifdef GPU_ENABLED
 	VectorFieldTilde E_atpos; if(forces) nullToZero(E_atpos, gInfo);
 	ScalarFieldTildeArray E_RRT(6); if(Eaug_RRT) nullToZero(E_RRT, gInfo);
 	for(unsigned s=0; s<E_n.size(); s++)
@@ -222,6 +233,21 @@ void SpeciesInfo::augmentDensityGridGrad(const ScalarFieldArray& E_n, std::vecto
 			E_RRTsumData[ij] = sum(E_RRT[ij]);
 		*Eaug_RRT += matrix3<>(E_RRTsum);
 	}
+	#else
+	//All atoms and density components in one G-space sweep, with forces and stress accumulated directly:
+	ScalarFieldTildeArray ccE_n(E_n.size());
+	for(unsigned s=0; s<E_n.size(); s++) ccE_n[s] = Idag(E_n[s]);
+	std::vector<const complex*> ccE_nData = constDataPref(ccE_n);
+	std::vector<vector3<>> E_atpos(forces ? atpos.size() : 0);
+	symmetricMatrix3<> E_RRTsum;
+	nAugmentGradBatch(Nlm, gInfo.S, gInfo.G, nCoeff, dGinv, nAugRadialData, atpos.size(), atpos.data(),
+		E_n.size(), ccE_nData.data(), E_nAugRadialData,
+		forces ? &E_atpos[0][0] : 0,
+		Eaug_RRT ? (double*)&E_RRTsum : 0,
+		nagIndex.data(), nagIndexPtr.data());
+	if(forces) for(unsigned atom=0; atom<atpos.size(); atom++) (*forces)[atom] -= E_atpos[atom];
+	if(Eaug_RRT) *Eaug_RRT += matrix3<>(E_RRTsum);
+	#endif
 	E_nAug = dagger(QradialMat) * E_nAugRadial;  //propagate from spline coeffs to radial functions
 	mpiWorld->allReduceData(E_nAug, MPIUtil::ReduceSum);
 	watch.stop();
@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
 #include <core/matrix.h>
+#include <mutex>
 
 //------- primary SpeciesInfo functions involved in simple energy and gradient calculations (with norm-conserving pseudopotentials) -------
 
@@ -323,9 +324,11 @@ std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, const ve
 	std::pair<vector3<>,const Basis*> cacheKey = std::make_pair(qnum.k, &basis);
 	int nProj = MnlAll.nRows() / e->eInfo.spinorLength();
 	if(!nProj) return 0; //purely local psp
+	static std::mutex cacheLock; //cache may be accessed from concurrent k-point thread groups
 	//First check cache
 	if(e->cntrl.cacheProjectors && (!derivDir) && (!stressDir))
-	{	auto iter = cachedV.find(cacheKey);
+	{	std::lock_guard<std::mutex> lock(cacheLock);
+		auto iter = cachedV.find(cacheKey);
 		if(iter != cachedV.end()) //found
 			return iter->second; //return cached value
 	}
@@ -343,6 +346,8 @@ std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, const ve
 			}
 	//Add to cache if necessary:
 	if(e->cntrl.cacheProjectors && (!derivDir) && (!stressDir))
+	{	std::lock_guard<std::mutex> lock(cacheLock);
 		((SpeciesInfo*)this)->cachedV[cacheKey] = V;
+	}
 	return V;
 }
@@ -24,6 +24,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/BlasExtra.h>
 #include <algorithm>
 #include <atomic>
+#include <mutex>
 
 //Initialize non-local projector from a radial function at a particular l,m (or its k derivatives)
 template<int l, int m>
@@ -49,6 +50,20 @@ void Vnl(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k
 {	SwitchTemplate_lm(l,m, Vnl, (nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, V, derivDir, stressDir) )
 }
 
+void structureFactor(int nbasis, int nAtoms, const vector3<> k, const vector3<int>* iGarr, const vector3<>* pos, complex* SF)
+{	threadedLoop(structureFactor_calc, nbasis, nbasis, nAtoms, k, iGarr, pos, SF);
+}
+
+template<int l, int m>
+void VnlSF(int nbasis, int atomStride, int nAtoms, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* SF, const RadialFunctionG& VnlRadial, complex* V)
+{	threadedLoop(VnlSF_calc<l,m>, nbasis, atomStride, nAtoms, k, iGarr, G, nbasis, SF, VnlRadial, V);
+}
+void VnlSF(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* SF, const RadialFunctionG& VnlRadial, complex* V)
+{	SwitchTemplate_lm(l,m, VnlSF, (nbasis, atomStride, nAtoms, k, iGarr, G, SF, VnlRadial, V) )
+}
+
 //Augment electron density by spherical functions
 template<int Nlm> void nAugment_sub(size_t diStart, size_t diStop, const vector3<int> S, const matrix3<>& G, int iGstart,
 	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
@@ -123,6 +138,157 @@ void nAugmentGrad(int Nlm, const vector3<int> S, const matrix3<>& G,
 }
 
 
+//Spherical harmonics of G-vector direction (with (-i)^l phase) shared by all atoms and densities in the batched kernels below
+template<int Nlm> struct nAugmentYlmFunctor
+{	vector3<> qhat; bool calcPrime;
+	complex phase[Nlm]; double Y[Nlm]; vector3<> Yprime[Nlm];
+	
+	nAugmentYlmFunctor(const vector3<>& qhat, bool calcPrime) : qhat(qhat), calcPrime(calcPrime) {}
+	
+	template<int lm> void operator()(const StaticLoopYlmTag<lm>&)
+	{	complex mIota(0,-1); phase[lm] = 1.;
+		for(int l=0; l*(l+2) < lm; l++) phase[lm] *= mIota;
+		Y[lm] = Ylm<lm>(qhat);
+		if(calcPrime) Yprime[lm] = YlmPrime<lm>(qhat);
+	}
+};
+const int nDensitiesMax = 4; //maximum number of density components (noncollinear magnetic case)
+
+//Batched augmentation of all atoms and density components
+template<int Nlm> void nAugmentBatch_sub(size_t diStart, size_t diStop, const vector3<int> S, const matrix3<>& G, int iGstart,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos, int nDensities, complex* const* n)
+{	size_t iStart = iGstart + diStart;
+	size_t iStop = iGstart + diStop;
+	THREAD_halfGspaceLoop(
+		vector3<> qvec = iG*G;
+		double q = qvec.length();
+		double Gindex = q * dGinv;
+		if(Gindex < nCoeff-5)
+		{	nAugmentYlmFunctor<Nlm> ylm(qvec * (q ? 1./q : 0.), false);
+			staticLoopYlm<Nlm>(&ylm);
+			complex nSum[nDensitiesMax];
+			for(int atom=0; atom<nAtoms; atom++)
+			{	complex SG = cis((-2*M_PI)*dot(atpos[atom],iG)); //structure factor of this atom
+				for(int s=0; s<nDensities; s++)
+				{	const double* nRadialCur = nRadial + nCoeff*Nlm*(atom + nAtoms*s);
+					complex nCur;
+					for(int lm=0; lm<Nlm; lm++)
+						nCur += ylm.phase[lm] * (ylm.Y[lm] * QuinticSpline::value(nRadialCur+lm*nCoeff, Gindex));
+					nSum[s] += nCur * SG;
+				}
+			}
+			for(int s=0; s<nDensities; s++)
+				n[s][i] += nSum[s];
+		}
+	)
+}
+template<int Nlm> void nAugmentBatch(const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos, int nDensities, complex* const* n)
+{
+	threadLaunch(nAugmentBatch_sub<Nlm>, iGstop-iGstart, S, G, iGstart, nCoeff, dGinv, nRadial, nAtoms, atpos, nDensities, n);
+}
+void nAugmentBatch(int Nlm, const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos, int nDensities, complex* const* n)
+{	assert(nDensities <= nDensitiesMax);
+	SwitchTemplate_Nlm(Nlm, nAugmentBatch, (S, G, iGstart, iGstop, nCoeff, dGinv, nRadial, nAtoms, atpos, nDensities, n) )
+}
+
+//Batched gradient propagation for all atoms and density components
+template<int Nlm> void nAugmentGradBatch_sub(int iStart, int iStop, const vector3<int> S, const matrix3<>& G,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos,
+	int nDensities, const complex* const* ccE_n, double* E_nRadial, double* E_atpos, double* E_RRT,
+	const uint64_t* nagIndex, const size_t* nagIndexPtr, int pass, std::mutex* accumLock)
+{
+	(pass ? iStart : iStop) = (iStart+iStop)/2; //do first and second halves of range in each pass
+	bool calcForces = nRadial && E_atpos;
+	bool calcStress = nRadial && E_RRT;
+	std::vector<vector3<>> E_atposThread(calcForces ? nAtoms : 0); //per-thread force buffer
+	double E_RRTthread[6] = { 0., 0., 0., 0., 0., 0. }; //per-thread stress buffer
+	for(int iCoeff=iStart; iCoeff<iStop; iCoeff++)
+		for(size_t ptr=nagIndexPtr[iCoeff]; ptr<nagIndexPtr[iCoeff+1]; ptr++)
+		{	//Obtain 3D index iG and array offset i for this point (same as nAugmentGrad_calc)
+			uint64_t key = nagIndex[ptr];
+			vector3<int> iG;
+			iG[2] = int(0xFFFF & key); key >>= 16;
+			iG[1] = int(0xFFFF & key); key >>= 16;
+			iG[0] = int(0xFFFF & key);
+			size_t i = iG[2] + (S[2]/2+1)*size_t(iG[1] + S[1]*iG[0]);
+			for(int j=0; j<3; j++) if(2*iG[j]>S[j]) iG[j]-=S[j];
+			int dotPrefac = (iG[2]==0||2*iG[2]==S[2]) ? 1 : 2;
+			vector3<> qvec = iG*G;
+			double q = qvec.length();
+			double qInv = q ? 1./q : 0.;
+			double Gindex = q * dGinv;
+			if(Gindex >= nCoeff-5) continue;
+			nAugmentYlmFunctor<Nlm> ylm(qvec * qInv, calcStress);
+			staticLoopYlm<Nlm>(&ylm);
+			//Loop over atoms and densities:
+			for(int atom=0; atom<nAtoms; atom++)
+			{	complex SG = cis((-2*M_PI)*dot(atpos[atom],iG)); //structure factor of this atom
+				complex nE_n; //contribution to energy (for forces)
+				for(int s=0; s<nDensities; s++)
+				{	int atomOffs = nCoeff*Nlm*(atom + nAtoms*s);
+					complex E_n = ccE_n[s][i].conj() * SG;
+					vector3<> nPrimeE_n; //dn/dq * E_n for stress calculation
+					for(int lm=0; lm<Nlm; lm++)
+					{	complex term = ylm.phase[lm] * ylm.Y[lm] * E_n;
+						QuinticSpline::valueGrad(dotPrefac * term.real(), E_nRadial+atomOffs+lm*nCoeff, Gindex);
+						if(nRadial)
+						{	double n = QuinticSpline::value(nRadial+atomOffs+lm*nCoeff, Gindex);
+							nE_n += n * term;
+							if(calcStress)
+							{	double nPrime = QuinticSpline::deriv(nRadial+atomOffs+lm*nCoeff, Gindex) * dGinv;
+								const vector3<>& Yprime = ylm.Yprime[lm];
+								nPrimeE_n += real(ylm.phase[lm] * E_n) * (n*qInv*Yprime + ylm.qhat*(nPrime*ylm.Y[lm] - n*qInv*dot(Yprime,ylm.qhat)));
+							}
+						}
+					}
+					if(calcStress)
+					{	for(int iDir=0; iDir<3; iDir++)
+						{	int jDir = (iDir+1)%3;
+							int kDir = (iDir+2)%3;
+							E_RRTthread[iDir] -= dotPrefac * (nPrimeE_n[iDir] * qvec[iDir]); //from radial function
+							E_RRTthread[iDir+3] -= dotPrefac * (nPrimeE_n[jDir] * qvec[kDir]); //from radial function
+						}
+					}
+				}
+				if(calcForces)
+					E_atposThread[atom] += (dotPrefac * (nE_n * complex(0,-2*M_PI)).real()) * vector3<>(iG);
+				if(calcStress)
+					for(int iDir=0; iDir<3; iDir++)
+						E_RRTthread[iDir] -= dotPrefac * nE_n.real(); //from 1/detR in nAugmentSpherical()
+			}
+		}
+	//Accumulate per-thread buffers:
+	std::lock_guard<std::mutex> lock(*accumLock);
+	if(calcForces)
+		for(int atom=0; atom<nAtoms; atom++)
+			for(int k=0; k<3; k++)
+				E_atpos[3*atom+k] += E_atposThread[atom][k];
+	if(calcStress)
+		for(int ij=0; ij<6; ij++)
+			E_RRT[ij] += E_RRTthread[ij];
+}
+template<int Nlm> void nAugmentGradBatch(const vector3<int> S, const matrix3<>& G,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos,
+	int nDensities, const complex* const* ccE_n, double* E_nRadial, double* E_atpos, double* E_RRT,
+	const uint64_t* nagIndex, const size_t* nagIndexPtr)
+{	
+	int nThreads = std::min(nProcsAvailable, std::max(1,nCoeff/12)); //Minimum 12 tasks per thread necessary for write-collision prevention logic below
+	std::mutex accumLock;
+	for(int pass=0; pass<2; pass++) // two non-overlapping passes
+		threadLaunch(nThreads, nAugmentGradBatch_sub<Nlm>, nCoeff, S, G, nCoeff, dGinv, nRadial, nAtoms, atpos,
+			nDensities, ccE_n, E_nRadial, E_atpos, E_RRT, nagIndex, nagIndexPtr, pass, &accumLock);
+}
+void nAugmentGradBatch(int Nlm, const vector3<int> S, const matrix3<>& G,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos,
+	int nDensities, const complex* const* ccE_n, double* E_nRadial, double* E_atpos, double* E_RRT,
+	const uint64_t* nagIndex, const size_t* nagIndexPtr)
+{	
+	SwitchTemplate_Nlm(Nlm, nAugmentGradBatch, (S, G, nCoeff, dGinv, nRadial, nAtoms, atpos, nDensities, ccE_n, E_nRadial, E_atpos, E_RRT, nagIndex, nagIndexPtr) )
+}
+
+
 //Structure factor
 void getSG_sub(size_t iStart, size_t iStop, const vector3<int> S,
 	int nAtoms, const vector3<>* atpos, double invVol, complex* SG)
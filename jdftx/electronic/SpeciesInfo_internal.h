@@ -44,6 +44,26 @@ void Vnl_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vecto
 	for(int atom=0; atom<nAtoms; atom++)
 		Vnl[atom*atomStride+n] = prefac * cis((-2*M_PI)*dot(pos[atom],kpG));
 }
+//! Compute structure factors exp(-i(k+G).pos) for several atomic positions (stored with stride nbasis between atoms)
+__hostanddev__ void structureFactor_calc(int n, int nbasis, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
+	const vector3<>* pos, complex* SF)
+{	vector3<> kpG = k + iGarr[n]; //k+G in reciprocal lattice coordinates
+	for(int atom=0; atom<nAtoms; atom++)
+		SF[atom*nbasis+n] = cis((-2*M_PI)*dot(pos[atom],kpG));
+}
+//! Compute Vnl at specific l and m for several atomic positions, using structure factors precomputed by structureFactor_calc
+template<int l, int m> __hostanddev__
+void VnlSF_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
+	const matrix3<>& G, int nbasis, const complex* SF, const RadialFunctionG& VnlRadial, complex* Vnl)
+{
+	vector3<> qvec = (k + iGarr[n]) * G; //k+G in cartesian coordinates
+	double q = qvec.length();
+	vector3<> qhat = qvec * (q ? 1.0/q : 0.0); //the unit vector along qvec (set qhat to 0 for q=0 (doesn't matter))
+	double prefac = Ylm<l,m>(qhat) * VnlRadial(q); //prefactor to structure factor
+	//Loop over columns (multiple atoms at same l,m):
+	for(int atom=0; atom<nAtoms; atom++)
+		Vnl[atom*atomStride+n] = prefac * SF[atom*nbasis+n];
+}
 //! Derivative of Vnl with respect to cartesian direction dir
 template<int l, int m> __hostanddev__
 void VnlPrime_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
@@ -103,6 +123,20 @@ void Vnl_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3
 	const vector3<>* derivDir=0, const int stressDir=-1);
 #endif
 
+//! Driver routine for structure factors of all basis functions and atoms (SF must have nbasis*nAtoms entries)
+void structureFactor(int nbasis, int nAtoms, const vector3<> k, const vector3<int>* iGarr, const vector3<>* pos, complex* SF);
+#ifdef GPU_ENABLED
+void structureFactor_gpu(int nbasis, int nAtoms, const vector3<> k, const vector3<int>* iGarr, const vector3<>* pos, complex* SF);
+#endif
+
+//! Driver routine for Vnl (values only) from structure factors precomputed by structureFactor()
+void VnlSF(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* SF, const RadialFunctionG& VnlRadial, complex* Vnl);
+#ifdef GPU_ENABLED
+void VnlSF_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const complex* SF, const RadialFunctionG& VnlRadial, complex* Vnl);
+#endif
+
 
 //! Perform the loop:
 //!   for(lm=0; lm < Nlm; lm++) (*f)(tag< lm >);
@@ -264,6 +298,23 @@ void nAugmentGrad_gpu(int Nlm, const vector3<int> S, const matrix3<>& G,
 	const uint64_t* nagIndex, const size_t* nagIndexPtr);
 #endif
 
+//! Batched version of nAugment for all atoms of a species and all density components in a single G-space sweep,
+//! with structure factors computed on the fly; nRadial contains spline coefficients for atom a and component s
+//! at offset nCoeff*Nlm*(a + nAtoms*s) and n contains nDensities output pointers (CPU only)
+void nAugmentBatch(int Nlm,
+	const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos,
+	int nDensities, complex* const* n);
+
+//! Batched version of nAugmentGrad for all atoms of a species and all density components in a single G-space sweep,
+//! with layout of nRadial and E_nRadial as in nAugmentBatch and ccE_n containing nDensities input pointers.
+//! If non-null, forces (nAtoms*3 values) and E_RRT (6 values in symmetricMatrix3 order) are accumulated directly
+//! (summed over G with the real-symmetry weights) via per-thread buffers, instead of as G-space fields (CPU only)
+void nAugmentGradBatch(int Nlm, const vector3<int> S, const matrix3<>& G,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos,
+	int nDensities, const complex* const* ccE_n, double* E_nRadial, double* E_atpos, double* E_RRT,
+	const uint64_t* nagIndex, const size_t* nagIndexPtr);
+
 
 //!Get structure factor for a specific iG, given a list of atoms
 __hostanddev__ complex getSG_calc(const vector3<int>& iG, const int& nAtoms, const vector3<>* atpos)
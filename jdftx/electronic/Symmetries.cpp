@@ -27,6 +27,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/LatticeUtils.h>
 #include <core/GridInfo.h>
 #include <core/Thread.h>
+#include <core/BlasExtra_internal.h>
 #include <fluid/Euler.h>
 
 static const int lMaxSpherical = 3;
@@ -155,15 +156,17 @@ std::vector<QuantumNumber> Symmetries::reduceKmesh(const std::vector<QuantumNumb
 //Symmetrize scalar fields:
 void Symmetries::symmetrize(ScalarField& x) const
 {	if(sym.size()==1) return; // No symmetries, nothing to do
-	complexScalarFieldTilde xTilde = J(Complex(x));
+	ScalarFieldTilde xTilde = J(x); //r2c: half the FFT work and memory of the complex path
 	symmetrize(xTilde);
-	x = Real(I(xTilde));
+	x = I(xTilde);
 }
 void Symmetries::symmetrize(ScalarFieldTilde& x) const
 {	if(sym.size()==1) return; // No symmetries, nothing to do
-	complexScalarFieldTilde xComplex = Complex(x);
-	symmetrize(xComplex);
-	x = Real(xComplex);
+	ScalarFieldTilde xSym = x->clone();
+	int nSymmClasses = symmMultHalf.nData(); //number of equivalence classes (one of each conjugate pair)
+	callPref(eblas_symmetrize_half)(nSymmClasses, sym.size(), symmIndexHalf.dataPref(), symmFlagsHalf.dataPref(),
+		symmExtraHalf.dataPref(), symmMultHalf.dataPref(), symmIndexPhaseHalf.dataPref(), xSym->dataPref());
+	x = xSym;
 }
 void Symmetries::symmetrize(complexScalarFieldTilde& x) const
 {	if(sym.size()==1) return; // No symmetries, nothing to do
@@ -534,6 +537,65 @@ void Symmetries::initSymmIndex()
 	memcpy(symmMult.data(), &symmMultVec[0], symmMultVec.size()*sizeof(int));
 	memcpy(symmIndexPhase.data(), &symmIndexPhaseVec[0], nSymmIndex*sizeof(complex));
 	memcpy(symmRotSpin.data(), &symmRotSpinVec[0], sym.size()*sizeof(matrix3<>));
+	initSymmIndexHalf(symmIndexVec, symmMultVec, symmIndexPhaseVec);
+}
+
+//Translate the full G-space index map above to the half-reduced box used by real scalar fields.
+//Each orbit O has a conjugate orbit -O whose values follow by Hermitian symmetry; only one of each such pair is retained.
+//Members of the retained orbit outside the half box are accessed via the conjugate of their negative (SymmHalfConj).
+//If O = -O, conjugate members share storage with their partners and are gathered but not scattered (SymmHalfNoScatter).
+//Otherwise, members on the iG[2]=0 and Nyquist planes have a separately stored partner in -O that must also be updated.
+void Symmetries::initSymmIndexHalf(const std::vector<int>& symmIndexVec, const std::vector<int>& symmMultVec, const std::vector<complex>& symmIndexPhaseVec)
+{	const GridInfo& gInfo = e->gInfo;
+	const vector3<int>& S = gInfo.S;
+	int n = sym.size();
+	int nClasses = symmMultVec.size();
+	//Negative, half-box location and class of each full G-space point:
+	std::vector<int> negIndex(gInfo.nr), halfIndex(gInfo.nr), classIndex(gInfo.nr);
+	std::vector<bool> isConj(gInfo.nr), isPlanar(gInfo.nr);
+	{	size_t iStart = 0, iStop = gInfo.nr;
+		THREAD_fullGspaceLoop
+		(	negIndex[i] = gInfo.fullGindex(-iG);
+			isConj[i] = (iG[2] < 0); //outside half-reduced box
+			isPlanar[i] = (iG[2]==0 || 2*iG[2]==S[2]); //independently stored in half box along with negative
+			halfIndex[i] = gInfo.halfGindex(isConj[i] ? -iG : iG);
+		)
+	}
+	for(int iClass=0; iClass<nClasses; iClass++)
+		for(int j=0; j<n; j++)
+			classIndex[symmIndexVec[n*iClass+j]] = iClass;
+	//Collect retained classes:
+	std::vector<int> indexVec, flagsVec, extraVec, multVec;
+	std::vector<complex> phaseVec;
+	indexVec.reserve(gInfo.nG); flagsVec.reserve(gInfo.nG); extraVec.reserve(gInfo.nG); phaseVec.reserve(gInfo.nG);
+	for(int iClass=0; iClass<nClasses; iClass++)
+	{	int negClass = classIndex[negIndex[symmIndexVec[n*iClass]]];
+		if(negClass < iClass) continue; //conjugate partner class already retained
+		bool selfConj = (negClass == iClass);
+		for(int j=0; j<n; j++)
+		{	int k = n*iClass + j;
+			int i2 = symmIndexVec[k];
+			int flags = isConj[i2] ? SymmHalfConj : 0;
+			if(selfConj && isConj[i2]) flags |= SymmHalfNoScatter;
+			indexVec.push_back(halfIndex[i2]);
+			flagsVec.push_back(flags);
+			extraVec.push_back((!selfConj && isPlanar[i2]) ? halfIndex[negIndex[i2]] : -1);
+			phaseVec.push_back(symmIndexPhaseVec[k]);
+		}
+		multVec.push_back(symmMultVec[iClass]);
+	}
+	//Set the final pointers (in managed cpu/gpu memory):
+	int nSymmIndex = indexVec.size();
+	symmIndexHalf.init(nSymmIndex);
+	symmFlagsHalf.init(nSymmIndex);
+	symmExtraHalf.init(nSymmIndex);
+	symmMultHalf.init(multVec.size());
+	symmIndexPhaseHalf.init(nSymmIndex);
+	memcpy(symmIndexHalf.data(), &indexVec[0], nSymmIndex*sizeof(int));
+	memcpy(symmFlagsHalf.data(), &flagsVec[0], nSymmIndex*sizeof(int));
+	memcpy(symmExtraHalf.data(), &extraVec[0], nSymmIndex*sizeof(int));
+	memcpy(symmMultHalf.data(), &multVec[0], multVec.size()*sizeof(int));
+	memcpy(symmIndexPhaseHalf.data(), &phaseVec[0], nSymmIndex*sizeof(complex));
 }
 
 void Symmetries::sortSymmetries()
@@ -92,6 +92,13 @@ private:
 	IndexArray symmMult; //multiplicity (how many times each element is repeated) in each equivalence class
 	ManagedArray<complex> symmIndexPhase; //phase factor for entry at each index
 	ManagedArray<matrix3<>> symmRotSpin; //nSym Cartesian (pseudo-vector) rotation matrices for spin-density symmetrization
+	//Equivalent index map on the half-reduced G-space box for real scalar fields (r2c layout; see eblas_symmetrize_half):
+	IndexArray symmIndexHalf; //sets of nSym consecutive half-box indices that should be averaged during symmetrization
+	IndexArray symmFlagsHalf; //conjugation / scatter flags (SymmHalfFlags) for entry at each index
+	IndexArray symmExtraHalf; //independently stored conjugate partner (iG[2]=0 and Nyquist planes) for entry at each index, or -1
+	IndexArray symmMultHalf; //multiplicity in each equivalence class
+	ManagedArray<complex> symmIndexPhaseHalf; //phase factor for entry at each index
+	void initSymmIndexHalf(const std::vector<int>& symmIndexVec, const std::vector<int>& symmMultVec, const std::vector<complex>& symmIndexPhaseVec);
 	void initSymmIndex();
 	
 	//Atom maps:
@@ -20,6 +20,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/TetrahedralDOS.h>
 #include <core/LatticeUtils.h>
 #include <core/Util.h>
+#include <core/Thread.h>
+#include <core/MPIUtil.h>
 #include <algorithm>
 #include <cfloat>
 #include <map>
@@ -61,43 +63,49 @@ nStates(nReduced*nSpins), eigs(nStates*nBands, 0.), weights(nStates*nBands*nWeig
 		for(i[2]=0; abs(i[2])<2; i[2]+=sBest[2])
 			dk[ik++] = invGT_GTsup * i;
 	}
-	//--- parallelopiped vertex indices of the 6 tetrahedra in its tesselation
-	int cellVerts[6][4] = {
-		{0, 2, 3, 7},
-		{0, 3, 1, 7},
-		{0, 1, 5, 7},
-		{0, 5, 4, 7},
-		{0, 4, 6, 7},
-		{0, 6, 2, 7} };
-	
 	//Construct Brillouin zone triangulation in an TetrahedralDOS object:
 	PeriodicLookup<vector3<>> plook(kmesh, GGT);
 	tetrahedra.resize(6*kmesh.size()); //6 tetrahedra per parallelopiped cell
+	threadLaunch(initTetrahedra_sub, kmesh.size(), &kmesh, &iReduced, &plook, dk, &GT, tetrahedra.data());
 	double Vtot = 0.;
-	for(unsigned i=0; i<kmesh.size(); i++)
-	{	const vector3<>& v0 = kmesh[i];
+	for(const Tetrahedron& t: tetrahedra)
+		Vtot += t.V;
+	double VnormFac = weightSum/Vtot;
+	for(Tetrahedron& t: tetrahedra)
+		t.V *= VnormFac; //normalize volume of tetrahedra to add up to qWeightSum/nSpins
+}
+
+//Parallelopiped vertex indices of the 6 tetrahedra in its tesselation
+static const int cellVerts[6][4] = {
+	{0, 2, 3, 7},
+	{0, 3, 1, 7},
+	{0, 1, 5, 7},
+	{0, 5, 4, 7},
+	{0, 4, 6, 7},
+	{0, 6, 2, 7} };
+
+void TetrahedralDOS::initTetrahedra_sub(size_t iStart, size_t iStop, const std::vector<vector3<>>* kmesh, const std::vector<int>* iReduced,
+	const PeriodicLookup<vector3<>>* plook, const vector3<>* dk, const matrix3<>* GT, Tetrahedron* tetrahedra)
+{	for(size_t i=iStart; i<iStop; i++)
+	{	const vector3<>& v0 = kmesh->at(i);
 		//initialize the parallelopiped vertices and look up their indices:
 		vector3<> v[8]; size_t iv[8];
 		for(int j=0; j<8; j++)
 		{	v[j] = v0 + dk[j];
-			iv[j] = plook.find(v[j]);
+			iv[j] = plook->find(v[j]);
 			assert(iv[j] != string::npos);
 		}
 		//loop over tetrahedra:
 		for(unsigned t=0; t<6; t++)
 		{	Tetrahedron& tet = tetrahedra[6*i+t];
 			for(int p=0; p<4; p++)
-				tet.q[p] = iReduced.size() ? iReduced[iv[cellVerts[t][p]]] : iv[cellVerts[t][p]];
+				tet.q[p] = iReduced->size() ? iReduced->at(iv[cellVerts[t][p]]) : iv[cellVerts[t][p]];
 			tet.V = box(
-				GT * (v[cellVerts[t][1]] - v[cellVerts[t][0]]),
-				GT * (v[cellVerts[t][2]] - v[cellVerts[t][0]]),
-				GT * (v[cellVerts[t][3]] - v[cellVerts[t][0]]) );
-			Vtot += tet.V;
+				(*GT) * (v[cellVerts[t][1]] - v[cellVerts[t][0]]),
+				(*GT) * (v[cellVerts[t][2]] - v[cellVerts[t][0]]),
+				(*GT) * (v[cellVerts[t][3]] - v[cellVerts[t][0]]) );
 		}
 	}
-	double VnormFac = weightSum/Vtot;
-	for(Tetrahedron& t: tetrahedra)
-		t.V *= VnormFac; //normalize volume of tetrahedra to add up to qWeightSum/nSpins
 }
 
 void TetrahedralDOS::setEigs(const std::vector<diagMatrix>& E)
@@ -114,30 +122,76 @@ void TetrahedralDOS::setWeights(int iWeight, const std::vector<diagMatrix>& weig
 			w(iWeight,q,b) = weights[q][b];
 }
 
+void TetrahedralDOS::bcastData(const MPIUtil* mpiUtil, int root)
+{	mpiUtil->bcastData(eigs, root);
+	mpiUtil->bcastData(weights, root);
+}
+
 
 //Replace clusters of eigenvalues that differ by less than Etol, to a single value
+struct EigIndexCmp
+{	const std::vector<double>& eigs;
+	EigIndexCmp(const std::vector<double>& eigs) : eigs(eigs) {}
+	bool operator()(size_t i1, size_t i2) const { return eigs[i1] < eigs[i2]; }
+};
 void TetrahedralDOS::weldEigenvalues(double Etol)
-{	std::multimap<double,size_t> eigMap;
-	for(size_t i=0; i<eigs.size(); i++)
-		eigMap.insert(std::make_pair(eigs[i],i));
-	for(auto i=eigMap.begin(); i!=eigMap.end();)
-	{	auto j = i;
-		double ePrev = i->first;
+{	//Sort indices by eigenvalue (flat array, rather than a node-based map, for large k-meshes):
+	std::vector<size_t> order(eigs.size());
+	for(size_t i=0; i<order.size(); i++) order[i] = i;
+	std::sort(order.begin(), order.end(), EigIndexCmp(eigs));
+	for(size_t i=0; i<order.size();)
+	{	size_t j = i;
+		double ePrev = eigs[order[i]];
 		j++;
-		while(j!=eigMap.end() && (j->first <= ePrev+Etol)) //Stop when j'th eig differs by more than Etol from previous one
-		{	ePrev = j->first;
+		while(j<order.size() && (eigs[order[j]] <= ePrev+Etol)) //Stop when j'th eig differs by more than Etol from previous one
+		{	ePrev = eigs[order[j]];
 			j++;
 		}
 		//Replace cluster [i,j) by its mean:
-		double eMean=0.; size_t eCount=0;
-		for(auto k=i; k!=j; k++) { eMean += k->first; eCount++; }
-		eMean /= eCount;
-		for(auto k=i; k!=j; k++) eigs[k->second] = eMean;
-		//Move iterator past end of cluster:
+		double eMean=0.;
+		for(size_t k=i; k<j; k++) eMean += eigs[order[k]];
+		eMean /= (j-i);
+		for(size_t k=i; k<j; k++) eigs[order[k]] = eMean;
+		//Move past end of cluster:
 		i = j;
 	}
 }
 
+static bool LsplineCmp(const TetrahedralDOS::LsplineElem& l1, const TetrahedralDOS::LsplineElem& l2) { return l1.first < l2.first; }
+
+//Gaussian smoothing for output energies iEstart to iEstop (thread function for gaussSmooth); each thread
+//handles a contiguous range of output energies and only the input intervals that overlap it (no write conflicts)
+void gaussSmooth_sub(size_t iEstart, size_t iEstop, const TetrahedralDOS::Lspline* inPtr, double Esigma, int nWeights, TetrahedralDOS::Lspline* outPtr)
+{	const TetrahedralDOS::Lspline& in = *inPtr;
+	TetrahedralDOS::Lspline& out = *outPtr;
+	if(iEstart >= iEstop) return;
+	const double EsigmaDen = 1./(Esigma*sqrt(2.));
+	double dE = 0.2*Esigma;
+	double Emin = out.front().first;
+	//Range of input intervals overlapping this block of output energies:
+	TetrahedralDOS::LsplineElem eLo(out[iEstart].first - 10*Esigma, std::vector<double>());
+	TetrahedralDOS::LsplineElem eHi(out[iEstop-1].first + 10*Esigma, std::vector<double>());
+	size_t iInStart = std::lower_bound(in.begin(), in.end(), eLo, LsplineCmp) - in.begin();
+	if(iInStart) iInStart--;
+	size_t iInStop = std::upper_bound(in.begin(), in.end(), eHi, LsplineCmp) - in.begin();
+	for(size_t iIn=iInStart; iIn+1<std::min(iInStop+1, in.size()); iIn++)
+	{	const double& E0 = in[ iIn ].first; const std::vector<double>& w0 = in[ iIn ].second;
+		const double& E1 = in[iIn+1].first; const std::vector<double>& w1 = in[iIn+1].second;
+		if(E1==E0) continue;
+		size_t iEintStart = std::max(floor((E0-10*Esigma-Emin)/dE), double(iEstart));
+		size_t iEintStop = std::min(ceil((E1+10*Esigma-Emin)/dE), double(iEstop));
+		for(size_t iE=iEintStart; iE<iEintStop; iE++)
+		{	double E = out[iE].first;
+			double e0 = (E-E0)*EsigmaDen;
+			double e1 = (E1-E)*EsigmaDen;
+			double gaussTerm = (exp(-e0*e0) - exp(-e1*e1)) / (2*sqrt(M_PI) * (e0 + e1));
+			double erfTerm = (erf(e0) + erf(e1)) / (2 * (e0 + e1));
+			for(int iW=0; iW<nWeights; iW++)
+				out[iE].second[iW] += gaussTerm*(w1[iW] - w0[iW]) + erfTerm*(e0*w1[iW] + e1*w0[iW]);
+		}
+	}
+}
+
 //Apply gaussian smoothing of width Esigma
 TetrahedralDOS::Lspline TetrahedralDOS::gaussSmooth(const Lspline& in, double Esigma) const
 {	assert(Esigma > 0.);
@@ -153,23 +207,7 @@ TetrahedralDOS::Lspline TetrahedralDOS::gaussSmooth(const Lspline& in, double Es
 	Lspline out(nE, std::make_pair(0., std::vector<double>(nWeights, 0.)));
 	for(size_t iE=0; iE<nE; iE++) out[iE].first = Emin + iE*dE;
 	//Apply the gaussian smoothing to each channel:
-	const double EsigmaDen = 1./(Esigma*sqrt(2.));
-	for(size_t iIn=0; iIn+1<in.size(); iIn++)
-	{	const double& E0 = in[ iIn ].first; const std::vector<double>& w0 = in[ iIn ].second;
-		const double& E1 = in[iIn+1].first; const std::vector<double>& w1 = in[iIn+1].second;
-		if(E1==E0) continue;
-		size_t iEstart = std::max(floor((E0-10*Esigma-Emin)/dE), 0.);
-		size_t iEstop = std::min(ceil((E1+10*Esigma-Emin)/dE), double(nE));
-		for(size_t iE=iEstart; iE<iEstop; iE++)
-		{	double E = out[iE].first;
-			double e0 = (E-E0)*EsigmaDen;
-			double e1 = (E1-E)*EsigmaDen;
-			double gaussTerm = (exp(-e0*e0) - exp(-e1*e1)) / (2*sqrt(M_PI) * (e0 + e1));
-			double erfTerm = (erf(e0) + erf(e1)) / (2 * (e0 + e1));
-			for(int iW=0; iW<nWeights; iW++)
-				out[iE].second[iW] += gaussTerm*(w1[iW] - w0[iW]) + erfTerm*(e0*w1[iW] + e1*w0[iW]);
-		}
-	}
+	threadLaunch(gaussSmooth_sub, nE, &in, Esigma, nWeights, &out);
 	return out;
 }
 
@@ -399,8 +437,6 @@ void TetrahedralDOS::coalesceIntervals(Cspline& cspline) const
 	cspline.deltas.clear(); //deltas incorporated in above
 }
 
-static bool LsplineCmp(const TetrahedralDOS::LsplineElem& l1, const TetrahedralDOS::LsplineElem& l2) { return l1.first < l2.first; }
-
 //Convert cubic splines to integrated linear splines which handle discontinuities and singularities better:
 //The Cspline object must be coalesced before passing to this function
 TetrahedralDOS::Lspline TetrahedralDOS::convertLspline(const Cspline& cspline) const
@@ -510,25 +546,76 @@ TetrahedralDOS::Lspline TetrahedralDOS::mergeLsplines(const std::vector<Lspline>
 	return combined;
 }
 
-//Generate the density of states for a given state offset:
-TetrahedralDOS::Lspline TetrahedralDOS::getDOS(int iSpin, double Etol) const
-{	std::vector<Lspline> lsplines(nBands);
-	for(int iBand=0; iBand<nBands; iBand++)
-	{	Cspline wdos;
-		for(const Tetrahedron& t: tetrahedra)
-			accumTetrahedron(t, iBand, iSpin, wdos);
+//Compute the linear-spline DOS of a range of bands:
+void TetrahedralDOS::getDOS_sub(size_t iStart, size_t iStop, const TetrahedralDOS* td, int iSpin, double Etol, int bandStart, std::vector<Lspline>* lsplines)
+{	int nWeights = td->nWeights;
+	for(size_t iBandMine=iStart; iBandMine<iStop; iBandMine++)
+	{	int iBand = bandStart + iBandMine;
+		Lspline& lspline = lsplines->at(iBand);
+		Cspline wdos;
+		for(const Tetrahedron& t: td->tetrahedra)
+			td->accumTetrahedron(t, iBand, iSpin, wdos);
 		if(wdos.size()==0 && wdos.deltas.size()==1) // band is a single delta function
 		{	double eDelta = wdos.deltas.begin()->first;
 			const std::vector<double>& wDelta = wdos.deltas.begin()->second;
-			lsplines[iBand].resize(3, std::make_pair(eDelta, std::vector<double>(nWeights, 0.)));
-			lsplines[iBand][0].first = eDelta-0.5*Etol;
-			lsplines[iBand][2].first = eDelta+0.5*Etol;
+			lspline.resize(3, std::make_pair(eDelta, std::vector<double>(nWeights, 0.)));
+			lspline[0].first = eDelta-0.5*Etol;
+			lspline[2].first = eDelta+0.5*Etol;
 			for(int i=0; i<nWeights; i++)
-				lsplines[iBand][1].second[i] = wDelta[i] * (2./Etol);
+				lspline[1].second[i] = wDelta[i] * (2./Etol);
+		}
+		else
+		{	td->coalesceIntervals(wdos);
+			lspline = td->convertLspline(wdos);
+		}
+	}
+}
+
+//Generate the density of states for a given state offset:
+TetrahedralDOS::Lspline TetrahedralDOS::getDOS(int iSpin, double Etol, const MPIUtil* mpiUtil) const
+{	std::vector<Lspline> lsplines(nBands);
+	//Divide bands over processes (if any) and threads:
+	int bandStart = 0, bandStop = nBands;
+	bool distributed = mpiUtil && (mpiUtil->nProcesses() > 1);
+	TaskDivision bandDiv;
+	if(distributed)
+	{	bandDiv.init(nBands, mpiUtil);
+		bandDiv.myRange(bandStart, bandStop);
+	}
+	threadLaunch(getDOS_sub, bandStop-bandStart, this, iSpin, Etol, bandStart, &lsplines);
+	//Collect band splines on head:
+	if(distributed)
+	{	const int nCols = 1 + nWeights; //energy and weights per spline node
+		if(mpiUtil->isHead())
+		{	for(int jProc=1; jProc<mpiUtil->nProcesses(); jProc++)
+				for(size_t iBand=bandDiv.start(jProc); iBand<bandDiv.stop(jProc); iBand++)
+				{	size_t nNodes = 0;
+					mpiUtil->recv(nNodes, jProc, 0);
+					std::vector<double> buf(nNodes*nCols);
+					mpiUtil->recvData(buf, jProc, 1);
+					Lspline& lspline = lsplines[iBand];
+					lspline.resize(nNodes);
+					const double* bufPtr = buf.data();
+					for(LsplineElem& node: lspline)
+					{	node.first = *(bufPtr++);
+						node.second.assign(bufPtr, bufPtr+nWeights);
+						bufPtr += nWeights;
+					}
+				}
 		}
 		else
-		{	coalesceIntervals(wdos);
-			lsplines[iBand] = convertLspline(wdos);
+		{	for(int iBand=bandStart; iBand<bandStop; iBand++)
+			{	const Lspline& lspline = lsplines[iBand];
+				size_t nNodes = lspline.size();
+				std::vector<double> buf; buf.reserve(nNodes*nCols);
+				for(const LsplineElem& node: lspline)
+				{	buf.push_back(node.first);
+					buf.insert(buf.end(), node.second.begin(), node.second.end());
+				}
+				mpiUtil->send(nNodes, 0, 0);
+				mpiUtil->sendData(buf, 0, 1);
+			}
+			return Lspline();
 		}
 	}
 	return mergeLsplines(lsplines);
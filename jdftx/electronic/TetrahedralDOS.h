@@ -25,7 +25,10 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <vector>
 #include <array>
 
-//! Evaluate DOS using the tetrahedron method
+template<typename T> class PeriodicLookup;
+class MPIUtil;
+
+//! Evaluate DOS using the tetrahedron method (threaded over k-mesh cells, bands and output energies)
 class TetrahedralDOS
 {
 public:
@@ -52,6 +55,7 @@ public:
 	
 	void setEigs(const std::vector<diagMatrix>& E); //!< set all eigenvalues together (instead of using e())
 	void setWeights(int iWeight, const std::vector<diagMatrix>& weights); //!< set all weights for given iWeight together (instead of using e()); all weights are initially 1
+	void bcastData(const MPIUtil* mpiUtil, int root=0); //!< broadcast all eigenvalues and weights from root (eg. before a distributed getDOS)
 	
 	//! Replace clusters of eigenvalues that differ by less than Etol by a single value equal to their mean
 	void weldEigenvalues(double Etol);
@@ -61,7 +65,9 @@ public:
 
 	//! Generate the density of states for a given spin channel
 	//! Etol sets the width of the delta-function DOS of bands that are completely flat (potentially welded within Etol)
-	Lspline getDOS(int iSpin, double Etol) const;
+	//! If mpiUtil is specified, bands are divided over its processes (which must all have the same eigenvalues and weights),
+	//! and the result is available only on its head process (empty elsewhere); this call is then collective
+	Lspline getDOS(int iSpin, double Etol, const MPIUtil* mpiUtil=0) const;
 
 	//! Apply gaussian smoothing of width Esigma
 	Lspline gaussSmooth(const Lspline& in, double Esigma) const;
@@ -80,6 +86,13 @@ private:
 	std::vector<double> weights; //flat array of DOS weights (inner index weight function, middle index state, and outer index bands)
 	
 	
+	//! Initialize tetrahedra for k-mesh cells iStart to iStop (thread function for constructor)
+	static void initTetrahedra_sub(size_t iStart, size_t iStop, const std::vector<vector3<>>* kmesh, const std::vector<int>* iReduced,
+		const PeriodicLookup<vector3<>>* plook, const vector3<>* dk, const matrix3<>* GT, Tetrahedron* tetrahedra);
+	
+	//! Compute linear spline DOS of bands bandStart+iStart to bandStart+iStop into lsplines (thread function for getDOS)
+	static void getDOS_sub(size_t iStart, size_t iStop, const TetrahedralDOS* td, int iSpin, double Etol, int bandStart, std::vector<Lspline>* lsplines);
+	
 	//! Accumulate contribution from one tetrahedron (exactly a cubic spline for linear interpolation)
 	//! to the weighted DOS for all weight functions (from a single band)
 	void accumTetrahedron(const Tetrahedron& t, int iBand, int iSpin, struct Cspline& wdos) const;
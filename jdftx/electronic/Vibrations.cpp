@@ -20,16 +20,35 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Vibrations.h>
 #include <electronic/IonicMinimizer.h>
 #include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
 #include <core/LatticeUtils.h>
 #include <core/Units.h>
 
 Vibrations::Vibrations() : dr(0.01), centralDiff(false), useConstraints(false),
-translationSym(true), rotationSym(false), omegaMin(2e-4), T(298*Kelvin), omegaResolution(1e-4)
+translationSym(true), rotationSym(false), omegaMin(2e-4), T(298*Kelvin), omegaResolution(1e-4), nGroups(1), mpiWorldFull(0)
 {
 }
 
+void Vibrations::divideProcesses()
+{	int nGroupsActual = std::min(nGroups ? nGroups : mpiWorld->nProcesses(), mpiWorld->nProcesses());
+	if(nGroupsActual <= 1) return;
+	logPrintf("Vibrations: dividing %d processes into %d groups for concurrent displaced configurations.\n",
+		mpiWorld->nProcesses(), nGroupsActual);
+	mpiWorldFull = mpiWorld;
+	mpiWorld = new MPIUtil(0,0, MPIUtil::ProcDivision(mpiWorldFull, nGroupsActual));
+}
+
+void Vibrations::mergeProcesses()
+{	if(!mpiWorldFull) return;
+	delete mpiWorld;
+	mpiWorld = mpiWorldFull;
+	mpiWorldFull = 0;
+}
+
 void Vibrations::setup(Everything* e)
 {	this->e = e;
+	if(mpiWorldFull && mpiWorld->procDivision.iGroup)
+		e->dump.clear(); //only group 0 writes output files (all groups end in the same state)
 	//Perform any compatibility checks here (so that dry runs will pick these up)
 	if((translationSym || rotationSym) && useConstraints)
 	{	logPrintf("WARNING: Vibrations: switching off translationSym and rotationSym since useConstraints is on.");
@@ -168,21 +187,40 @@ void Vibrations::calculate()
 	vector3<> Pel0 = getPel(); //electronic dipole moment
 	logPrintf("Completed %d of %d configurations.\n", ++iConfiguration, nConfigurations);
 	
-	//Compute force matrix:
-	matrix K = zeroes(nModes, nModes);
-	matrix dP = zeroes(nModes, 3); //dipole derivative
-	{	diagMatrix mult(nModes, 0.); //multiplicity in entries due to symmetrization
-		IonicGradient dPrev; dPrev.init(e->iInfo); //previous displacement (initially zero)
-		complex *Kdata = K.data(), *dPdata = dP.data();
-		for(const Mode& mode: modes) if(mode.isPrimary) //Loop over modes in irredicuble wedge
-		{	//Create ionic gradient object corresponding to mode:
+	//Compute force and dipole derivatives for each mode in irreducible wedge:
+	std::vector<const Mode*> primaryModes;
+	for(const Mode& mode: modes) if(mode.isPrimary) primaryModes.push_back(&mode);
+	std::vector<IonicGradient> KcurArr(nPrimary); //force derivative for each primary mode
+	std::vector<vector3<>> dPcurArr(nPrimary); //dipole derivative for each primary mode
+	for(IonicGradient& Kcur: KcurArr) Kcur.init(e->iInfo);
+	std::vector<int> primaryGroup(nPrimary, 0); //process group that computed each primary mode
+	std::shared_ptr<TaskQueue> queue; //dynamic distribution of primary modes to process groups (if any)
+	std::vector<ColumnBundle> C0; //undisplaced wavefunctions from which each displacement starts (when grouped)
+	if(mpiWorldFull)
+	{	logPrintf("Computing displaced configurations in %d process groups (output below from group 0 alone).\n", mpiWorld->procDivision.nGroups);
+		queue = std::make_shared<TaskQueue>(mpiWorldFull);
+		C0 = e->eVars.C;
+	}
+	{	IonicGradient dPrev; dPrev.init(e->iInfo); //previous displacement (initially zero)
+		IonicGradient dZero; dZero.init(e->iInfo);
+		for(int iPrimarySeq=0; ; iPrimarySeq++)
+		{	int iPrimary = queue ? queue->next(mpiWorld) : iPrimarySeq;
+			if(iPrimary >= nPrimary) break;
+			const Mode& mode = *(primaryModes[iPrimary]);
+			if(queue && iPrimarySeq) //restore undisplaced configuration and wavefunctions
+			{	imin.step(dZero-dPrev, dr); dPrev=dZero;
+				e->eVars.C = C0;
+			}
+			//Create ionic gradient object corresponding to mode:
 			IonicGradient d; d.init(e->iInfo);
 			d[mode.s][mode.a] = mode.n; //all others zero
 			//Compute forces at perturbed position:
-			IonicGradient gradPlus, gradMinus, Kcur;
+			IonicGradient gradPlus, gradMinus;
+			IonicGradient& Kcur = KcurArr[iPrimary];
+			vector3<>& dPcur = dPcurArr[iPrimary];
 			imin.step(d-dPrev, dr); dPrev=d;
 			imin.compute(&gradPlus, 0);
-			vector3<> PelPlus = getPel(), PelMinus, dPcur; //electronic dipole moment and derivative w.r.t mode
+			vector3<> PelPlus = getPel(), PelMinus; //electronic dipole moment
 			logPrintf("Completed %d of %d configurations.\n", ++iConfiguration, nConfigurations);
 	
 			if(centralDiff)
@@ -199,6 +237,44 @@ void Vibrations::calculate()
 				dPcur = (PelPlus - Pel0) * (1./dr);
 			}
 			dPcur -= species[mode.s]->Z * mode.n; //ionic contribution to dipole derivative
+			if(queue) primaryGroup[iPrimary] = mpiWorld->procDivision.iGroup;
+		}
+		imin.step(dZero-dPrev, dr); dPrev=dZero; //Restore original ionic positions
+		if(queue) e->eVars.C = C0;
+	}
+	if(queue)
+	{	//Collect derivatives from all groups (only from group heads, since results are replicated within each group):
+		std::vector<double> buf;
+		for(int iPrimary=0; iPrimary<nPrimary; iPrimary++)
+		{	for(const std::vector<vector3<>>& KcurSp: KcurArr[iPrimary])
+				for(const vector3<>& v: KcurSp)
+					buf.insert(buf.end(), &v[0], &v[0]+3);
+			buf.insert(buf.end(), &dPcurArr[iPrimary][0], &dPcurArr[iPrimary][0]+3);
+		}
+		if(!mpiWorld->isHead()) { std::fill(buf.begin(), buf.end(), 0.); primaryGroup.assign(nPrimary, -1); }
+		mpiWorldFull->allReduceData(buf, MPIUtil::ReduceSum);
+		mpiWorldFull->allReduceData(primaryGroup, MPIUtil::ReduceMax);
+		const double* bufPtr = buf.data();
+		for(int iPrimary=0; iPrimary<nPrimary; iPrimary++)
+		{	for(std::vector<vector3<>>& KcurSp: KcurArr[iPrimary])
+				for(vector3<>& v: KcurSp)
+					for(int k=0; k<3; k++) v[k] = *(bufPtr++);
+			for(int k=0; k<3; k++) dPcurArr[iPrimary][k] = *(bufPtr++);
+		}
+		for(int iPrimary=0; iPrimary<nPrimary; iPrimary++)
+			logPrintf("\tMode: %d  species: %s  atom: %d  processed by group: %d\n", iPrimary+1,
+				species[primaryModes[iPrimary]->s]->name.c_str(), primaryModes[iPrimary]->a+1, primaryGroup[iPrimary]);
+	}
+	
+	//Compute force matrix:
+	matrix K = zeroes(nModes, nModes);
+	matrix dP = zeroes(nModes, 3); //dipole derivative
+	{	diagMatrix mult(nModes, 0.); //multiplicity in entries due to symmetrization
+		complex *Kdata = K.data(), *dPdata = dP.data();
+		for(int iPrimary=0; iPrimary<nPrimary; iPrimary++) //Loop over modes in irredicuble wedge
+		{	const Mode& mode = *(primaryModes[iPrimary]);
+			const IonicGradient& Kcur = KcurArr[iPrimary];
+			const vector3<>& dPcur = dPcurArr[iPrimary];
 			
 			//Collect contributions to force matrix from this mode and its symmetric counterparts:
 			for(unsigned iRot=0; iRot<sym.size(); iRot++)
@@ -225,9 +301,6 @@ void Vibrations::calculate()
 					}
 			}
 		}
-		IonicGradient d; d.init(e->iInfo); //all zeroes
-		imin.step(d-dPrev, dr); dPrev=d; //Restore original ionic positions
-		
 		//Invert multiplicity matrixZero out  modes to be set by translational symmetry:
 		for(int i=0; i<nModes; i++)
 			mult[i] = modes[i].fromTranslation ? 0. : 1./mult[i];
@@ -39,13 +39,17 @@ public:
 	double omegaMin; //!< frequency cutoff for free energy calculation and detailed mode print out
 	double T; //!< ionic temperature used for entropy and free energy estimation
 	double omegaResolution; //!< frequency resolution used for identifying and reporting degeneracies
+	int nGroups; //!< number of process groups computing displaced configurations concurrently (1 => sequential, 0 => one per process)
 	
 	Vibrations();
+	void divideProcesses(); //!< divide mpiWorld into nGroups groups (must be called before Everything::setup, which distributes data over mpiWorld)
+	void mergeProcesses(); //!< restore the undivided mpiWorld (after all calculations and dumps are complete)
 	void setup(Everything* e);
 	void calculate();
 	
 private:
 	Everything* e;
+	MPIUtil* mpiWorldFull; //!< undivided mpiWorld while process groups are active (null otherwise)
 	vector3<> getSplit() const; //get optimum latttice coordinates for splitting periodicity in a molecular geometry
 	struct IonicGradient getCMcoords() const; //get cartesian coordinates of all atoms relative to molecule center of mass
 	VectorField Ptest; //vector field that measures dipole moment in lattice coordinates
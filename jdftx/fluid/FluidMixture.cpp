@@ -225,11 +225,14 @@ void FluidMixture::initState(double scale, double Elo, double Ehi)
 
 void FluidMixture::loadState(const char* filename)
 {	nullToZero(state, gInfo, get_nIndep());
-	loadFromFile(state, filename);
+	if(CheckpointFile::isCheckpoint(filename)) loadCheckpoint(state, filename);
+	else loadFromFile(state, filename);
 }
 
-void FluidMixture::saveState(const char* filename) const
-{	if(mpiWorld->isHead()) saveToFile(state, filename);
+void FluidMixture::saveState(const char* filename, const CheckpointOptions* checkpoint) const
+{	if(!mpiWorld->isHead()) return;
+	if(checkpoint && checkpoint->enabled) saveCheckpoint(state, filename, *checkpoint);
+	else saveToFile(state, filename);
 }
 
 FluidMixture::Outputs::Outputs(ScalarFieldArray* N, vector3<>* electricP,
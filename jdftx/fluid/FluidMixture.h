@@ -25,6 +25,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Units.h>
 #include <core/Minimize.h>
 #include <core/EnergyComponents.h>
+#include <core/Checkpoint.h>
 
 //! @addtogroup ClassicalDFT
 //! @{
@@ -73,11 +74,11 @@ public:
 	//! @param Ehi Upper cap on the individiual molecule energy configurations used in the estimate
 	void initState(double scale = 0.0, double Elo=-DBL_MAX, double Ehi=+DBL_MAX);
 
-	//! Load the state from a single binary file
+	//! Load the state from a single binary file (legacy raw binary or checkpoint container)
 	void loadState(const char* filename);
 
-	//! Save the state to a single binary file
-	void saveState(const char* filename) const;
+	//! Save the state to a single binary file (as a checkpoint container if enabled in checkpoint)
+	void saveState(const char* filename, const CheckpointOptions* checkpoint=0) const;
 
 	//! Optional outputs for operator() and getFreeEnergy(), retrieve results for all non-null pointers
 	struct Outputs
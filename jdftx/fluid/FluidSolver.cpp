@@ -160,7 +160,7 @@ public:
 	}
 
 	void saveState(const char* filename) const
-	{	fluidMixture->saveState(filename);
+	{	fluidMixture->saveState(filename, &e.dump.checkpoint);
 	}
 
 	void dumpDensities(const char* filenamePattern) const
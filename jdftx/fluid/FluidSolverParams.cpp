@@ -26,7 +26,8 @@ FluidSolverParams::FluidSolverParams()
 components(components_), solvents(solvents_), cations(cations_), anions(anions_),
 vdwScale(0.75), pCavity(0.), lMax(3), cavityScale(1.), ionSpacing(0.),
 zMask0(0.), zMaskH(0.), zMaskIonH(0.), zMaskSigma(0.5),
-linearDielectric(false), linearScreening(false), nonlinearSCF(false), screenOverride(0.)
+linearDielectric(false), linearScreening(false), nonlinearSCF(false), screenOverride(0.),
+mgLevels(1), mgSmooth(2)
 {
 }
 
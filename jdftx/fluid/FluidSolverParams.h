@@ -153,6 +153,10 @@ struct FluidSolverParams
 	double screenOverride; //! overrides screening factor with this value
 	PulayParams scfParams; //!< parameters controlling Pulay mixing for SCF version of nonlinear PCM
 	
+	//Multigrid preconditioner for linear(ized) PCM and SaLSA solves:
+	int mgLevels; //!< number of grid levels (1 disables multigrid in favor of the bulk-dielectric G-space preconditioner)
+	int mgSmooth; //!< number of pre- and post-smoothing steps per level
+	
 	//For Explicit Fluid JDFT alone:
 	ExCorr exCorr; //!< Fluid exchange-correlation and kinetic energy functional
         std::vector<FmixParams> FmixList; //!< Tabulates which components interact through an additional Fmix
@@ -20,6 +20,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Everything.h>
 #include <fluid/LinearPCM.h>
 #include <fluid/PCM_internal.h>
+#include <fluid/PCMmultigrid.h>
 #include <core/VectorField.h>
 #include <core/ScalarFieldIO.h>
 #include <core/Thread.h>
@@ -28,6 +29,12 @@ LinearPCM::LinearPCM(const Everything& e, const FluidSolverParams& fsp)
 : PCM(e, fsp)
 {
 	assert(!useGummel()); //Non-variational energy: cannot use Gummel loop!
+	if(fsp.mgLevels > 1)
+	{	if(fsp.epsBulkTensor.length_squared())
+			logPrintf("NOTE: multigrid preconditioner not supported for anisotropic dielectrics; using bulk-dielectric preconditioner.\n");
+		else
+			multigrid = std::make_shared<PCMmultigrid>(gInfo, fsp.mgLevels, fsp.mgSmooth);
+	}
 }
 
 LinearPCM::~LinearPCM()
@@ -54,7 +61,8 @@ ScalarFieldTilde LinearPCM::hessian(const ScalarFieldTilde& phiTilde) const
 }
 
 ScalarFieldTilde LinearPCM::precondition(const ScalarFieldTilde& rTilde) const
-{	return Kkernel*(J(epsInv*I(Kkernel*rTilde)));
+{	if(multigrid) return (*multigrid)(rTilde);
+	return Kkernel*(J(epsInv*I(Kkernel*rTilde)));
 }
 
 //Initialize Kkernel to square-root of the inverse kinetic operator
@@ -84,6 +92,7 @@ void LinearPCM::updatePreconditioner(const ScalarField& epsilon, const ScalarFie
 	double epsMean = sum(epsilon) / gInfo.nr;
 	double kappaSqMean = (kappaSq ? sum(kappaSq) : 0.) / gInfo.nr;
 	Kkernel.init(0, 0.02, gInfo.GmaxGrid, setPreconditionerKernel, epsMean, sqrt(kappaSqMean/epsMean));
+	if(multigrid) multigrid->update(epsilon, kappaSq);
 }
 
 void LinearPCM::override(const ScalarField& epsilon, const ScalarField& kappaSq)
@@ -171,13 +180,16 @@ void LinearPCM::getSusceptibility_internal(const std::vector<complex>& omega, st
 }
 
 void LinearPCM::loadState(const char* filename)
-{	ScalarField Istate(ScalarFieldData::alloc(gInfo));
-	loadRawBinary(Istate, filename); //saved data is in real space
-	state = J(Istate);
+{	ScalarFieldArray Istate(1); nullToZero(Istate, gInfo);
+	if(CheckpointFile::isCheckpoint(filename)) loadCheckpoint(Istate, filename);
+	else loadRawBinary(Istate[0], filename); //saved data is in real space
+	state = J(Istate[0]);
 }
 
 void LinearPCM::saveState(const char* filename) const
-{	if(mpiWorld->isHead()) saveRawBinary(I(state), filename); //saved data is in real space
+{	if(!mpiWorld->isHead()) return;
+	if(e.dump.checkpoint.enabled) saveCheckpoint(ScalarFieldArray(1, I(state)), filename, e.dump.checkpoint);
+	else saveRawBinary(I(state), filename); //saved data is in real space
 }
 
 void LinearPCM::dumpDensities(const char* filenamePattern) const
@@ -48,6 +48,7 @@ protected:
 	void getSusceptibility_internal(const std::vector<complex>& omega, std::vector<SusceptibilityTerm>& susceptibility, ScalarFieldArray& sArr, bool elecOnly) const;
 private:
 	RadialFunctionG Kkernel; ScalarField epsInv; // for preconditioner
+	std::shared_ptr<class PCMmultigrid> multigrid; //optional multigrid preconditioner (replaces the above when present)
 	void updatePreconditioner(const ScalarField& epsilon, const ScalarField& kappaSq);
 	
 	//Optionally override epsilon and kappaSq (when used as the inner solver in NonlinearPCM's SCF):
@@ -283,11 +283,14 @@ void NonlinearPCM::minimizeFluid()
 
 void NonlinearPCM::loadState(const char* filename)
 {	nullToZero(state, gInfo);
-	state.loadFromFile(filename);
+	if(CheckpointFile::isCheckpoint(filename)) loadCheckpoint(state.component, filename);
+	else state.loadFromFile(filename);
 }
 
 void NonlinearPCM::saveState(const char* filename) const
-{	if(mpiWorld->isHead()) state.saveToFile(filename);
+{	if(!mpiWorld->isHead()) return;
+	if(e.dump.checkpoint.enabled) saveCheckpoint(state.component, filename, e.dump.checkpoint);
+	else state.saveToFile(filename);
 }
 
 double NonlinearPCM::get_Adiel_and_grad_internal(ScalarFieldTilde& Adiel_rhoExplicitTilde, ScalarFieldTilde& Adiel_nCavityTilde, IonicGradient* extraForces, matrix3<>* Adiel_RRT) const
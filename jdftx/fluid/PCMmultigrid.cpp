@@ -0,0 +1,167 @@
+/*-------------------------------------------------------------------
+Copyright 2026 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <fluid/PCMmultigrid.h>
+#include <core/VectorField.h>
+#include <core/Operators.h>
+#include <core/Util.h>
+
+static const int minGridSize = 8; //smallest grid dimension allowed on the coarsest level
+static const int nCoarseFactor = 4; //coarsest level uses this many times more smoothing steps
+static const int nPowerIterations = 8; //power iterations for estimating the smoother damping
+
+PCMmultigrid::PCMmultigrid(const GridInfo& gInfo, int nLevels, int nSmooth) : nSmooth(nSmooth)
+{	Level fine;
+	fine.gInfo = &gInfo;
+	fine.omega = 1.;
+	levels.push_back(fine);
+	//Halve grid dimensions as long as possible:
+	while(int(levels.size()) < nLevels)
+	{	const vector3<int>& Sfine = levels.back().gInfo->S;
+		bool canCoarsen = true;
+		for(int k=0; k<3; k++)
+			if(Sfine[k]%2 || Sfine[k]/2 < minGridSize)
+				canCoarsen = false;
+		if(!canCoarsen) break;
+		Level level;
+		level.gInfoCoarse = std::make_shared<GridInfo>();
+		level.gInfoCoarse->R = gInfo.R;
+		for(int k=0; k<3; k++) level.gInfoCoarse->S[k] = Sfine[k]/2;
+		logSuspend(); level.gInfoCoarse->initialize(true); logResume();
+		level.gInfo = level.gInfoCoarse.get();
+		level.omega = 1.;
+		levels.push_back(level);
+	}
+	const vector3<int>& Scoarse = levels.back().gInfo->S;
+	logPrintf("Initialized %d-level multigrid preconditioner for PCM electrostatics (coarsest grid: %d x %d x %d).\n",
+		int(levels.size()), Scoarse[0], Scoarse[1], Scoarse[2]);
+	if(int(levels.size()) < nLevels)
+		logPrintf("\tNOTE: grid dimensions limit the multigrid hierarchy to %d of the %d requested levels.\n", int(levels.size()), nLevels);
+}
+
+PCMmultigrid::~PCMmultigrid()
+{	for(Level& level: levels)
+		if(level.Kkernel) level.Kkernel.free();
+}
+
+//Full-weighting restriction of a coefficient field to a grid with half the samples along each direction
+//(unlike Fourier truncation, this preserves positivity of the dielectric function and screening)
+inline ScalarField restrictCoefficient(const ScalarField& x, const GridInfo& gInfoCoarse)
+{	const GridInfo& gInfo = x->gInfo;
+	ScalarField xCoarse(ScalarFieldData::alloc(gInfoCoarse));
+	const double* xData = x->data();
+	double* xCoarseData = xCoarse->data();
+	const double w[3] = { 0.25, 0.5, 0.25 }; //1D stencil weights
+	vector3<int> iv, di, ivFine;
+	for(iv[0]=0; iv[0]<gInfoCoarse.S[0]; iv[0]++)
+	for(iv[1]=0; iv[1]<gInfoCoarse.S[1]; iv[1]++)
+	for(iv[2]=0; iv[2]<gInfoCoarse.S[2]; iv[2]++)
+	{	double result = 0.;
+		for(di[0]=-1; di[0]<=1; di[0]++)
+		for(di[1]=-1; di[1]<=1; di[1]++)
+		for(di[2]=-1; di[2]<=1; di[2]++)
+		{	for(int k=0; k<3; k++)
+				ivFine[k] = (2*iv[k] + di[k] + gInfo.S[k]) % gInfo.S[k]; //periodic wrap
+			result += w[di[0]+1] * w[di[1]+1] * w[di[2]+1] * xData[gInfo.fullRindex(ivFine)];
+		}
+		xCoarseData[gInfoCoarse.fullRindex(iv)] = result;
+	}
+	return xCoarse;
+}
+
+//Square-root of the inverse bulk kinetic operator (without the dielectric constant)
+inline double setMultigridKernel(double G, double kRMS)
+{	return (G || kRMS) ? 1./hypot(G, kRMS) : 0.;
+}
+
+void PCMmultigrid::update(const ScalarField& epsilon, const ScalarField& kappaSq)
+{	for(int iLevel=0; iLevel<int(levels.size()); iLevel++)
+	{	Level& level = levels[iLevel];
+		if(iLevel == 0)
+		{	level.epsilon = epsilon;
+			level.kappaSq = kappaSq;
+		}
+		else
+		{	const Level& finer = levels[iLevel-1];
+			level.epsilon = restrictCoefficient(finer.epsilon, *level.gInfo);
+			level.kappaSq = finer.kappaSq ? restrictCoefficient(finer.kappaSq, *level.gInfo) : ScalarField();
+		}
+		level.epsInv = inv(level.epsilon);
+		//Bulk kinetic kernel:
+		double epsMean = sum(level.epsilon) / level.gInfo->nr;
+		double kappaSqMean = (level.kappaSq ? sum(level.kappaSq) : 0.) / level.gInfo->nr;
+		if(level.Kkernel) level.Kkernel.free();
+		level.Kkernel.init(0, 0.02, level.gInfo->GmaxGrid, setMultigridKernel, sqrt(kappaSqMean/epsMean));
+		//Damping for Richardson smoothing (stable for omega < 2/lambdaMax):
+		level.omega = 1./(1.1*maxEigenvalue(iLevel)); //10% margin for the power-iteration underestimate
+	}
+}
+
+ScalarFieldTilde PCMmultigrid::operator()(const ScalarFieldTilde& rTilde) const
+{	return vcycle(0, rTilde);
+}
+
+ScalarFieldTilde PCMmultigrid::apply(int iLevel, const ScalarFieldTilde& phiTilde) const
+{	const Level& level = levels[iLevel];
+	ScalarFieldTilde rhoTilde = divergence(J(level.epsilon * I(gradient(phiTilde))));
+	if(level.kappaSq) rhoTilde -= J(level.kappaSq * I(phiTilde));
+	return (-1./(4*M_PI)) * rhoTilde;
+}
+
+ScalarFieldTilde PCMmultigrid::smoother(int iLevel, const ScalarFieldTilde& rTilde) const
+{	const Level& level = levels[iLevel];
+	return (4*M_PI) * (level.Kkernel * J(level.epsInv * I(level.Kkernel * rTilde)));
+}
+
+ScalarFieldTilde PCMmultigrid::vcycle(int iLevel, const ScalarFieldTilde& bTilde) const
+{	const Level& level = levels[iLevel];
+	bool coarsest = (iLevel+1 == int(levels.size()));
+	//Pre-smoothing starting from zero (or the only smoothing on the coarsest level):
+	int nSteps = coarsest ? nCoarseFactor*nSmooth : nSmooth;
+	ScalarFieldTilde xTilde = level.omega * smoother(iLevel, bTilde);
+	for(int iStep=1; iStep<nSteps; iStep++)
+		xTilde += level.omega * smoother(iLevel, bTilde - apply(iLevel, xTilde));
+	if(coarsest) return xTilde;
+	//Coarse-grid correction (Nyquist components dropped on both transfers to keep them adjoint):
+	ScalarFieldTilde rCoarse = changeGrid(bTilde - apply(iLevel, xTilde), *(levels[iLevel+1].gInfo));
+	zeroNyquist(rCoarse);
+	ScalarFieldTilde xCoarse = vcycle(iLevel+1, rCoarse);
+	zeroNyquist(xCoarse);
+	xTilde += changeGrid(xCoarse, *level.gInfo);
+	//Post-smoothing:
+	for(int iStep=0; iStep<nSmooth; iStep++)
+		xTilde += level.omega * smoother(iLevel, bTilde - apply(iLevel, xTilde));
+	return xTilde;
+}
+
+double PCMmultigrid::maxEigenvalue(int iLevel) const
+{	const GridInfo& gInfo = *(levels[iLevel].gInfo);
+	ScalarField v(ScalarFieldData::alloc(gInfo));
+	initRandom(v);
+	v->bcastData(mpiWorld); //keep identical on all processes
+	ScalarFieldTilde vTilde = J(v);
+	double lambda = 0.;
+	for(int iter=0; iter<nPowerIterations; iter++)
+	{	ScalarFieldTilde wTilde = smoother(iLevel, apply(iLevel, vTilde));
+		double wNorm = sqrt(dot(wTilde, wTilde));
+		lambda = wNorm / sqrt(dot(vTilde, vTilde));
+		vTilde = (1./wNorm) * wTilde;
+	}
+	return lambda;
+}
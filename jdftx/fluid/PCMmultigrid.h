@@ -0,0 +1,70 @@
+/*-------------------------------------------------------------------
+Copyright 2026 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_FLUID_PCMMULTIGRID_H
+#define JDFTX_FLUID_PCMMULTIGRID_H
+
+#include <core/ScalarField.h>
+#include <core/RadialFunction.h>
+#include <core/GridInfo.h>
+#include <memory>
+
+//! @addtogroup Solvation
+//! @{
+
+//! @file PCMmultigrid.h Geometric multigrid preconditioner for linearized PCM electrostatics
+
+//! Geometric multigrid V-cycle approximately inverting the variable-coefficient Poisson-Boltzmann
+//! operator -(1/4pi) [div(epsilon grad) - kappaSq] on a hierarchy of successively halved FFT grids.
+//! Restriction and prolongation are Fourier truncation and zero-padding (adjoints of each other),
+//! and each level is smoothed by damped Richardson iterations with a local inverse-kinetic preconditioner,
+//! so that the V-cycle is a fixed symmetric positive-definite operator usable as a CG preconditioner.
+class PCMmultigrid
+{
+public:
+	//! Set up at most nLevels grids (including gInfo), with nSmooth pre- and post-smoothing steps per level
+	PCMmultigrid(const GridInfo& gInfo, int nLevels, int nSmooth);
+	~PCMmultigrid();
+
+	//! Update the dielectric function and squared inverse screening length (null if unscreened) on the finest grid
+	void update(const ScalarField& epsilon, const ScalarField& kappaSq);
+
+	//! Apply one V-cycle to residual (charge density) rTilde, returning an approximate potential correction
+	ScalarFieldTilde operator()(const ScalarFieldTilde& rTilde) const;
+
+private:
+	//! Operator and smoother data on one grid of the hierarchy
+	struct Level
+	{	const GridInfo* gInfo; //!< grid for this level
+		std::shared_ptr<GridInfo> gInfoCoarse; //!< storage for the auxiliary grid (null on the finest level)
+		ScalarField epsilon, kappaSq, epsInv; //!< operator coefficients restricted to this level
+		RadialFunctionG Kkernel; //!< square root of the inverse bulk kinetic operator
+		double omega; //!< damping factor for Richardson smoothing
+	};
+	std::vector<Level> levels; //!< finest first
+	int nSmooth; //!< number of pre- and post-smoothing steps
+
+	ScalarFieldTilde apply(int iLevel, const ScalarFieldTilde& phiTilde) const; //!< Poisson-Boltzmann operator on level iLevel
+	ScalarFieldTilde smoother(int iLevel, const ScalarFieldTilde& rTilde) const; //!< undamped local preconditioner on level iLevel
+	ScalarFieldTilde vcycle(int iLevel, const ScalarFieldTilde& bTilde) const; //!< recursive V-cycle starting at level iLevel
+	double maxEigenvalue(int iLevel) const; //!< estimate largest eigenvalue of smoother*apply by power iteration
+};
+
+//! @}
+#endif // JDFTX_FLUID_PCMMULTIGRID_H
@@ -24,6 +24,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/SphericalHarmonics.h>
 #include <fluid/SaLSA.h>
 #include <fluid/PCM_internal.h>
+#include <fluid/PCMmultigrid.h>
 #include <gsl/gsl_linalg.h>
 #include <cstring>
 
@@ -176,6 +177,7 @@ SaLSA::SaLSA(const Everything& e, const FluidSolverParams& fsp)
 		KkernelSamples[i] = (diagH>GzeroTol) ? 1./sqrt(diagH) : 0.;
 	}
 	Kkernel.init(0, KkernelSamples, dG);
+	if(fsp.mgLevels > 1) multigrid = std::make_shared<PCMmultigrid>(gInfo, fsp.mgLevels, fsp.mgSmooth);
 	
 	//MPI division:
 	TaskDivision(response.size(), mpiWorld).myRange(rStart, rStop);
@@ -204,7 +206,8 @@ ScalarFieldTilde SaLSA::hessian(const ScalarFieldTilde& phiTilde) const
 }
 
 ScalarFieldTilde SaLSA::precondition(const ScalarFieldTilde& rTilde) const
-{	return Kkernel*(J(epsInv*I(Kkernel*rTilde)));
+{	if(multigrid) return (*multigrid)(rTilde);
+	return Kkernel*(J(epsInv*I(Kkernel*rTilde)));
 }
 
 double SaLSA::sync(double x) const
@@ -227,7 +230,9 @@ void SaLSA::set_internal(const ScalarFieldTilde& rhoExplicitTilde, const ScalarF
 		siteShape[iSite] = I(Sf[iSite] * J(shape[0]));
 	
 	//Update the inhomogeneity factor of the preconditioner
-	epsInv = inv(1. + (epsBulk-1.)*shape[0]);
+	ScalarField epsilon = 1. + (epsBulk-1.)*shape[0];
+	epsInv = inv(epsilon);
+	if(multigrid) multigrid->update(epsilon, k2factor ? k2factor*shape.back() : ScalarField()); //local-dielectric approximation
 	
 	//Initialize the state if it hasn't been loaded:
 	if(!state) nullToZero(state, gInfo);
@@ -329,13 +334,16 @@ void SaLSA::getSusceptibility_internal(const std::vector<complex>& omega, std::v
 }
 
 void SaLSA::loadState(const char* filename)
-{	ScalarField Istate(ScalarFieldData::alloc(gInfo));
-	loadRawBinary(Istate, filename); //saved data is in real space
-	state = J(Istate);
+{	ScalarFieldArray Istate(1); nullToZero(Istate, gInfo);
+	if(CheckpointFile::isCheckpoint(filename)) loadCheckpoint(Istate, filename);
+	else loadRawBinary(Istate[0], filename); //saved data is in real space
+	state = J(Istate[0]);
 }
 
 void SaLSA::saveState(const char* filename) const
-{	if(mpiWorld->isHead()) saveRawBinary(I(state), filename); //saved data is in real space
+{	if(!mpiWorld->isHead()) return;
+	if(e.dump.checkpoint.enabled) saveCheckpoint(ScalarFieldArray(1, I(state)), filename, e.dump.checkpoint);
+	else saveRawBinary(I(state), filename); //saved data is in real space
 }
 
 void SaLSA::dumpDensities(const char* filenamePattern) const
@@ -54,6 +54,7 @@ private:
 	int rStart, rStop; //MPI division of response array
 	RadialFunctionG nFluid; //electron density model for the fluid
 	RadialFunctionG Kkernel; ScalarField epsInv; //for preconditioner
+	std::shared_ptr<class PCMmultigrid> multigrid; //optional multigrid preconditioner for the local-dielectric approximation of the hessian
 	ScalarFieldArray siteShape; //shape functions for sites
 	ScalarFieldTilde nCavityNetTilde; //input nCavity + full core before convolution
 };
@@ -40,6 +40,8 @@ int main(int argc, char** argv)
 	ElecVars& eVars = e.eVars;
 	parse(readInputFile(ip.inputFilename), e, ip.printDefaults);
 	if(ip.dryRun) eVars.skipWfnsInit = true;
+	else if(e.vibrations && !(e.cntrl.dumpOnly || e.cntrl.fixed_H)) //only when displacements will actually be run below
+		e.vibrations->divideProcesses(); //before setup, which distributes data over mpiWorld
 	e.setup();
 	e.dump(DumpFreq_Init, 0);
 	Citations::print();
@@ -107,6 +109,7 @@ int main(int argc, char** argv)
 
 	//Final dump:
 	e.dump(DumpFreq_End, 0);
+	if(e.vibrations) e.vibrations->mergeProcesses();
 	
 	finalizeSystem();
 	return 0;
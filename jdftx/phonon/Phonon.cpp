@@ -27,30 +27,42 @@ void Phonon::dump()
 	dgrad.assign(modes.size(), zeroForce);
 	dHsub.assign(modes.size(), std::vector<matrix>(nSpins));
 	
-	//Accumulate contributions to force matrix and electron-phonon matrix elements for each irreducible perturbation:
-	unsigned iPertStart = (iPerturbation>=0) ? iPerturbation : 0;
-	unsigned iPertStop  = (iPerturbation>=0) ? iPerturbation+1 : perturbations.size();
-	std::vector<int> nStatesPert(perturbations.size());
-	for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
-	{	logPrintf("########### Perturbed supercell calculation %u of %d #############\n", iPert+1, int(perturbations.size()));
-		ostringstream oss; oss << "phonon." << iPert+1 << ".$@#!"; //placeholder for $VAR
-		string fnamePattern = e.dump.getFilename(oss.str()); //(because dump variable name cannot contain $VAR)
-		fnamePattern.replace(fnamePattern.find("$@#!"), 4, "$VAR"); //replace placeholder with $VAR
-		processPerturbation(perturbations[iPert], fnamePattern);
-		nStatesPert[iPert] = eSup->eInfo.nStates;
-		logPrintf("\n"); logFlush();
-	}
-	if(dryRun)
-	{	logPrintf("\nParameter summary for supercell calculations:\n");
-		for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
-			logPrintf("\tPerturbation: %u  nStates: %d\n", iPert+1, nStatesPert[iPert]);
-		logPrintf("Use option iPerturbation of command phonon to run each supercell calculation separately.\n");
-		return;
+	if(dfpt) //Linear response in the unit cell instead of supercell calculations:
+	{	if(dryRun)
+		{	logPrintf("\nDry run: linear-response (DFPT) setup successful.\n");
+			return;
+		}
+		processDFPT();
 	}
-	if(iPerturbation>=0)
-	{	logPrintf("Completed supercell calculation for iPerturbation %d.\n", iPerturbation+1);
-		logPrintf("After completing all supercells, rerun with option collectPerturbations in command phonon.\n");
-		return;
+	else
+	{	//Accumulate contributions to force matrix and electron-phonon matrix elements for each irreducible perturbation:
+		unsigned iPertStart = (iPerturbation>=0) ? iPerturbation : 0;
+		unsigned iPertStop  = (iPerturbation>=0) ? iPerturbation+1 : perturbations.size();
+		std::vector<int> nStatesPert(perturbations.size());
+		int nGroups = nPertGroups ? nPertGroups : int(perturbations.size());
+		nGroups = std::min(nGroups, std::min(int(perturbations.size()), mpiWorld->nProcesses()));
+		if(nGroups>1 && iPerturbation<0 && !dryRun)
+			processPerturbationsGrouped(nGroups, nStatesPert);
+		else
+		{	for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
+			{	logPrintf("########### Perturbed supercell calculation %u of %d #############\n", iPert+1, int(perturbations.size()));
+				processPerturbation(perturbations[iPert], getPerturbationPattern(iPert));
+				nStatesPert[iPert] = eSup->eInfo.nStates;
+				logPrintf("\n"); logFlush();
+			}
+		}
+		if(dryRun)
+		{	logPrintf("\nParameter summary for supercell calculations:\n");
+			for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
+				logPrintf("\tPerturbation: %u  nStates: %d\n", iPert+1, nStatesPert[iPert]);
+			logPrintf("Use option iPerturbation of command phonon to run each supercell calculation separately.\n");
+			return;
+		}
+		if(iPerturbation>=0)
+		{	logPrintf("Completed supercell calculation for iPerturbation %d.\n", iPerturbation+1);
+			logPrintf("After completing all supercells, rerun with option collectPerturbations in command phonon.\n");
+			return;
+		}
 	}
 	
 	//Process force matrix:
@@ -224,6 +236,13 @@ void Phonon::dump()
 	logPrintf("\n");
 }
 
+string Phonon::getPerturbationPattern(int iPert) const
+{	ostringstream oss; oss << "phonon." << iPert+1 << ".$@#!"; //placeholder for $VAR
+	string fnamePattern = e.dump.getFilename(oss.str()); //(because dump variable name cannot contain $VAR)
+	fnamePattern.replace(fnamePattern.find("$@#!"), 4, "$VAR"); //replace placeholder with $VAR
+	return fnamePattern;
+}
+
 vector3<int> Phonon::getCell(int unit) const
 {	vector3<int> cell;
 	cell[2] = unit % sup[2]; unit /= sup[2];
@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
 #include <core/LatticeUtils.h>
+#include <core/PulayParams.h>
 
 //! @addtogroup Output
 //! @{
@@ -63,6 +64,9 @@ public:
 	int iPerturbation; //!< if >=0, only run one supercell calculation
 	bool collectPerturbations; //!< if true, collect results of previously computed perturbations (skips supercell SCF/Minimize)
 	bool saveHsub; //!< whether to compute / output electron-phonon matrix elements
+	int nPertGroups; //!< number of process groups for running perturbations concurrently (if 0, one per perturbation limited by process count)
+	bool dfpt; //!< whether to use linear response (DFPT) in the unit cell instead of finite-difference supercell calculations
+	PulayParams dfptParams; //!< convergence and mixing parameters for the self-consistent linear response
 	
 	Phonon();
 	void setup(bool printDefaults); //!< setup unit cell and basis modes for perturbations
@@ -100,6 +104,16 @@ private:
 	//!Run supercell calculation for specified perturbation (using fnamePattern to load/restore required properties)
 	void processPerturbation(const Perturbation& pert, string fnamePattern);
 	
+	//!Run all perturbations concurrently in nGroups process groups, each taking perturbations from a shared queue,
+	//!and collect dgrad and dHsub over all groups; also set number of supercell states of each perturbation
+	void processPerturbationsGrouped(int nGroups, std::vector<int>& nStatesPert);
+	
+	string getPerturbationPattern(int iPert) const; //!< filename pattern (containing $VAR) for outputs of perturbation iPert
+	
+	//!Compute dgrad and dHsub for all modes by linear response at each supercell-commensurate wavevector (in Phonon_dfpt.cpp)
+	void processDFPT();
+	friend class PhononDFPT;
+	
 	//!Set unperturbed state of supercell from unit cell and retrieve unperturbed subspace Hamiltonian at supercell Gamma point (for all bands)
 	std::vector<diagMatrix> setSupState();
 	
@@ -0,0 +1,670 @@
+/*-------------------------------------------------------------------
+Copyright 2026 Ravishankar Sundararaman
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <phonon/Phonon.h>
+#include <electronic/ColumnBundleTransform.h>
+#include <core/ScalarFieldIO.h>
+#include <core/Pulay.h>
+
+//! Linear-response (density-functional perturbation theory) calculation of the force matrix
+//! and electron-phonon matrix elements, using only unit-cell sized Sternheimer solves at
+//! each supercell-commensurate phonon wavevector q. The self-consistency in the first-order
+//! electron density (Bloch-periodic part at q, on the full G-space grid) is Pulay-mixed.
+class PhononDFPT : public Pulay<complexScalarFieldTilde>
+{
+public:
+	PhononDFPT(Phonon& phonon);
+	void compute(); //!< accumulate phonon.dgrad and phonon.dHsub from all commensurate wavevectors
+
+protected:
+	//Interface for Pulay<complexScalarFieldTilde>:
+	double cycle(double dEprev, std::vector<double>& extraValues);
+	void axpy(double alpha, const complexScalarFieldTilde& X, complexScalarFieldTilde& Y) const { ::axpy(alpha, X, Y); }
+	double dot(const complexScalarFieldTilde& X, const complexScalarFieldTilde& Y) const { return ::dot(X, Y).real(); }
+	size_t variableSize() const { return gInfo.nr * sizeof(complex); }
+	void readVariable(complexScalarFieldTilde& X, FILE* fp) const { nullToZero(X, gInfo); loadRawBinary(X, fp); }
+	void writeVariable(const complexScalarFieldTilde& X, FILE* fp) const { saveRawBinary(X, fp); }
+	complexScalarFieldTilde getVariable() const { return clone(dn); }
+	void setVariable(const complexScalarFieldTilde& X) { dn = clone(X); }
+	complexScalarFieldTilde precondition(const complexScalarFieldTilde& X) const { return kerker * X; }
+	complexScalarFieldTilde applyMetric(const complexScalarFieldTilde& X) const { return metric * X; }
+
+private:
+	Phonon& phonon;
+	const Everything& e;
+	const GridInfo& gInfo; //!< charge-density grid
+	const GridInfo& gInfoWfns; //!< wavefunction grid
+	int nModes, nBands, nOcc;
+	int nkMesh; //!< number of k-points in full unit-cell mesh
+	double kWeight; //!< integration weight (including spin degeneracy) of each k-point in mesh
+	double alphaPv; //!< shift of occupied subspace in Sternheimer operator (to make it positive definite)
+	std::vector<int> iCommensurate; //!< index into list of commensurate k-points (or -1) for each k in mesh
+	std::vector<int> atomIndex; //!< flattened atom index for each mode
+	std::vector<SpaceGroupOp> sym; //!< unit cell symmetries (for unfolding states from reduced k-points)
+	std::shared_ptr< PeriodicLookup< vector3<> > > plook; //!< lookup in unit cell k-mesh
+
+	//Unperturbed quantities needed for the second derivative:
+	complexScalarFieldTilde nTilde, VxcTilde; //!< electron density and exchange-correlation potential (full G-space)
+	ScalarField e_nn, e_sigma, e_nsigma, e_sigmasigma; //!< exchange-correlation second derivatives
+	VectorField DnXC; //!< gradient of exchange-correlation density (for GGAs)
+
+	//Unperturbed states at k and k+q, and first-order wavefunctions, for one k in the mesh:
+	struct KpointPair
+	{	vector3<> k, kq;
+		int ik, ikq; //!< indices in unit cell k-mesh
+		Basis basis, basisQ;
+		QuantumNumber qnum, qnumQ;
+		ColumnBundle C, Cq; //!< all bands at k and k+q
+		ColumnBundle Cocc, CqOcc; //!< occupied bands at k and k+q
+		diagMatrix eigOcc; //!< occupied eigenvalues at k
+		diagMatrix KEref; //!< reference kinetic energies for preconditioning
+		std::vector<ColumnBundle> V, Vq; //!< non-local projectors (all atoms) for each species at k and k+q
+		ColumnBundle dC; //!< first-order change in occupied bands (k+q component) for current mode
+	};
+	std::vector<KpointPair> kpairs; //!< k-points in mesh local to this process
+	int ikStart, ikStop; //!< range of k-points in mesh local to this process
+
+	//Quantities for current wavevector:
+	vector3<> q;
+	complexScalarFieldTilde hartree; //!< Coulomb kernel 4pi/|G+q|^2
+	complexScalarFieldTilde kerker, metric; //!< Pulay mixing kernels
+	complexScalarFieldTilde iGq[3]; //!< i(G+q) in each Cartesian direction
+	std::vector<complexScalarFieldTilde> dVext, dnCore; //!< first-order local potential and core density for each mode
+
+	//Quantities for current mode:
+	int iMode;
+	complexScalarFieldTilde dn; //!< first-order electron density
+	complexScalarFieldTilde dVxc; //!< first-order exchange-correlation potential (including core density change)
+	double cgThreshold; //!< relative threshold for Sternheimer solves (tightened as SCF converges)
+	int cgIterations; //!< total Sternheimer iterations in current SCF cycle
+
+	ColumnBundle getWfns(const vector3<>& k, const Basis& basis, const QuantumNumber& qnum, diagMatrix& eigs) const;
+	void setupStates(); //!< initialize kpairs for current q
+	void setupPerturbations(); //!< initialize kernels, dVext and dnCore for current q
+	complexScalarFieldTilde getVxcResponse(const complexScalarFieldTilde& dnXC) const; //!< first-order XC potential
+	complexScalarField getWfnsPotential(const complexScalarFieldTilde& dVtilde) const; //!< Bloch-periodic potential on wavefunction grid (with JdagOJ scaling)
+	ColumnBundle applyH(const KpointPair& kp, const ColumnBundle& X) const; //!< Hamiltonian at k+q
+	ColumnBundle applyA(const KpointPair& kp, const ColumnBundle& X) const; //!< Sternheimer operator at k+q
+	ColumnBundle applyDV(const KpointPair& kp, const ColumnBundle& X, const complexScalarField& dVlocWfns, int jMode) const; //!< first-order Hamiltonian from k to k+q
+	int solveSternheimer(const KpointPair& kp, const ColumnBundle& B, ColumnBundle& X) const; //!< solve A X = B by band-wise preconditioned CG
+	matrix getEwald() const; //!< ionic (Ewald) contribution to the dynamical matrix at current q
+	matrix getDiagonal() const; //!< q-independent second-order (same atom) electronic contribution to the dynamical matrix
+};
+
+//Cartesian directional derivative -dir.grad (with respect to atom position) of projectors:
+inline ColumnBundle projectorDeriv(const ColumnBundle& V, const vector3<>& dir)
+{	ColumnBundle dV = V.similar(); dV.zero();
+	for(int iDir=0; iDir<3; iDir++)
+		if(dir[iDir]) dV -= dir[iDir] * D(V, iDir);
+	return dV;
+}
+
+PhononDFPT::PhononDFPT(Phonon& phonon)
+: Pulay<complexScalarFieldTilde>(phonon.dfptParams), phonon(phonon), e(phonon.e), gInfo(e.gInfo), gInfoWfns(*(e.basis[0].gInfo)),
+	nModes(phonon.modes.size()), nBands(e.eInfo.nBands)
+{
+	//Check supported calculation types:
+	if(e.eInfo.spinType != SpinNone) die("\nDFPT phonons currently require a spin-unpolarized calculation.\n");
+	if(e.eInfo.hasU) die("\nDFPT phonons are not yet implemented for DFT+U.\n");
+	if(e.eVars.fluidSolver) die("\nDFPT phonons are not yet implemented with fluids.\n");
+	vector3<bool> isTruncated = e.coulombParams.isTruncated();
+	if(isTruncated[0] || isTruncated[1] || isTruncated[2]) die("\nDFPT phonons currently require periodic (untruncated) Coulomb interactions.\n");
+	if(e.exCorr.exxFactor() || e.exCorr.needsKEdensity() || e.exCorr.orbitalDep) die("\nDFPT phonons currently support only LDA and GGA exchange-correlation functionals.\n");
+	if(e.iInfo.vdWenable) die("\nDFPT phonons are not yet implemented with vdW pair-potential corrections.\n");
+	for(auto sp: e.iInfo.species)
+	{	if(sp->isUltrasoft()) die("\nDFPT phonons currently require norm-conserving pseudopotentials.\n");
+		if(sp->Z_chargeball) die("\nDFPT phonons are not yet implemented with chargeballs.\n");
+	}
+	nOcc = int(round(0.5*e.eInfo.nElectrons));
+	if(e.eInfo.fillingsUpdate != ElecInfo::FillingsConst || fabs(2*nOcc - e.eInfo.nElectrons) > symmThreshold)
+		die("\nDFPT phonons currently require an insulator with fixed integer fillings.\n");
+	for(const diagMatrix& F: e.eVars.F)
+		for(int b=0; b<nBands; b++)
+			if(fabs(F[b] - (b<nOcc ? 1. : 0.)) > symmThreshold)
+				die("\nDFPT phonons currently require an insulator with fixed integer fillings.\n");
+
+	//k-point mesh and its division:
+	const Supercell& supercell = *(e.coulombParams.supercell);
+	nkMesh = supercell.kmesh.size();
+	kWeight = e.eInfo.qWeightSum / nkMesh;
+	plook = std::make_shared< PeriodicLookup< vector3<> > >(supercell.kmesh, gInfo.GGT);
+	sym = e.symm.getMatrices();
+	TaskDivision(nkMesh, mpiWorld).myRange(ikStart, ikStop);
+	int nCommensurate = 0;
+	for(const vector3<>& k: supercell.kmesh)
+	{	double roundErr; round(k * Diag(phonon.sup), &roundErr);
+		iCommensurate.push_back(roundErr < symmThreshold ? nCommensurate++ : -1); //same order as phononKpts
+	}
+	assert(nCommensurate == phonon.prodSup);
+
+	//Flattened atom index of each mode:
+	std::vector<int> atomOffset;
+	int nAtomsTot = 0;
+	for(auto sp: e.iInfo.species)
+	{	atomOffset.push_back(nAtomsTot);
+		nAtomsTot += sp->atpos.size();
+	}
+	for(const Phonon::Mode& mode: phonon.modes)
+		atomIndex.push_back(atomOffset[mode.sp] + mode.at);
+
+	//Shift of occupied subspace:
+	double eMin = +DBL_MAX, eMax = -DBL_MAX;
+	for(const diagMatrix& eigs: e.eVars.Hsub_eigs)
+	{	eMin = std::min(eMin, eigs[0]);
+		eMax = std::max(eMax, eigs[nOcc-1]);
+	}
+	alphaPv = 2.*(eMax - eMin) + 0.1;
+
+	//Unperturbed density and exchange-correlation quantities:
+	nTilde = J(Complex(e.eVars.n[0]));
+	VxcTilde = J(Complex(e.eVars.Vxc[0]));
+	ScalarField nXC = e.eVars.get_nXC()[0];
+	e.exCorr.getSecondDerivatives(nXC, e_nn, e_sigma, e_nsigma, e_sigmasigma);
+	if(e_sigma) DnXC = gradient(nXC);
+
+	//Projectors are stored in kpairs below (avoid caching them against temporary bases):
+	phonon.e.cntrl.cacheProjectors = false;
+}
+
+//Wavefunctions at arbitrary k in the mesh (or equivalent to it), unfolded from the reduced k-points:
+ColumnBundle PhononDFPT::getWfns(const vector3<>& k, const Basis& basis, const QuantumNumber& qnum, diagMatrix& eigs) const
+{	size_t ik = plook->find(k);
+	assert(ik != string::npos);
+	const Supercell::KmeshTransform& kmt = e.coulombParams.supercell->kmeshTransform[ik];
+	ColumnBundleTransform::BasisWrapper basisWrapper(basis);
+	ColumnBundleTransform transform(e.eInfo.qnums[kmt.iReduced].k, e.basis[kmt.iReduced], k, basisWrapper, 1, sym[kmt.iSym], kmt.invert);
+	ColumnBundle C(nBands, basis.nbasis, &basis, &qnum, isGpuEnabled());
+	C.zero();
+	transform.scatterAxpy(1., e.eVars.C[kmt.iReduced], C,0,1);
+	eigs = e.eVars.Hsub_eigs[kmt.iReduced];
+	return C;
+}
+
+void PhononDFPT::setupStates()
+{	static StopWatch watch("PhononDFPT::setupStates"); watch.start();
+	const std::vector< vector3<> >& kmesh = e.coulombParams.supercell->kmesh;
+	kpairs.clear();
+	kpairs.resize(ikStop-ikStart); //sized once, so that pointers to the bases / quantum numbers remain valid
+	for(int ik=ikStart; ik<ikStop; ik++)
+	{	KpointPair& kp = kpairs[ik-ikStart];
+		kp.ik = ik;
+		kp.k = kmesh[ik];
+		kp.kq = kp.k + q;
+		kp.ikq = plook->find(kp.kq);
+		assert(kp.ikq >= 0);
+		kp.qnum.k = kp.k; kp.qnum.weight = kWeight;
+		kp.qnumQ.k = kp.kq; kp.qnumQ.weight = kWeight;
+		logSuspend();
+		kp.basis.setup(gInfoWfns, e.iInfo, e.cntrl.Ecut, kp.k);
+		kp.basisQ.setup(gInfoWfns, e.iInfo, e.cntrl.Ecut, kp.kq);
+		logResume();
+		diagMatrix eigs, eigsQ;
+		kp.C = getWfns(kp.k, kp.basis, kp.qnum, eigs);
+		kp.Cq = getWfns(kp.kq, kp.basisQ, kp.qnumQ, eigsQ);
+		kp.Cocc = kp.C.getSub(0, nOcc);
+		kp.CqOcc = kp.Cq.getSub(0, nOcc);
+		kp.eigOcc = eigs(0, nOcc);
+		kp.KEref = (-0.5) * diagDot(kp.Cocc, L(kp.Cocc));
+		kp.V.resize(e.iInfo.species.size());
+		kp.Vq.resize(e.iInfo.species.size());
+		for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+		{	auto V = e.iInfo.species[sp]->getV(kp.Cocc);
+			auto Vq = e.iInfo.species[sp]->getV(kp.CqOcc);
+			if(V) { kp.V[sp] = *V; kp.Vq[sp] = *Vq; }
+		}
+	}
+	watch.stop();
+}
+
+void PhononDFPT::setupPerturbations()
+{	//Kernels at current q:
+	nullToZero(hartree, gInfo);
+	nullToZero(kerker, gInfo);
+	nullToZero(metric, gInfo);
+	for(int iDir=0; iDir<3; iDir++) nullToZero(iGq[iDir], gInfo);
+	const PulayParams& pp = phonon.dfptParams;
+	double qKerkerSq = std::pow(pp.qMetric, 2); //same length scale for preconditioner and metric
+	complex* hartreeData = hartree->data();
+	complex* kerkerData = kerker->data();
+	complex* metricData = metric->data();
+	complex* iGqData[3]; for(int iDir=0; iDir<3; iDir++) iGqData[iDir] = iGq[iDir]->data();
+	{	size_t iStart=0, iStop=gInfo.nr;
+		const vector3<int>& S = gInfo.S;
+		THREAD_fullGspaceLoop
+		(	vector3<> Gq = (vector3<>(iG) + q) * gInfo.G;
+			double GqSq = Gq.length_squared();
+			hartreeData[i] = GqSq>symmThresholdSq ? 4*M_PI/GqSq : 0.;
+			kerkerData[i] = pp.mixFraction * GqSq/(GqSq + qKerkerSq);
+			metricData[i] = GqSq>symmThresholdSq ? (GqSq + qKerkerSq)/GqSq : 0.;
+			for(int iDir=0; iDir<3; iDir++) iGqData[iDir][i] = complex(0., Gq[iDir]);
+		)
+	}
+	//External perturbations for each mode:
+	dVext.assign(nModes, 0);
+	dnCore.assign(nModes, 0);
+	for(int jMode=0; jMode<nModes; jMode++)
+	{	const Phonon::Mode& mode = phonon.modes[jMode];
+		const SpeciesInfo& sp = *(e.iInfo.species[mode.sp]);
+		const vector3<>& atpos = sp.atpos[mode.at];
+		nullToZero(dVext[jMode], gInfo);
+		complex* dVdata = dVext[jMode]->data();
+		complex* dnData = 0;
+		if(sp.nCoreRadial) { nullToZero(dnCore[jMode], gInfo); dnData = dnCore[jMode]->data(); }
+		size_t iStart=0, iStop=gInfo.nr;
+		const vector3<int>& S = gInfo.S;
+		THREAD_fullGspaceLoop
+		(	vector3<> iGqLattice = vector3<>(iG) + q;
+			vector3<> Gq = iGqLattice * gInfo.G;
+			double GqSq = Gq.length_squared();
+			double Gqmag = sqrt(GqSq);
+			//Derivative of structure factor cis(-Gq.atpos) / detR w.r.t atom position:
+			complex dSG = cis(-2*M_PI*::dot(iGqLattice, atpos)) * complex(0., -::dot(Gq, mode.dir)/gInfo.detR);
+			double Vloc = sp.VlocRadial(Gqmag) - (GqSq>symmThresholdSq ? 4*M_PI*sp.Z/GqSq : 0.);
+			dVdata[i] = dSG * Vloc;
+			if(dnData) dnData[i] = dSG * sp.nCoreRadial(Gqmag);
+		)
+	}
+}
+
+complexScalarFieldTilde PhononDFPT::getVxcResponse(const complexScalarFieldTilde& dnXC) const
+{	complexScalarField dnR = I(dnXC);
+	complexScalarField KV = e_nn * dnR;
+	if(e_sigma)
+	{	complexScalarField DdnR[3], DnDdn;
+		for(int iDir=0; iDir<3; iDir++)
+		{	DdnR[iDir] = I(iGq[iDir] * dnXC);
+			DnDdn += 2. * (DnXC[iDir] * DdnR[iDir]);
+		}
+		KV += e_nsigma * DnDdn;
+		complexScalarFieldTilde result = J(KV);
+		complexScalarField DnTerm = e_nsigma * dnR + e_sigmasigma * DnDdn;
+		for(int iDir=0; iDir<3; iDir++)
+			result -= 2. * (iGq[iDir] * J(DnXC[iDir] * DnTerm + e_sigma * DdnR[iDir]));
+		return result;
+	}
+	return J(KV);
+}
+
+complexScalarField PhononDFPT::getWfnsPotential(const complexScalarFieldTilde& dVtilde) const
+{	complexScalarFieldTilde dVwfns = (&gInfo == &gInfoWfns) ? dVtilde : changeGrid(dVtilde, gInfoWfns);
+	return JdagOJ(I(dVwfns));
+}
+
+ColumnBundle PhononDFPT::applyH(const KpointPair& kp, const ColumnBundle& X) const
+{	ColumnBundle HX = Idag_DiagV_I(X, e.eVars.Vscloc);
+	HX -= 0.5 * L(X);
+	for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+		if(kp.Vq[sp])
+		{	matrix VdagX = kp.Vq[sp] ^ X, HVdagX;
+			e.iInfo.species[sp]->EnlAndGrad(kp.qnumQ, diagMatrix(X.nCols(), 1.), VdagX, HVdagX);
+			HX += kp.Vq[sp] * HVdagX;
+		}
+	return HX;
+}
+
+ColumnBundle PhononDFPT::applyA(const KpointPair& kp, const ColumnBundle& X) const
+{	const double& detR = gInfo.detR;
+	ColumnBundle AX = applyH(kp, X);
+	AX -= detR * (X * kp.eigOcc); //H - O eps (O is detR for norm-conserving)
+	AX += (alphaPv*detR*detR) * (kp.CqOcc * (kp.CqOcc ^ X)); //shift occupied subspace at k+q
+	return AX;
+}
+
+ColumnBundle PhononDFPT::applyDV(const KpointPair& kp, const ColumnBundle& X, const complexScalarField& dVlocWfns, int jMode) const
+{	ColumnBundle Y(X.nCols(), kp.basisQ.nbasis, &kp.basisQ, &kp.qnumQ, isGpuEnabled());
+	Y.zero();
+	//Local part:
+	for(int b=0; b<X.nCols(); b++)
+		Y.accumColumn(b,0, Idag(dVlocWfns * I(X.getColumn(b,0))));
+	//Non-local part (only projectors on the displaced atom change):
+	const Phonon::Mode& mode = phonon.modes[jMode];
+	const SpeciesInfo& sp = *(e.iInfo.species[mode.sp]);
+	if(kp.V[mode.sp])
+	{	int nProj = sp.MnlAll.nRows();
+		ColumnBundle V = kp.V[mode.sp].getSub(mode.at*nProj, (mode.at+1)*nProj);
+		ColumnBundle Vq = kp.Vq[mode.sp].getSub(mode.at*nProj, (mode.at+1)*nProj);
+		Y += projectorDeriv(Vq, mode.dir) * (sp.MnlAll * (V ^ X));
+		Y += Vq * (sp.MnlAll * (projectorDeriv(V, mode.dir) ^ X));
+	}
+	return Y;
+}
+
+int PhononDFPT::solveSternheimer(const KpointPair& kp, const ColumnBundle& B, ColumnBundle& X) const
+{	static StopWatch watch("PhononDFPT::solveSternheimer"); watch.start();
+	int nCols = B.nCols();
+	diagMatrix Bnorm = diagDot(B, B);
+	if(!X) { X = B.similar(); X.zero(); }
+	ColumnBundle R = B; R -= applyA(kp, X);
+	ColumnBundle Z = R; precond_inv_kinetic_band(Z, kp.KEref);
+	ColumnBundle P = Z;
+	diagMatrix rz = diagDot(R, Z);
+	const int nIterationsMax = 100;
+	int iter = 0;
+	for(; iter<nIterationsMax; iter++)
+	{	//Check convergence:
+		diagMatrix Rnorm = diagDot(R, R);
+		double relResidual = 0.;
+		for(int b=0; b<nCols; b++)
+			relResidual = std::max(relResidual, Rnorm[b]/std::max(Bnorm[b], DBL_MIN));
+		if(sqrt(relResidual) < cgThreshold) break;
+		//Line minimize each band independently:
+		ColumnBundle AP = applyA(kp, P);
+		diagMatrix PAP = diagDot(P, AP), alpha(nCols);
+		for(int b=0; b<nCols; b++) alpha[b] = PAP[b] ? rz[b]/PAP[b] : 0.;
+		X += P * alpha;
+		R -= AP * alpha;
+		//Update search directions:
+		Z = R; precond_inv_kinetic_band(Z, kp.KEref);
+		diagMatrix rzNew = diagDot(R, Z), beta(nCols);
+		for(int b=0; b<nCols; b++) beta[b] = rz[b] ? rzNew[b]/rz[b] : 0.;
+		P = Z + P * beta;
+		rz = rzNew;
+	}
+	watch.stop();
+	return iter;
+}
+
+double PhononDFPT::cycle(double dEprev, std::vector<double>& extraValues)
+{	static StopWatch watch("PhononDFPT::cycle"); watch.start();
+	//Self-consistent first-order potential:
+	dVxc = getVxcResponse(dnCore[iMode] ? dn + dnCore[iMode] : dn);
+	complexScalarField dVscf = getWfnsPotential(dVext[iMode] + hartree * dn + dVxc);
+	//Sternheimer solves and first-order density:
+	complexScalarField dnWfns; nullToZero(dnWfns, gInfoWfns);
+	cgIterations = 0;
+	for(KpointPair& kp: kpairs)
+	{	ColumnBundle dVC = applyDV(kp, kp.Cocc, dVscf, iMode);
+		dVC -= gInfo.detR * (kp.CqOcc * (kp.CqOcc ^ dVC)); //project out occupied subspace at k+q
+		dVC *= -1.;
+		cgIterations += solveSternheimer(kp, dVC, kp.dC);
+		for(int b=0; b<nOcc; b++)
+			dnWfns += (2.*kWeight) * (conj(I(kp.Cocc.getColumn(b,0))) * I(kp.dC.getColumn(b,0)));
+	}
+	mpiWorld->allReduce(cgIterations, MPIUtil::ReduceSum);
+	complexScalarFieldTilde dnOut = J(dnWfns);
+	if(&gInfo != &gInfoWfns) dnOut = changeGrid(dnOut, gInfo);
+	dnOut->allReduceData(mpiWorld, MPIUtil::ReduceSum);
+	//Tighten Sternheimer threshold with SCF convergence:
+	double relResidual = nrm2(dnOut - dn) / std::max(nrm2(dnOut), DBL_MIN);
+	cgThreshold = std::min(1e-3, std::max(1e-10, 0.1*relResidual));
+	logPrintf("\tSternheimer: %d iterations (average per k-point).\n", cgIterations/nkMesh);
+	dn = dnOut;
+	watch.stop();
+	return gInfo.detR * ::dot(dVext[iMode], dn).real(); //local part of diagonal force matrix element (for reporting)
+}
+
+matrix PhononDFPT::getEwald() const
+{	//Collect atoms:
+	std::vector< vector3<> > xAtoms; std::vector<double> Zatoms;
+	for(auto sp: e.iInfo.species)
+		for(const vector3<>& x: sp->atpos)
+		{	xAtoms.push_back(x);
+			Zatoms.push_back(sp->Z);
+		}
+	int nAtoms = xAtoms.size();
+	const matrix3<>& R = gInfo.R;
+	const matrix3<>& G = gInfo.G;
+	//Ewald parameters:
+	double eta = sqrt(M_PI) / pow(gInfo.detR, 1./3);
+	double rMax = 6./eta, Gmax = 12.*eta;
+	vector3<int> Rbox, Gbox;
+	for(int k=0; k<3; k++)
+	{	Rbox[k] = 1 + int(ceil(rMax * G.row(k).length() / (2*M_PI)));
+		Gbox[k] = 1 + int(ceil(Gmax * R.column(k).length() / (2*M_PI)));
+	}
+	//Cartesian 3x3 blocks of dynamical matrix for each atom pair:
+	std::vector<complex> Dcart(nAtoms*nAtoms*9);
+	#define DCART(a,b,i,j) Dcart[(((a)*nAtoms+(b))*3+(i))*3+(j)]
+	//--- real space sum:
+	const double etaPrefac = 2.*eta/sqrt(M_PI);
+	vector3<int> iR;
+	for(iR[0]=-Rbox[0]; iR[0]<=Rbox[0]; iR[0]++)
+	for(iR[1]=-Rbox[1]; iR[1]<=Rbox[1]; iR[1]++)
+	for(iR[2]=-Rbox[2]; iR[2]<=Rbox[2]; iR[2]++)
+	{	complex phase = cis(2*M_PI*::dot(q, iR));
+		for(int a=0; a<nAtoms; a++)
+			for(int b=0; b<nAtoms; b++)
+			{	vector3<> x = R * (xAtoms[b] + iR - xAtoms[a]);
+				double r = x.length();
+				if(r < symmThreshold || r > rMax) continue;
+				double erfcTerm = erfc(eta*r), expTerm = etaPrefac * exp(-eta*eta*r*r);
+				double fPrime = -erfcTerm/(r*r) - expTerm/r;
+				double fDblPrime = 2.*erfcTerm/(r*r*r) + expTerm*(2./(r*r) + 2.*eta*eta);
+				vector3<> rHat = x / r;
+				double ZZ = Zatoms[a] * Zatoms[b];
+				for(int i=0; i<3; i++)
+					for(int j=0; j<3; j++)
+					{	double H = (fDblPrime - fPrime/r)*rHat[i]*rHat[j] + (i==j ? fPrime/r : 0.);
+						DCART(a,b,i,j) -= ZZ * H * phase;
+						DCART(a,a,i,j) += ZZ * H;
+					}
+			}
+	}
+	//--- reciprocal space sum:
+	double prefac = 4*M_PI / gInfo.detR;
+	vector3<int> iG;
+	for(iG[0]=-Gbox[0]; iG[0]<=Gbox[0]; iG[0]++)
+	for(iG[1]=-Gbox[1]; iG[1]<=Gbox[1]; iG[1]++)
+	for(iG[2]=-Gbox[2]; iG[2]<=Gbox[2]; iG[2]++)
+	{	//Cross term at G+q:
+		vector3<> iGqLattice = vector3<>(iG) + q;
+		vector3<> Gq = iGqLattice * G;
+		double GqSq = Gq.length_squared();
+		if(GqSq > symmThresholdSq && GqSq < Gmax*Gmax)
+		{	double weight = prefac * exp(-0.25*GqSq/(eta*eta)) / GqSq;
+			for(int a=0; a<nAtoms; a++)
+				for(int b=0; b<nAtoms; b++)
+				{	complex phase = (weight * Zatoms[a] * Zatoms[b]) * cis(2*M_PI*::dot(iGqLattice, xAtoms[a]-xAtoms[b]));
+					for(int i=0; i<3; i++)
+						for(int j=0; j<3; j++)
+							DCART(a,b,i,j) += phase * Gq[i] * Gq[j];
+				}
+		}
+		//Diagonal term at G:
+		vector3<> Gvec = iG * G;
+		double GSq = Gvec.length_squared();
+		if(GSq > symmThresholdSq && GSq < Gmax*Gmax)
+		{	double weight = prefac * exp(-0.25*GSq/(eta*eta)) / GSq;
+			for(int a=0; a<nAtoms; a++)
+				for(int c=0; c<nAtoms; c++)
+				{	double cosTerm = weight * Zatoms[a] * Zatoms[c] * cos(2*M_PI*::dot(iG, xAtoms[a]-xAtoms[c]));
+					for(int i=0; i<3; i++)
+						for(int j=0; j<3; j++)
+							DCART(a,a,i,j) -= cosTerm * Gvec[i] * Gvec[j];
+				}
+		}
+	}
+	//Project to modes:
+	matrix Dewald = zeroes(nModes, nModes);
+	complex* Ddata = Dewald.data();
+	for(int jMode=0; jMode<nModes; jMode++)
+		for(int iMode=0; iMode<nModes; iMode++)
+		{	const vector3<>& dir_i = phonon.modes[iMode].dir;
+			const vector3<>& dir_j = phonon.modes[jMode].dir;
+			int a = atomIndex[iMode], b = atomIndex[jMode];
+			complex Dij = 0.;
+			for(int i=0; i<3; i++)
+				for(int j=0; j<3; j++)
+					Dij += dir_i[i] * DCART(a,b,i,j) * dir_j[j];
+			Ddata[Dewald.index(iMode,jMode)] = Dij;
+		}
+	#undef DCART
+	return Dewald;
+}
+
+matrix PhononDFPT::getDiagonal() const
+{	matrix Ddiag = zeroes(nModes, nModes);
+	complex* Ddata = Ddiag.data();
+	const complex* nData = nTilde->data();
+	const complex* VxcData = VxcTilde->data();
+	for(int jMode=0; jMode<nModes; jMode++)
+		for(int iMode=0; iMode<nModes; iMode++)
+		{	if(atomIndex[iMode] != atomIndex[jMode]) continue;
+			const Phonon::Mode& mode_i = phonon.modes[iMode];
+			const Phonon::Mode& mode_j = phonon.modes[jMode];
+			const SpeciesInfo& sp = *(e.iInfo.species[mode_i.sp]);
+			const vector3<>& atpos = sp.atpos[mode_i.at];
+			//Local pseudopotential and partial core:
+			double Dloc = 0.;
+			size_t iStart=0, iStop=gInfo.nr;
+			const vector3<int>& S = gInfo.S;
+			THREAD_fullGspaceLoop
+			(	vector3<> Gvec = iG * gInfo.G;
+				double GSq = Gvec.length_squared();
+				double Gmag = sqrt(GSq);
+				if(GSq > symmThresholdSq)
+				{	complex SG = cis(-2*M_PI*::dot(iG, atpos)) * (-::dot(Gvec, mode_i.dir) * ::dot(Gvec, mode_j.dir));
+					double Vloc = sp.VlocRadial(Gmag) - 4*M_PI*sp.Z/GSq;
+					Dloc += (nData[i].conj() * SG).real() * Vloc;
+					if(sp.nCoreRadial) Dloc += (VxcData[i].conj() * SG).real() * sp.nCoreRadial(Gmag);
+				}
+			)
+			Ddata[Ddiag.index(iMode,jMode)] += Dloc; //Note 1/detR in structure factor cancels detR in integral
+			//Non-local pseudopotential:
+			if(!sp.MnlAll) continue;
+			int nProj = sp.MnlAll.nRows();
+			double Dnl = 0.;
+			for(const KpointPair& kp: kpairs)
+			{	ColumnBundle V = kp.V[mode_i.sp].getSub(mode_i.at*nProj, (mode_i.at+1)*nProj);
+				ColumnBundle dVi = projectorDeriv(V, mode_i.dir);
+				ColumnBundle dVj = projectorDeriv(V, mode_j.dir);
+				ColumnBundle d2V = V.similar(); d2V.zero();
+				for(int i=0; i<3; i++)
+					for(int j=0; j<3; j++)
+						if(mode_i.dir[i] && mode_j.dir[j])
+							d2V += (mode_i.dir[i]*mode_j.dir[j]) * DD(V, i, j);
+				matrix VdagC = V ^ kp.Cocc;
+				Dnl += (2.*kWeight) * trace(dagger(d2V ^ kp.Cocc) * sp.MnlAll * VdagC
+					+ dagger(dVi ^ kp.Cocc) * sp.MnlAll * (dVj ^ kp.Cocc)).real();
+			}
+			mpiWorld->allReduce(Dnl, MPIUtil::ReduceSum);
+			Ddata[Ddiag.index(iMode,jMode)] += Dnl;
+		}
+	return Ddiag;
+}
+
+void PhononDFPT::compute()
+{	const std::vector< vector3<> >& kmesh = e.coulombParams.supercell->kmesh;
+	int prodSup = phonon.prodSup;
+	logPrintf("\n########### Linear-response (DFPT) phonon calculation #############\n");
+	logPrintf("Solving Sternheimer equations for %d modes at %d wavevectors commensurate with the supercell.\n", nModes, prodSup);
+	logPrintf("Occupied bands: %d  Sternheimer subspace shift: %lg Eh\n", nOcc, alphaPv);
+
+	std::vector<matrix> Dq(kmesh.size()); //dynamical matrix at each commensurate q
+
+	bool diagonalDone = false; matrix Ddiag;
+	int iqDone = 0;
+	for(size_t iq=0; iq<kmesh.size(); iq++)
+	{	if(iCommensurate[iq] < 0) continue;
+		q = kmesh[iq];
+		iqDone++;
+		logPrintf("\n--- Wavevector %d of %d: q = [ %+.6f %+.6f %+.6f ] ---\n", iqDone, prodSup, q[0], q[1], q[2]);
+		if(!phonon.saveHsub) //time-reversal symmetry (only exploited when e-ph matrix elements are not needed)
+		{	size_t iqMinus = plook->find(-q);
+			if(iqMinus < iq && Dq[iqMinus])
+			{	logPrintf("Using time-reversal symmetry from q = [ %+.6f %+.6f %+.6f ].\n", kmesh[iqMinus][0], kmesh[iqMinus][1], kmesh[iqMinus][2]);
+				Dq[iq] = conj(Dq[iqMinus]);
+			}
+		}
+		if(!Dq[iq])
+		{	setupStates();
+			setupPerturbations();
+			if(!diagonalDone)
+			{	Ddiag = getDiagonal(); //q-independent, but requires states in kpairs (identical k-set for all q)
+				diagonalDone = true;
+			}
+			matrix D = getEwald() + Ddiag;
+			complex* Ddata = D.data();
+			for(iMode=0; iMode<nModes; iMode++)
+			{	const Phonon::Mode& mode = phonon.modes[iMode];
+				logPrintf("\nMode %d of %d: species %s atom %d direction [ %+.3f %+.3f %+.3f ]\n", iMode+1, nModes,
+					e.iInfo.species[mode.sp]->name.c_str(), mode.at+1, mode.dir[0], mode.dir[1], mode.dir[2]);
+				//Self-consistent linear response:
+				dn = 0; nullToZero(dn, gInfo);
+				for(KpointPair& kp: kpairs) kp.dC = ColumnBundle();
+				cgThreshold = 1e-3;
+				clearState();
+				minimize();
+				dVxc = getVxcResponse(dnCore[iMode] ? dn + dnCore[iMode] : dn);
+				//Column of dynamical matrix (local parts):
+				for(int jMode=0; jMode<nModes; jMode++)
+				{	complex Dji = gInfo.detR * ::dot(dVext[jMode], dn);
+					if(dnCore[jMode]) Dji += gInfo.detR * ::dot(dnCore[jMode], dVxc);
+					Ddata[D.index(jMode,iMode)] += Dji;
+				}
+				//Column of dynamical matrix (non-local parts):
+				matrix DnlCol = zeroes(nModes, 1);
+				for(const KpointPair& kp: kpairs)
+					for(int jMode=0; jMode<nModes; jMode++)
+					{	const Phonon::Mode& mode_j = phonon.modes[jMode];
+						const SpeciesInfo& sp = *(e.iInfo.species[mode_j.sp]);
+						if(!kp.V[mode_j.sp]) continue;
+						int nProj = sp.MnlAll.nRows();
+						ColumnBundle V = kp.V[mode_j.sp].getSub(mode_j.at*nProj, (mode_j.at+1)*nProj);
+						ColumnBundle Vq = kp.Vq[mode_j.sp].getSub(mode_j.at*nProj, (mode_j.at+1)*nProj);
+						complex Dji = (2.*kWeight) * trace(
+							dagger(V ^ kp.Cocc) * sp.MnlAll * (projectorDeriv(Vq, mode_j.dir) ^ kp.dC)
+							+ dagger(projectorDeriv(V, mode_j.dir) ^ kp.Cocc) * sp.MnlAll * (Vq ^ kp.dC) );
+						DnlCol.data()[jMode] += Dji;
+					}
+				mpiWorld->allReduceData(DnlCol, MPIUtil::ReduceSum);
+				for(int jMode=0; jMode<nModes; jMode++)
+					Ddata[D.index(jMode,iMode)] += DnlCol.data()[jMode];
+				//Electron-phonon matrix elements:
+				if(phonon.saveHsub)
+				{	complexScalarField dVscf = getWfnsPotential(dVext[iMode] + hartree * dn + dVxc);
+					matrix& dHsub = phonon.dHsub[iMode][0];
+					if(!dHsub) dHsub = zeroes(nBands*prodSup, nBands*prodSup);
+					for(const KpointPair& kp: kpairs)
+					{	int ik2 = iCommensurate[kp.ik];
+						int ik1 = iCommensurate[kp.ikq];
+						if(ik2 < 0) continue;
+						assert(ik1 >= 0);
+						matrix dHsubBlock = (1./prodSup) * (kp.Cq ^ applyDV(kp, kp.C, dVscf, iMode));
+						dHsub.set(ik1*nBands,(ik1+1)*nBands, ik2*nBands,(ik2+1)*nBands, dHsubBlock);
+					}
+				}
+			}
+			Dq[iq] = dagger_symmetrize(D);
+		}
+		//Accumulate force matrix in supercell: C(a0,bR) = (1/prodSup) sum_q Re[D(q) exp(-2pi i q.R)]
+		const complex* Ddata = Dq[iq].data();
+		for(int unit=0; unit<prodSup; unit++)
+		{	complex phase = cis(-2*M_PI*::dot(q, phonon.getCell(unit)));
+			for(int iMode=0; iMode<nModes; iMode++)
+				for(int jMode=0; jMode<nModes; jMode++)
+				{	const Phonon::Mode& mode_j = phonon.modes[jMode];
+					int nAtoms_j = e.iInfo.species[mode_j.sp]->atpos.size();
+					double Cij = (Ddata[Dq[iq].index(iMode,jMode)] * phase).real() / prodSup;
+					phonon.dgrad[iMode][mode_j.sp][unit*nAtoms_j + mode_j.at] += Cij * mode_j.dir;
+				}
+		}
+	}
+	//Collect electron-phonon matrix elements:
+	if(phonon.saveHsub)
+		for(int iMode=0; iMode<nModes; iMode++)
+			mpiWorld->allReduceData(phonon.dHsub[iMode][0], MPIUtil::ReduceSum);
+	kpairs.clear();
+	logPrintf("\n");
+}
+
+void Phonon::processDFPT()
+{	dfptParams.fpLog = globalLog;
+	PhononDFPT(*this).compute();
+}
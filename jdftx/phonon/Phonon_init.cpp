@@ -28,8 +28,12 @@ PhononEverything::PhononEverything(Phonon& phonon) : phonon(phonon)
 }
 
 Phonon::Phonon()
-: dr(0.1), T(298*Kelvin), Fcut(1e-8), rSmooth(1.), iPerturbation(-1), collectPerturbations(false), saveHsub(true), e(*this), eSupTemplate(*this)
-{
+: dr(0.1), T(298*Kelvin), Fcut(1e-8), rSmooth(1.), iPerturbation(-1), collectPerturbations(false), saveHsub(true), nPertGroups(1), dfpt(false), e(*this), eSupTemplate(*this)
+{	dfptParams.linePrefix = "DFPT: ";
+	dfptParams.energyLabel = "D";
+	dfptParams.energyDiffThreshold = 0.; //converge on residual of first-order density alone
+	dfptParams.residualThreshold = 1e-7;
+	dfptParams.nIterations = 50;
 }
 
 //Return size of stabilizer group of a Cartesian displacement (given Cartesian symmetry rotations)
@@ -54,6 +58,8 @@ void Phonon::setup(bool printDefaults)
 	//Ensure phonon command specified:
 	if(!sup.length())
 		die("phonon supercell must be specified using the phonon command.\n");
+	if(dfpt && (iPerturbation>=0 || collectPerturbations))
+		die("phonon options iPerturbation and collectPerturbations do not apply to linear-response (dfpt) calculations.\n");
 	//Check kpoint and supercell compatibility:
 	if(e.eInfo.qnums.size()>1 || e.eInfo.qnums[0].k.length_squared())
 		die("phonon requires a Gamma-centered uniform kpoint mesh.\n");
@@ -232,6 +232,65 @@ void Phonon::processPerturbation(const Perturbation& pert, string fnamePattern)
 	}
 }
 
+void Phonon::processPerturbationsGrouped(int nGroups, std::vector<int>& nStatesPert)
+{	int nPert = perturbations.size();
+	logPrintf("########### Perturbed supercell calculations in %d process groups #############\n", nGroups);
+	MPIUtil mpiPert(0,0, MPIUtil::ProcDivision(mpiWorld, nGroups));
+	logPrintf("Logs of supercell calculations will be written to '%s' etc.\n", e.dump.getFilename("phonon.1.log").c_str());
+	logFlush();
+	std::vector<int> pertGroup(nPert, -1); //group that processed each perturbation
+	nStatesPert.assign(nPert, 0);
+	
+	//Process perturbations from the shared queue, with all MPI operations of the supercell calculation within the group:
+	TaskQueue queue(mpiWorld);
+	MPIUtil* mpiWorldOrig = mpiWorld;
+	mpiWorld = &mpiPert;
+	while(true)
+	{	int iPert = queue.next(mpiWorld);
+		if(iPert >= nPert) break;
+		string fnamePattern = getPerturbationPattern(iPert);
+		//Redirect log for this perturbation (on group head):
+		FILE* fpLogPrev = 0;
+		if(mpiWorld->isHead())
+		{	string fnameLog = fnamePattern;
+			fnameLog.replace(fnameLog.find("$VAR"), 4, "log");
+			FILE* fpLog = fopen(fnameLog.c_str(), "w");
+			if(!fpLog) die_alone("Could not open '%s' for writing.\n", fnameLog.c_str());
+			fpLogPrev = logRedirect(fpLog);
+		}
+		logPrintf("########### Perturbed supercell calculation %d of %d #############\n", iPert+1, nPert);
+		processPerturbation(perturbations[iPert], fnamePattern);
+		pertGroup[iPert] = mpiPert.procDivision.iGroup;
+		nStatesPert[iPert] = eSup->eInfo.nStates;
+		if(mpiWorld->isHead())
+		{	fclose(logRedirect(fpLogPrev));
+		}
+	}
+	eSup.reset(); //free supercell data (tied to the group communicator)
+	mpiWorld = mpiWorldOrig;
+	
+	//Collect results over groups (only from group heads, since results are replicated within each group):
+	bool isPertHead = mpiPert.isHead();
+	int nBandsSup = e.eInfo.nBands * prodSup;
+	for(size_t iMode=0; iMode<modes.size(); iMode++)
+	{	for(std::vector<vector3<>>& dgradSp: dgrad[iMode])
+		{	if(!isPertHead) std::fill(dgradSp.begin(), dgradSp.end(), vector3<>());
+			mpiWorld->allReduceData(dgradSp, MPIUtil::ReduceSum);
+		}
+		if(saveHsub)
+			for(matrix& dHsubSpin: dHsub[iMode])
+			{	if(!isPertHead || !dHsubSpin) dHsubSpin = zeroes(nBandsSup, nBandsSup);
+				mpiWorld->allReduceData(dHsubSpin, MPIUtil::ReduceSum);
+			}
+	}
+	if(!isPertHead) { pertGroup.assign(nPert, -1); nStatesPert.assign(nPert, 0); }
+	mpiWorld->allReduceData(pertGroup, MPIUtil::ReduceMax);
+	mpiWorld->allReduceData(nStatesPert, MPIUtil::ReduceMax);
+	for(int iPert=0; iPert<nPert; iPert++)
+		logPrintf("\tPerturbation: %d  nStates: %d  processed by group: %d\n", iPert+1, nStatesPert[iPert], pertGroup[iPert]);
+	logPrintf("\n"); logFlush();
+}
+
 #define INITwfnsSup(C, nCols) \
 	C.init(nCols, eSup->basis[qSup].nbasis * eSup->eInfo.spinorLength(), \
 		&eSup->basis[qSup], &eSup->eInfo.qnums[qSup], isGpuEnabled());
@@ -30,6 +30,10 @@ enum PhononMember
  	PM_T,
 	PM_Fcut,
 	PM_rSmooth,
+	PM_processGroups,
+	PM_dfpt,
+	PM_dfptThreshold,
+	PM_dfptIterations,
 	PM_delim
 };
 
@@ -41,7 +45,11 @@ EnumStringMap<PhononMember> phononMemberMap
 	PM_saveHsub, "saveHsub",
 	PM_T, "T",
 	PM_Fcut, "Fcut",
-	PM_rSmooth, "rSmooth"
+	PM_rSmooth, "rSmooth",
+	PM_processGroups, "processGroups",
+	PM_dfpt, "dfpt",
+	PM_dfptThreshold, "dfptThreshold",
+	PM_dfptIterations, "dfptIterations"
 );
 
 struct CommandPhonon : public Command
@@ -78,7 +86,27 @@ struct CommandPhonon : public Command
 			"   are desired; this flag ensures that those extra bands do not affect the\n"
 			"   performance or memory requirements of the supercell calculations.\n"
 			"\n+ rSmooth <rSmooth>\n\n"
-			"   Width in bohrs of the supercell boundary region over which matrix elements are smoothed.";
+			"   Width in bohrs of the supercell boundary region over which matrix elements are smoothed.\n"
+			"\n+ processGroups <nGroups>\n\n"
+			"   Run the supercell calculations for different perturbations concurrently,\n"
+			"   dividing the MPI processes into <nGroups> groups. Each group repeatedly takes\n"
+			"   the next pending perturbation, so that groups finishing cheaper (more symmetric)\n"
+			"   perturbations early take on more of them. The log of each supercell calculation\n"
+			"   is then written to a separate file (with $VAR = log in the perturbation's\n"
+			"   filename pattern) instead of the main output. If <nGroups> = 0, use one group\n"
+			"   per perturbation (limited by the number of processes). Default: 1 (run the\n"
+			"   perturbations one after another using all processes). Ignored for iPerturbation.\n"
+			"\n+ dfpt yes|no\n\n"
+			"   Whether to compute the force matrix and phononHsub by linear response\n"
+			"   (density-functional perturbation theory) in the unit cell, solving Sternheimer\n"
+			"   equations at each wavevector commensurate with the supercell, instead of\n"
+			"   finite-difference supercell calculations. Currently requires a spin-unpolarized\n"
+			"   insulator with norm-conserving pseudopotentials, an LDA or GGA functional and\n"
+			"   periodic Coulomb interactions (no fluid or DFT+U). Default: no.\n"
+			"\n+ dfptThreshold <thr>\n\n"
+			"   Convergence threshold on the residual of the first-order density (default 1e-7).\n"
+			"\n+ dfptIterations <n>\n\n"
+			"   Maximum self-consistency iterations for each linear-response mode (default 50).";
 		
 		forbid("fix-electron-density");
 		forbid("fix-electron-potential");
@@ -129,6 +157,21 @@ struct CommandPhonon : public Command
 					pl.get(phonon.rSmooth, 1., "rSmooth", true);
 					if(phonon.rSmooth <= 0.) throw string("<rSmooth> must be positive");
 					break;
+				case PM_processGroups:
+					pl.get(phonon.nPertGroups, 1, "nGroups", true);
+					if(phonon.nPertGroups < 0) throw string("<nGroups> must be non-negative");
+					break;
+				case PM_dfpt:
+					pl.get(phonon.dfpt, false, boolMap, "dfpt", true);
+					break;
+				case PM_dfptThreshold:
+					pl.get(phonon.dfptParams.residualThreshold, 1e-7, "thr", true);
+					if(phonon.dfptParams.residualThreshold <= 0.) throw string("<thr> must be positive");
+					break;
+				case PM_dfptIterations:
+					pl.get(phonon.dfptParams.nIterations, 50, "n", true);
+					if(phonon.dfptParams.nIterations <= 0) throw string("<n> must be positive");
+					break;
 				case PM_delim: //should never be encountered
 					break;
 			}
@@ -145,6 +188,10 @@ struct CommandPhonon : public Command
 		logPrintf(" \\\n\tT %lg", phonon.T/Kelvin);
 		logPrintf(" \\\n\tFcut %lg", phonon.Fcut);
 		logPrintf(" \\\n\trSmooth %lg", phonon.rSmooth);
+		logPrintf(" \\\n\tprocessGroups %d", phonon.nPertGroups);
+		logPrintf(" \\\n\tdfpt %s", boolMap.getString(phonon.dfpt));
+		logPrintf(" \\\n\tdfptThreshold %lg", phonon.dfptParams.residualThreshold);
+		logPrintf(" \\\n\tdfptIterations %d", phonon.dfptParams.nIterations);
 	}
 }
 commandPhonon;
@@ -26,7 +26,7 @@ Wannier::Wannier() : needAtomicOrbitals(false), localizationMeasure(LM_FiniteDif
 	saveWfns(false), saveWfnsRealSpace(false), saveMomenta(false), saveSpin(false),
 	zFieldMag(0.),
 	z0(0.), zH(0.), zSigma(0.),
-	loadRotations(false), numericalOrbitalsOffset(0.5,0.5,0.5), rSmooth(1.),
+	loadRotations(false), numericalOrbitalsOffset(0.5,0.5,0.5), rSmooth(1.), sparseThreshold(0.),
 	spinMode(SpinAll), polar(false)
 {
 }
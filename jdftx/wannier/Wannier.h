@@ -87,6 +87,7 @@ public:
 	
 	vector3<int> phononSup; //!< phonon supercell (process e-ph matrix elements on this supercell if non-zero)
 	double rSmooth; //!< supercell boundary width over which matrix elements are smoothed
+	double sparseThreshold; //!< if positive, write Wannierized matrix elements in sparse format, dropping entries below this fraction of the largest Bloch-space element
 	
 	enum SpinMode
 	{	SpinUp,
@@ -386,43 +386,126 @@ matrix WannierMinimizer::overlap(const ColumnBundle& C1, const ColumnBundle& C2,
 	return ret;
 }
 
-void WannierMinimizer::dumpWannierized(const matrix& Htilde, const matrix& phase, string varName, bool realPartOnly, int iSpin) const
-{
-	string fname = wannier.getFilename(Wannier::FilenameDump, varName, &iSpin);
-	logPrintf("Dumping '%s' ... ", fname.c_str()); logFlush();
-	FILE* fp = 0;
-	if(mpiWorld->isHead())
-	{	fp = fopen(fname.c_str(), "w");
-		if(!fp) die_alone("could not open file for writing.\n");
+void WannierMinimizer::addWannierized(matrix&& Htilde, string varName)
+{	WannierizedOutput output;
+	output.Htilde = std::move(Htilde);
+	output.varName = varName;
+	wannierizedQueue.push_back(std::move(output));
+}
+
+void WannierMinimizer::dumpWannierized(const matrix& phase, int iSpin)
+{	int nOutputs = wannierizedQueue.size();
+	if(!nOutputs) return;
+	bool sparse = (wannier.sparseThreshold > 0.);
+	
+	//Stack Bloch-space matrices of all outputs, so that they are transformed together:
+	std::vector<int> rowStart(nOutputs+1, 0);
+	for(int iOut=0; iOut<nOutputs; iOut++)
+		rowStart[iOut+1] = rowStart[iOut] + wannierizedQueue[iOut].Htilde.nRows();
+	matrix HtildeAll(rowStart.back(), phase.nRows());
+	std::vector<double> threshold(nOutputs, 0.);
+	for(int iOut=0; iOut<nOutputs; iOut++)
+	{	matrix& Htilde = wannierizedQueue[iOut].Htilde;
+		assert(Htilde.nCols() == phase.nRows());
+		HtildeAll.set(rowStart[iOut],rowStart[iOut+1], 0,phase.nRows(), Htilde);
+		if(sparse)
+		{	//Real-space matrix elements are bounded by the largest Bloch-space one (since k-point weights sum to 1):
+			double HtildeMax = 0.;
+			const complex* Hdata = Htilde.data();
+			for(size_t i=0; i<Htilde.nData(); i++)
+				HtildeMax = std::max(HtildeMax, Hdata[i].abs());
+			mpiWorld->allReduce(HtildeMax, MPIUtil::ReduceMax);
+			threshold[iOut] = wannier.sparseThreshold * HtildeMax;
+		}
+		Htilde = matrix(); //no longer needed
 	}
+	
+	//Open output files:
+	std::vector<string> fnames(nOutputs);
+	std::vector<FILE*> fp(nOutputs, (FILE*)0);
+	for(int iOut=0; iOut<nOutputs; iOut++)
+	{	fnames[iOut] = wannier.getFilename(Wannier::FilenameDump, wannierizedQueue[iOut].varName + (sparse ? "Sparse" : ""), &iSpin);
+		if(mpiWorld->isHead())
+		{	fp[iOut] = fopen(fnames[iOut].c_str(), "w");
+			if(!fp[iOut]) die_alone("could not open file '%s' for writing.\n", fnames[iOut].c_str());
+		}
+	}
+	logPrintf("Wannierizing %d output(s) in a single pass ... ", nOutputs); logFlush();
+	
 	//Determine block size:
 	int nCells = phase.nCols();
 	int blockSize = ceildiv(nCells, mpiWorld->nProcesses()); //so that memory before and after FT roughly similar
 	int nBlocks = ceildiv(nCells, blockSize);
 	//Loop over blocks:
 	int iCellStart = 0;
-	double nrm2totSq = 0., nrm2imSq = 0.;
+	std::vector<double> nrm2totSq(nOutputs, 0.), nrm2imSq(nOutputs, 0.);
+	std::vector<size_t> nnz(nOutputs, 0); std::vector<int> nCellsWritten(nOutputs, 0);
 	for(int iBlock=0; iBlock<nBlocks; iBlock++)
 	{	int iCellStop = std::min(iCellStart+blockSize, nCells);
-		matrix Hblock = Htilde * phase(0,phase.nRows(), iCellStart,iCellStop);
-		mpiWorld->reduceData(Hblock, MPIUtil::ReduceSum);
+		matrix HblockAll = HtildeAll * phase(0,phase.nRows(), iCellStart,iCellStop);
+		mpiWorld->reduceData(HblockAll, MPIUtil::ReduceSum);
 		if(mpiWorld->isHead())
-		{	//Write to file:
-			if(realPartOnly)
-			{	nrm2totSq += std::pow(nrm2(Hblock), 2); 
-				nrm2imSq += std::pow(callPref(eblas_dnrm2)(Hblock.nData(), ((double*)Hblock.dataPref())+1, 2), 2); //imaginary parts with a stride of 2
-				Hblock.write_real(fp);
+		{	for(int iOut=0; iOut<nOutputs; iOut++)
+			{	matrix Hblock = HblockAll(rowStart[iOut],rowStart[iOut+1], 0,HblockAll.nCols());
+				if(realPartOnly)
+				{	nrm2totSq[iOut] += std::pow(nrm2(Hblock), 2); 
+					nrm2imSq[iOut] += std::pow(callPref(eblas_dnrm2)(Hblock.nData(), ((double*)Hblock.dataPref())+1, 2), 2); //imaginary parts with a stride of 2
+				}
+				//Write to file:
+				if(sparse)
+				{	int nCellsBlock = 0;
+					nnz[iOut] += writeSparse(fp[iOut], Hblock, iCellStart, threshold[iOut], realPartOnly, nCellsBlock);
+					nCellsWritten[iOut] += nCellsBlock;
+				}
+				else if(realPartOnly) Hblock.write_real(fp[iOut]);
+				else Hblock.write(fp[iOut]);
 			}
-			else Hblock.write(fp);
 		}
 		iCellStart = iCellStop;
 	}
-	if(mpiWorld->isHead()) fclose(fp);
-	if(realPartOnly)
-	{	mpiWorld->bcast(nrm2totSq);
-		mpiWorld->bcast(nrm2imSq);
-		logPrintf("done. Relative discarded imaginary part: %le\n", sqrt(nrm2imSq / nrm2totSq));
+	logPrintf("done.\n");
+	
+	//Close files and report:
+	for(int iOut=0; iOut<nOutputs; iOut++)
+	{	if(mpiWorld->isHead()) fclose(fp[iOut]);
+		logPrintf("\tDumped '%s'", fnames[iOut].c_str());
+		if(sparse)
+		{	size_t nnzDense = size_t(rowStart[iOut+1]-rowStart[iOut]) * nCells;
+			logPrintf(" with %lu of %lu entries (%.3lg%%) in %d of %d cells",
+				nnz[iOut], nnzDense, nnz[iOut]*100./nnzDense, nCellsWritten[iOut], nCells);
+		}
+		if(realPartOnly)
+			logPrintf(". Relative discarded imaginary part: %le", sqrt(nrm2imSq[iOut] / nrm2totSq[iOut]));
+		logPrintf("\n");
+	}
+	logFlush();
+	wannierizedQueue.clear();
+}
+
+size_t WannierMinimizer::writeSparse(FILE* fp, const matrix& M, int iCellStart, double threshold, bool realPartOnly, int& nCellsWritten)
+{	size_t nnzTot = 0;
+	nCellsWritten = 0;
+	std::vector<int32_t> index; std::vector<complex> value; std::vector<double> valueReal;
+	const complex* Mdata = M.data();
+	for(int iCol=0; iCol<M.nCols(); iCol++)
+	{	//Collect entries above threshold:
+		index.clear(); value.clear(); valueReal.clear();
+		for(int iRow=0; iRow<M.nRows(); iRow++)
+		{	const complex& Mcur = Mdata[M.index(iRow,iCol)];
+			if((realPartOnly ? fabs(Mcur.real()) : Mcur.abs()) < threshold) continue;
+			index.push_back(iRow);
+			if(realPartOnly) valueReal.push_back(Mcur.real());
+			else value.push_back(Mcur);
+		}
+		if(!index.size()) continue; //drop cell
+		//Write:
+		int32_t header[2] = { int32_t(iCellStart+iCol), int32_t(index.size()) };
+		fwrite(header, sizeof(int32_t), 2, fp);
+		fwrite(index.data(), sizeof(int32_t), index.size(), fp);
+		if(realPartOnly) fwrite(valueReal.data(), sizeof(double), valueReal.size(), fp);
+		else fwrite(value.data(), sizeof(complex), value.size(), fp);
+		nnzTot += index.size();
+		nCellsWritten++;
 	}
-	else
-		logPrintf("done.\n");
+	return nnzTot;
 }
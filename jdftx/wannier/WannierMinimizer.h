@@ -181,8 +181,22 @@ private:
 	//! Load / compute rotations for a given spin channel (used by saveMLWF)
 	void initRotations(int iSpin);
 	
-	//! Wannierize and dump a Bloch-space matrix to file, optionally zeroing out the real parts
-	void dumpWannierized(const matrix& Htilde, const matrix& phase, string varName, bool realPartOnly, int iSpin) const;
+	//! Queue a Bloch-space matrix (nData x nqMine) for Wannierization and output in the next dumpWannierized()
+	void addWannierized(matrix&& Htilde, string varName);
+	
+	//! Wannierize all queued Bloch-space matrices in a single Fourier transform pass and dump each to file
+	//! (dense, or sparse if wannier.sparseThreshold is set), optionally zeroing out the imaginary parts
+	void dumpWannierized(const matrix& phase, int iSpin);
+	
+	//! Write columns of M (one per cell, numbered from iCellStart) in sparse format, dropping entries with magnitude
+	//! below threshold and cells with no remaining entries. Returns number of entries written, and sets nCellsWritten.
+	static size_t writeSparse(FILE* fp, const matrix& M, int iCellStart, double threshold, bool realPartOnly, int& nCellsWritten);
+	
+	struct WannierizedOutput
+	{	matrix Htilde; //!< Bloch-space matrix elements on local k-points (nData x nqMine)
+		string varName; //!< output variable name
+	};
+	std::vector<WannierizedOutput> wannierizedQueue; //!< outputs pending for the next dumpWannierized()
 	
 	//---- Shared variables and subroutines implementing various Wannier outputs within saveMLWF() ----
 	bool realPartOnly; //whether outputs should have only real part
@@ -237,45 +237,54 @@ void WannierMinimizerFD::initialize(int iSpin)
 		return; //read overlaps successfully rom file, so no need to recalculate below
 	}
 	
-	//Compute the overlap matrices for current spin:
-	for(int jProcess=0; jProcess<mpiWorld->nProcesses(); jProcess++)
-	{	//Send/recv wavefunctions to other processes:
-		Cother.assign(e.eInfo.nStates, ColumnBundle());
-		VdagCother.clear(); VdagCother.resize(e.eInfo.nStates);
-		if(jProcess == mpiWorld->iProcess()) //send
-		{	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
-			{	mpiWorld->bcastData((ColumnBundle&)e.eVars.C[q], jProcess);
-				for(size_t iSp=0; iSp<e.iInfo.species.size(); iSp++)
-					if(e.iInfo.species[iSp]->isUltrasoft())
-						mpiWorld->bcastData((matrix&)e.eVars.VdagC[q][iSp], jProcess);
-			}
-		}
-		else //recv
-		{	for(int q=e.eInfo.qStartOther(jProcess); q<e.eInfo.qStopOther(jProcess); q++)
-			{	Cother[q].init(nBands, e.basis[q].nbasis*nSpinor, &e.basis[q], &e.eInfo.qnums[q]);
-				mpiWorld->bcastData(Cother[q], jProcess);
-				VdagCother[q].resize(e.iInfo.species.size());
-				for(size_t iSp=0; iSp<e.iInfo.species.size(); iSp++)
-				{	const SpeciesInfo& sp = *(e.iInfo.species[iSp]);
-					if(sp.isUltrasoft())
-					{	VdagCother[q][iSp].init(sp.nProjectors(), nBands);
-						mpiWorld->bcastData(VdagCother[q][iSp], jProcess);
-					}
-				}
-			}
+	//Determine the states exchanged with each process for the overlaps (only those at the ends of edges):
+	int nProcs = mpiWorld->nProcesses(), iProc = mpiWorld->iProcess();
+	std::vector<std::set<int>> qRecv(nProcs), qSend(nProcs); //states needed from, and by, each process
+	for(size_t ik=0; ik<kMesh.size(); ik++)
+	{	int iProcK = whose_q(ik,iSpin);
+		for(const Edge& edge: edges[ik])
+		{	int jProcK = whose_q(edge.ik,iSpin);
+			if(iProcK == jProcK) continue; //no communication needed
+			int q = edge.point.iReduced + iSpin*qCount;
+			if(iProcK == iProc) qRecv[jProcK].insert(q);
+			if(jProcK == iProc) qSend[iProcK].insert(q);
 		}
+	}
+	
+	//Compute the overlap matrices for current spin:
+	//--- process shifts around a ring, receiving from iProc-iShift and sending to iProc+iShift;
+	//--- the exchange for the next shift proceeds in the background while the current shift is computed,
+	//--- so that at most two processes' worth of neighbour wavefunctions are held at any time
+	Cother.assign(e.eInfo.nStates, ColumnBundle());
+	VdagCother.clear(); VdagCother.resize(e.eInfo.nStates);
+	std::vector<MPIUtil::Request> requests[2];
+	for(int iShift=0; iShift<nProcs; iShift++)
+	{	if(iShift+1 < nProcs)
+			exchangeWfns(iShift+1, qRecv, qSend, requests[(iShift+1)%2]);
+		MPIUtil::waitAll(requests[iShift%2]);
+		requests[iShift%2].clear();
 		
+		int jProcess = (iProc + nProcs - iShift) % nProcs; //source of wavefunctions for this shift
+		if(iShift && qRecv[jProcess].empty()) continue; //no edges to jProcess
 		for(size_t ik=0; ik<kMesh.size(); ik++) if(isMine_q(ik,iSpin))
 		{	KmeshEntry& ke = kMesh[ik];
 			std::vector<matrix> VdagCi, VdagCj;
-			ColumnBundle Ci = getWfns(ke.point, iSpin, &VdagCi); //Bloch functions at ik
+			ColumnBundle Ci; //Bloch functions at ik (initialized when first needed)
 			//Overlap with neighbours:
 			for(Edge& edge: edges[ik])
 				if(whose_q(edge.ik,iSpin)==jProcess)
+				{	if(!Ci) Ci = getWfns(ke.point, iSpin, &VdagCi);
 					edge.M0 = overlap(Ci, getWfns(edge.point, iSpin, &VdagCj), &VdagCi, &VdagCj);
+				}
+		}
+		//Release received wavefunctions:
+		for(int q: qRecv[jProcess])
+		{	Cother[q] = ColumnBundle();
+			VdagCother[q].clear();
 		}
 	}
 	Cother.clear();
+	VdagCother.clear();
 	
 	//Broadcast and dump the overlap matrices:
 	FILE* fp = 0;
@@ -297,6 +306,40 @@ void WannierMinimizerFD::initialize(int iSpin)
 	}
 }
 
+void WannierMinimizerFD::exchangeWfns(int iShift, const std::vector<std::set<int>>& qRecv, const std::vector<std::set<int>>& qSend, std::vector<MPIUtil::Request>& requests)
+{	int nProcs = mpiWorld->nProcesses(), iProc = mpiWorld->iProcess();
+	int nSpecies = e.iInfo.species.size();
+	int srcProcess = (iProc + nProcs - iShift) % nProcs;
+	int destProcess = (iProc + iShift) % nProcs;
+	//Post receives:
+	//--- both ends walk the same ordered set of states, and MPI preserves message order between a pair of processes,
+	//--- so tags need only distinguish the kind of data (0 for wavefunctions, 1+iSp for projections); this keeps them small
+	for(int q: qRecv[srcProcess])
+	{	Cother[q].init(nBands, e.basis[q].nbasis*nSpinor, &e.basis[q], &e.eInfo.qnums[q]);
+		requests.push_back(MPIUtil::Request());
+		mpiWorld->recvData(Cother[q], srcProcess, 0, &requests.back());
+		VdagCother[q].resize(nSpecies);
+		for(int iSp=0; iSp<nSpecies; iSp++)
+		{	const SpeciesInfo& sp = *(e.iInfo.species[iSp]);
+			if(sp.isUltrasoft())
+			{	VdagCother[q][iSp].init(sp.nProjectors(), nBands);
+				requests.push_back(MPIUtil::Request());
+				mpiWorld->recvData(VdagCother[q][iSp], srcProcess, 1+iSp, &requests.back());
+			}
+		}
+	}
+	//Post sends:
+	for(int q: qSend[destProcess])
+	{	requests.push_back(MPIUtil::Request());
+		mpiWorld->sendData(e.eVars.C[q], destProcess, 0, &requests.back());
+		for(int iSp=0; iSp<nSpecies; iSp++)
+			if(e.iInfo.species[iSp]->isUltrasoft())
+			{	requests.push_back(MPIUtil::Request());
+				mpiWorld->sendData(e.eVars.VdagC[q][iSp], destProcess, 1+iSp, &requests.back());
+			}
+	}
+}
+
 
 double WannierMinimizerFD::getOmega(bool grad)
 {	static StopWatch watch("WannierMinimizerFD::getOmega"); watch.start();
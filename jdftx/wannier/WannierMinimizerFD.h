@@ -46,6 +46,11 @@ public:
 	};
 	std::vector< std::vector<Edge> > edges; //!< set of all edges
 	matrix kHelmholtzInv; //!< inverse Helmholtz preconditioner
+	
+private:
+	//! Post non-blocking exchange of wavefunctions (and ultrasoft projections) needed for overlaps at ring shift iShift:
+	//! receive states qRecv[iProc-iShift] into Cother and send states qSend[iProc+iShift] (requests appended to requests)
+	void exchangeWfns(int iShift, const std::vector<std::set<int>>& qRecv, const std::vector<std::set<int>>& qSend, std::vector<MPIUtil::Request>& requests);
 };
 
 //! @}
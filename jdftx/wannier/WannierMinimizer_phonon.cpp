@@ -208,8 +208,20 @@ void WannierMinimizer::saveMLWF_phonon(int iSpin)
 		}
 	logPrintf("done.\n"); logFlush();
 	
+	//Threshold for sparse output (real-space elements are bounded by the largest Bloch-space one):
+	bool sparse = (wannier.sparseThreshold > 0.);
+	double threshold = 0.;
+	if(sparse)
+	{	double HePhTildeMax = 0.;
+		const complex* HePhTildeData = HePhTilde.data();
+		for(size_t i=0; i<HePhTilde.nData(); i++)
+			HePhTildeMax = std::max(HePhTildeMax, HePhTildeData[i].abs());
+		mpiWorld->allReduce(HePhTildeMax, MPIUtil::ReduceMax);
+		threshold = wannier.sparseThreshold * HePhTildeMax;
+	}
+	
 	//Wannierize and output one cell fixed at a time to minimize memory usage:
-	string fname = wannier.getFilename(Wannier::FilenameDump, "mlwfHePh", &iSpin);
+	string fname = wannier.getFilename(Wannier::FilenameDump, sparse ? "mlwfHePhSparse" : "mlwfHePh", &iSpin);
 	logPrintf("Dumping '%s' ... ", fname.c_str()); logFlush();
 	FILE* fp = 0;
 	if(mpiWorld->isHead())
@@ -219,6 +231,7 @@ void WannierMinimizer::saveMLWF_phonon(int iSpin)
 	matrix phase = zeroes(HePhTilde.nCols(), prodPhononSup);
 	double kPairWeight = 1./prodPhononSup;
 	double nrm2totSq = 0., nrm2imSq = 0.;
+	size_t nnz = 0; int nCellPairsWritten = 0, iCell1 = 0;
 	std::map<vector3<int>, matrix> Hsum;
 	for(const UniqueCell& cell1: uniqueCells)
 	{	//calculate Fourier transform phase (with integration weights):
@@ -233,12 +246,20 @@ void WannierMinimizer::saveMLWF_phonon(int iSpin)
 		matrix H = HePhTilde * phase;
 		mpiWorld->allReduceData(H, MPIUtil::ReduceSum);
 		//write results for unique cells to file:
+		if(sparse)
+		{	if(mpiWorld->isHead())
+			{	int nCellsCur = 0;
+				nnz += writeSparse(fp, H, iCell1*prodPhononSup, threshold, realPartOnly, nCellsCur); //pair index = iCell1*prodPhononSup + iCell2
+				nCellPairsWritten += nCellsCur;
+			}
+		}
+		else if(realPartOnly) { if(mpiWorld->isHead()) H.write_real(fp); }
+		else { if(mpiWorld->isHead()) H.write(fp); }
 		if(realPartOnly)
-		{	if(mpiWorld->isHead()) H.write_real(fp);
-			nrm2totSq += std::pow(nrm2(H), 2); 
+		{	nrm2totSq += std::pow(nrm2(H), 2); 
 			nrm2imSq += std::pow(callPref(eblas_dnrm2)(H.nData(), ((double*)H.dataPref())+1, 2), 2); //look only at imaginary parts with a stride of 2
 		}
-		else { if(mpiWorld->isHead()) H.write(fp); }
+		iCell1++;
 		//collect sum rule, accounting for cell map and weights:
 		const complex* Hdata = H.dataPref();
 		int nDataPerCell = nPhononModes*nCenters*nCenters;
@@ -277,6 +298,11 @@ void WannierMinimizer::saveMLWF_phonon(int iSpin)
 		logPrintf("done. Relative discarded imaginary part: %le\n", sqrt(nrm2imSq / nrm2totSq));
 	else
 		logPrintf("done.\n");
+	if(sparse)
+	{	size_t nnzDense = size_t(nCenters*nCenters*nPhononModes) * prodPhononSup * prodPhononSup;
+		logPrintf("\tRetained %lu of %lu entries (%.3lg%%) in %d of %d cell pairs.\n",
+			nnz, nnzDense, nnz*100./nnzDense, nCellPairsWritten, prodPhononSup*prodPhononSup);
+	}
 	
 	//Write sum rule matrices and cell map:
 	if(mpiWorld->isHead())
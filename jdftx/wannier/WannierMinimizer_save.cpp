@@ -185,10 +185,11 @@ void WannierMinimizer::saveMLWF(int iSpin)
 	if(wannier.zVfilename.length()) saveMLWF_Z(iSpin, phase); //z position
 	if(wannier.zH) saveMLWF_W(iSpin, phase); //Slab weights
 	saveMLWF_ImSigma_ee(iSpin, phase);
-	
-	//Phonon q-mesh outputs:
 	bool savePhonon = wannier.phononSup.length_squared();
 	if(savePhonon) saveMLWF_D(iSpin, phase); //Gradient (for phonon sum rule)
+	dumpWannierized(phase, iSpin); //transform and write all of the above together
+	
+	//Phonon q-mesh outputs:
 	if(savePhonon) saveMLWF_phonon(iSpin);
 	suspendOperatorThreading();
 }
@@ -275,8 +276,8 @@ void WannierMinimizer::saveMLWF_H(int iSpin, const matrix& phase)
 		callPref(eblas_copy)(HwannierTilde.dataPref()+HwannierTilde.index(0,iqMine), Hsub.dataPref(), Hsub.nData());
 		iqMine++;
 	}
-	//Fourier transform to Wannier space and save
-	dumpWannierized(HwannierTilde, phase, "mlwfH", realPartOnly, iSpin);
+	//Queue for Fourier transform to Wannier space and output (see dumpWannierized)
+	addWannierized(std::move(HwannierTilde), "mlwfH");
 }
 
 
@@ -307,8 +308,8 @@ void WannierMinimizer::saveMLWF_P(int iSpin, const matrix& phase)
 		callPref(eblas_copy)(pWannierTilde.dataPref()+pWannierTilde.index(0,iqMine), pSub.dataPref(), pSub.nData());
 		iqMine++;
 	}
-	//Fourier transform to Wannier space and save
-	dumpWannierized(pWannierTilde, phase, "mlwfP", realPartOnly, iSpin);
+	//Queue for Fourier transform to Wannier space and output (see dumpWannierized)
+	addWannierized(std::move(pWannierTilde), "mlwfP");
 }
 
 //Save gradient matrix elements in Wannier basis:
@@ -343,8 +344,8 @@ void WannierMinimizer::saveMLWF_D(int iSpin, const matrix& phase)
 		callPref(eblas_copy)(DwannierTilde.dataPref()+DwannierTilde.index(0,iqMine), Dsub.dataPref(), Dsub.nData());
 		iqMine++;
 	}
-	//Fourier transform to Wannier space and save
-	dumpWannierized(DwannierTilde, phase, "mlwfD", realPartOnly, iSpin);
+	//Queue for Fourier transform to Wannier space and output (see dumpWannierized)
+	addWannierized(std::move(DwannierTilde), "mlwfD");
 }
 
 
@@ -375,8 +376,8 @@ void WannierMinimizer::saveMLWF_S(int iSpin, const matrix& phase)
 		callPref(eblas_copy)(SwannierTilde.dataPref()+SwannierTilde.index(0,iqMine), Ssub.dataPref(), Ssub.nData());
 		iqMine++;
 	}
-	//Fourier transform to Wannier space and save
-	dumpWannierized(SwannierTilde, phase, "mlwfS", realPartOnly, iSpin);
+	//Queue for Fourier transform to Wannier space and output (see dumpWannierized)
+	addWannierized(std::move(SwannierTilde), "mlwfS");
 }
 
 
@@ -480,8 +481,8 @@ void WannierMinimizer::saveMLWF(int iSpin, const matrix& phase, const ScalarFiel
 		callPref(eblas_copy)(wWannierTilde.dataPref()+wWannierTilde.index(0,iqMine), wSub.dataPref(), wSub.nData());
 		iqMine++;
 	}
-	//Fourier transform to Wannier space and save
-	dumpWannierized(wWannierTilde, phase, varName, realPartOnly, iSpin);
+	//Queue for Fourier transform to Wannier space and output (see dumpWannierized)
+	addWannierized(std::move(wWannierTilde), varName);
 }
 
 
@@ -548,6 +549,6 @@ void WannierMinimizer::saveMLWF_ImSigma_ee(int iSpin, const matrix& phase)
 			callPref(eblas_copy)(ImSigma_eeWannierTilde.dataPref()+ImSigma_eeWannierTilde.index(0,iqMine), ImSigma_eeSub.dataPref(), ImSigma_eeSub.nData());
 			iqMine++;
 		}
-		dumpWannierized(ImSigma_eeWannierTilde, phase, "mlwfImSigma_ee", realPartOnly, iSpin);
+		addWannierized(std::move(ImSigma_eeWannierTilde), "mlwfImSigma_ee");
 	}
 }
@@ -40,6 +40,7 @@ enum WannierMember
 	WM_numericalOrbitalsOffset,
 	WM_phononSup,
 	WM_rSmooth,
+	WM_sparseThreshold,
 	WM_spinMode,
 	WM_polar,
 	WM_delim
@@ -64,6 +65,7 @@ EnumStringMap<WannierMember> wannierMemberMap
 	WM_numericalOrbitalsOffset, "numericalOrbitalsOffset",
 	WM_phononSup, "phononSupercell",
 	WM_rSmooth, "rSmooth",
+	WM_sparseThreshold, "sparseThreshold",
 	WM_spinMode, "spinMode",
 	WM_polar, "polar"
 );
@@ -170,6 +172,15 @@ struct CommandWannier : public Command
 			"   Width in bohrs of the supercell boundary region over which matrix elements are smoothed.\n"
 			"   If phononSupercell is specified to process phonon quantities, the rSmooth specified here\n"
 			"   must exactly match the value specified in the calculation in command phonon.\n"
+			"\n+ sparseThreshold <threshold>\n\n"
+			"   If positive, write Wannierized matrix elements (mlwfH, mlwfP etc. and mlwfHePh)\n"
+			"   in a sparse format to files with suffix Sparse (eg. mlwfHSparse) instead of the dense\n"
+			"   files. Entries smaller than <threshold> times the largest Bloch-space matrix element\n"
+			"   of that quantity are dropped, along with cells that have no remaining entries.\n"
+			"   Each retained cell is written as int32 iCell, int32 nnz, int32 index[nnz] and\n"
+			"   value[nnz] (real doubles, or complex for noncollinear calculations), where iCell\n"
+			"   and index refer to the column and row respectively of the dense format.\n"
+			"   Default: 0 (write dense matrices).\n"
 			"\n+ spinMode" + spinModeMap.optionList() + "\n\n"
 			"   If Up or Dn, only generate Wannier functions for that spin channel, allowing\n"
 			"   different input files for each channel (independent centers, windows etc.).\n"
@@ -270,6 +281,10 @@ struct CommandWannier : public Command
 					pl.get(wannier.rSmooth, 1., "rSmooth", true);
 					if(wannier.rSmooth <= 0.) throw string("<rSmooth> must be positive");
 					break;
+				case WM_sparseThreshold:
+					pl.get(wannier.sparseThreshold, 0., "threshold", true);
+					if(wannier.sparseThreshold < 0.) throw string("<threshold> must be non-negative");
+					break;
 				case WM_spinMode:
 					pl.get(wannier.spinMode, Wannier::SpinAll,  spinModeMap, "spinMode", true);
 					if(e.eInfo.spinType!=SpinZ && wannier.spinMode!=Wannier::SpinAll)
@@ -317,6 +332,8 @@ struct CommandWannier : public Command
 		if(wannier.phononSup.length_squared())
 			logPrintf(" \\\n\tphononSupercell %d %d %d", wannier.phononSup[0], wannier.phononSup[1], wannier.phononSup[2]);
 		logPrintf(" \\\n\trSmooth %lg", wannier.rSmooth);
+		if(wannier.sparseThreshold)
+			logPrintf(" \\\n\tsparseThreshold %lg", wannier.sparseThreshold);
 		logPrintf(" \\\n\tspinMode %s", spinModeMap.getString(wannier.spinMode));
 		logPrintf(" \\\n\tpolar %s", boolMap.getString(wannier.polar));
 	}